@@ -29,9 +29,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include "aap_plat_media_player_types.h"
 #include "aap_plat_aplayer_interface.h"
+#include "alsa_drift_comp.h"
+#include "alsa_plc.h"
+#include "alsa_ring.h"
+#include "alsa_kernels.h"
+#include "alsa_caps.h"
+#include "alsa_convert.h"
+#include "alsa_bus.h"
+#include "alsa_eq.h"
+#include "alsa_limiter.h"
 #include <alsa/asoundlib.h>
 
 #if defined __cplusplus
@@ -49,7 +60,15 @@ typedef struct
     snd_pcm_t *pcmHandleOut;
     /* Format of the audio data. */
     snd_pcm_format_t format;
-    /* Contains the configuration of a particular channel */
+    /* PCM opened without ALSA's conversions, in a configuration probed
+     * from the device */
+    AAP_BOOL bNative;
+    /* Device key of the capability and parameter cache, see alsa_caps.h */
+    char acCapsKey[ALSA_CAPS_KEY_LEN];
+    /* Configuration the player was initialized with, its rate and channels
+     * those of the PCM. The input format may differ, see sConvert. */
+    AAPAudioConfig sAudioConfig;
+    /* Contains the configuration of a particular channel, sAudioConfig */
     AAPAudioConfig *psAudioConfig;
     /* Stores callback function pointer */
     AAPAlsaCoreCbFunc pfEventFunc;
@@ -57,6 +76,167 @@ typedef struct
     void *pvUserParam;
     /* set to true once player initialization is done */
     AAP_BOOL isConfigured;
+    /* ALSA buffer size in frames as negotiated at init, or when a latency
+     * it cannot hold is set */
+    snd_pcm_uframes_t bufferSize;
+    /* ALSA period size in frames as negotiated at init. With ALSA_TSCHED
+     * the frames rendered at a time instead. */
+    snd_pcm_uframes_t periodSize;
+    /* Frames kept queued between the ring and the PCM: the ALSA buffer, or
+     * with ALSA_TSCHED or a latency set later the latency */
+    snd_pcm_uframes_t fillSize;
+    /* ALSA_TSCHED: a quarter of the fill at init, the most the PCM is kept
+     * from running down to. A later fill does not raise it, a source
+     * pushing in real time never fills up to a larger one. */
+    snd_pcm_uframes_t guardSize;
+    /* Latency asked for, applied by the render thread */
+    volatile unsigned int uiLatencyMs;
+    /* Deep buffer mode asked for, applied by the render thread, and
+     * whether fillSize is the deep one */
+    volatile AAP_BOOL bDeepBuffer;
+    AAP_BOOL bDeepFill;
+    /* ALSA_TSCHED: timer the render thread sleeps on, and the event that
+     * wakes it early for requests */
+    int iTimerFd;
+    int iWakeFd;
+    /* ALSA_TSCHED: peak lateness of timer wakeups, decaying, in ns */
+    unsigned long long ullJitterNs;
+    /* ALSA_TSCHED: timer wakeups taken */
+    unsigned long ulTimerWakeups;
+    /* Phone to DAC clock drift compensation */
+    AlsaDriftComp sDrift;
+    /* Timestamp gap detection and concealment */
+    AlsaPlc sPlc;
+    /* Float processing of the rendered periods */
+    AlsaBus sBus;
+    /* Parametric EQ, a stage of sBus */
+    AlsaEq sEq;
+    /* Output peak limiter, the last stage of sBus */
+    AlsaLimiter sLimiter;
+    /* Frames pushed by the application, waiting for the render thread */
+    AlsaRing sRing;
+    /* Render thread feeding the PCM from sRing */
+    pthread_t renderThread;
+    /* Set once renderThread has been created */
+    AAP_BOOL bRenderStarted;
+    /* Cleared to make the render thread exit */
+    volatile AAP_BOOL bRenderRun;
+    /* Requests to the render thread, ALSA_RENDER_REQ_* bits */
+    volatile unsigned int uiRenderReq;
+    /* Posted when data or a request is available for the render thread */
+    sem_t semData;
+    /* Posted when the render thread has freed space in sRing */
+    sem_t semSpace;
+    /* One period of frames taken from sRing */
+    short *psPeriodBuf;
+    /* Conversion of the S16 output to the format of the PCM, and a period
+     * of frames in it. NULL when the PCM takes S16. */
+    AlsaExportFunc pfExport;
+    void *pvExport;
+    /* Next data rendered has to be faded in */
+    AAP_BOOL bFadeIn;
+    /* Silence fill gave up and the PCM is allowed to run dry */
+    AAP_BOOL bIdle;
+    /* Output faded out by pause or stop, nothing is rendered until play.
+     * The producer does not wait on the ring meanwhile. */
+    volatile AAP_BOOL bHalted;
+    /* Last buffer of frames written to the PCM, to write again faded when
+     * they are rewound. uiHistoryPos is the frame after the newest. */
+    short *psHistory;
+    unsigned int uiHistoryPos;
+    /* Frames the history can hold, a buffer for the largest latency */
+    unsigned int uiHistoryFrames;
+    /* Transitions faded and gain changes preempted by rewinding, and the
+     * frames rewound for them */
+    unsigned long ulRewindFades;
+    unsigned long ulPreemptions;
+    unsigned long ulRewoundFrames;
+    /* Consecutive silence frames injected by the render thread */
+    unsigned long ulIdleFrames;
+    /* Total silence frames injected by the render thread */
+    volatile unsigned long ulSilenceFrames;
+    /* Value of ulSilenceFrames already accounted by the producer */
+    unsigned long ulSilenceSeen;
+    /* Underruns that reached the device */
+    unsigned long ulXrunCount;
+    /* Underruns prevented by injecting silence */
+    unsigned long ulAvoidedUnderruns;
+    /* PCM is suspended and being resumed by the render thread */
+    volatile AAP_BOOL bSuspended;
+    /* snd_pcm_resume() attempts made for the current suspend */
+    unsigned int uiResumeTries;
+    /* Monotonic time of the next resume attempt, in ms */
+    unsigned long long ullResumeAtMs;
+    /* Number of suspends seen */
+    unsigned long ulSuspendCount;
+    /* Frames dropped because of a suspend, on either side of the ring */
+    volatile unsigned long ulSuspendDropped;
+    /* Watchdog timeout, see audio_player_set_watchdog() */
+    unsigned int uiWatchdogMs;
+    /* Frames written to the PCM less those rewound, its application
+     * pointer up to an offset */
+    unsigned long long ullWrittenFrames;
+    /* Hardware position last seen, derived from ullWrittenFrames and the
+     * delay, and the monotonic times it last moved and was read, in ms */
+    unsigned long long ullHwFrames;
+    unsigned long long ullHwMovedMs;
+    unsigned long long ullHwCheckMs;
+    /* Hardware pointer stopped and the PCM was restarted, cleared once it
+     * moves again. The producer does not wait on the ring meanwhile. */
+    volatile AAP_BOOL bStalled;
+    /* The PCM failed beyond recovery. The render thread leaves it alone
+     * until play prepares it again, the producer is not made to wait. */
+    volatile AAP_BOOL bFailed;
+    /* Stalls seen, and frames dropped from the ring for them */
+    unsigned long ulStallCount;
+    unsigned long ulStallDropped;
+    /* Drain asked for, see audio_player_drain(). ulDrainFrame is the ring
+     * position after the last frame of the stream, bDrain is cleared once
+     * the render thread has written that frame. */
+    volatile unsigned long ulDrainFrame;
+    volatile AAP_BOOL bDrain;
+    /* Last frame of a drained stream written, EOS is due once the hardware
+     * position reaches ullEosFrame */
+    volatile AAP_BOOL bEosPending;
+    unsigned long long ullEosFrame;
+    /* Position after the last frame of data written, padding excluded */
+    unsigned long long ullDataEndFrames;
+    /* Render thread asks the application for data, see
+     * audio_player_set_pull_mode() */
+    volatile AAP_BOOL bPull;
+    /* Steady playback seen since the last transition, see alsa_rt_check.h */
+    unsigned long ulRtWarmFrames;
+    /* Scheduling of the render thread, applied once bThreadConfigSet */
+    AAP_ThreadConfig sThreadConfig;
+    AAP_BOOL bThreadConfigSet;
+    /* Processing specialized for the input format, chosen at init and on
+     * each format change. Only the pushing thread uses it after init. */
+    AlsaKernels sKernels;
+    /* Gain ramp of the render thread, the same for every input format and
+     * taken from the first set */
+    void (*pfRamp)(short *psData, unsigned int uiFrames, unsigned int uiChannels,
+            int iFromQ15, int iToQ15);
+    /* Input converted to S16, for formats other than S16 */
+    short *psImport;
+    unsigned int uiImportCap;
+    /* Input channels and rate mapped onto those of the PCM */
+    AlsaConvert sConvert;
+    /* Input format changed, the next data pushed starts a splice */
+    AAP_BOOL bSplicePending;
+    /* Ring position of the last format change, published under the
+     * uiSpliceSeq sequence lock, odd while it is being written */
+    volatile unsigned long ulSpliceFrame;
+    volatile unsigned int uiSpliceSeq;
+    /* Render thread side: sequence of the change taken up, the change
+     * being faded across and where its fade out starts */
+    unsigned int uiSpliceSeen;
+    AAP_BOOL bSplice;
+    unsigned long ulSpliceAt;
+    unsigned long ulSpliceFadeFrom;
+    /* Output of a non-blocking push that did not fit in sRing */
+    unsigned char *pucCarry;
+    unsigned int uiCarryFrames;
+    unsigned int uiCarryCap;
 }AlsaConfig;
 
 int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
@@ -69,6 +249,29 @@ int audio_player_push_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer,
         unsigned char* pucData,
         unsigned int uiSize,
         uint64_t ulTimeStamp);
+int audio_player_push_buffer_nb(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        unsigned char* pucData,
+        unsigned int uiSize,
+        uint64_t ulTimeStamp,
+        unsigned int *puiAccepted);
+int audio_player_set_pull_mode(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable);
+int audio_player_set_gain(AAP_PLAYER_HANDLE ulAlsaPlayer, float fGain);
+int audio_player_set_eq(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAPPlayerEqBand *pasBands, unsigned int uiBands);
+int audio_player_set_limiter(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable,
+        float fCeilingDb);
+int audio_player_get_limiter_stats(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        AAPPlayerLimiterStats *psStats);
+int audio_player_get_output_path(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        AAPPlayerOutputPath *psPath);
+int audio_player_reconfigure(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAPAudioConfig *psAudioConfig);
+int audio_player_set_latency(AAP_PLAYER_HANDLE ulAlsaPlayer, unsigned int uiLatencyMs);
+int audio_player_set_deep_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable);
+int audio_player_set_watchdog(AAP_PLAYER_HANDLE ulAlsaPlayer, unsigned int uiTimeoutMs);
+int audio_player_set_thread_config(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAP_ThreadConfig *psThreadConfig);
+int audio_player_drain(AAP_PLAYER_HANDLE ulAlsaPlayer);
 int audio_player_stop(AAP_PLAYER_HANDLE ulAlsaPlayer);
 int audio_player_deinit(AAP_PLAYER_HANDLE ulAlsaPlayer);
 
@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_bus.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Float processing bus of the ALSA core player, run by the render thread
+ *   on every period before it is written to the PCM.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_BUS_H_
+#define _ALSA_BUS_H_
+
+#include "aap_standard_types.h"
+#include "alsa_kernels.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of channels carried by the bus */
+#define ALSA_BUS_MAX_CHANNELS 8
+
+#if ALSA_FIXED_POINT
+/* Q31 words with 4 bits of headroom: full scale is 1 << 27 */
+#define ALSA_BUS_FRAC_BITS 27
+/* Largest gain the Q16 gain stage takes */
+#define ALSA_BUS_MAX_GAIN 15.0f
+typedef int AlsaBusSample;
+#else
+/* Full scale is +/-1.0 */
+typedef float AlsaBusSample;
+#endif
+
+/* Maximum number of processing stages after the gain */
+#define ALSA_BUS_MAX_STAGES 4
+
+/* A processing stage run on the bus, see alsa_bus_add_stage() */
+typedef struct
+{
+    /* Processes uiFrames of the bus in place */
+    void (*pfProcess)(void *pvStage, AlsaBusSample *ptBus, unsigned int uiFrames);
+    /* Tells whether the stage changes the signal at the moment */
+    AAP_BOOL (*pfActive)(void *pvStage);
+    void *pvStage;
+}AlsaBusStage;
+
+typedef struct
+{
+    /* Number of interleaved channels */
+    unsigned int uiChannels;
+    /* Capacity of the buffers in frames */
+    unsigned int uiCapFrames;
+    /* Interleaved samples */
+    AlsaBusSample *ptBus;
+    /* Dither of the current period, in LSB. Unused in fixed point. */
+    float *pfDither;
+    /* Requantized output handed to ALSA */
+    short *psOut;
+    /* Requantization error of the previous frame, per channel: in output
+     * LSB, or in bus units in fixed point */
+    AlsaBusSample atErr[ALSA_BUS_MAX_CHANNELS];
+    /* Sample number the dither continues from */
+    unsigned int uiSeed;
+    /* Gain reached at the end of the last period */
+    float fGain;
+    /* Gain asked for, written by the application thread */
+    volatile float fGainTarget;
+    /* Stages run after the gain, in order */
+    AlsaBusStage asStages[ALSA_BUS_MAX_STAGES];
+    unsigned int uiStages;
+}AlsaBus;
+
+int alsa_bus_init(AlsaBus *psBus, unsigned int uiChannels, unsigned int uiCapFrames);
+void alsa_bus_set_gain(AlsaBus *psBus, float fGain);
+AAP_BOOL alsa_bus_take_gain(AlsaBus *psBus, float *pfRatio);
+int alsa_bus_add_stage(AlsaBus *psBus,
+        void (*pfProcess)(void *pvStage, AlsaBusSample *ptBus, unsigned int uiFrames),
+        AAP_BOOL (*pfActive)(void *pvStage),
+        void *pvStage);
+int alsa_bus_process(AlsaBus *psBus,
+        const short *psIn,
+        unsigned int uiFrames,
+        const short **ppsOut);
+void alsa_bus_deinit(AlsaBus *psBus);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_BUS_H_ */
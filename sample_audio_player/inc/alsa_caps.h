@@ -0,0 +1,99 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_caps.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Capability probing of the ALSA core player: which sample formats, rates
+ *   and channel counts a device takes natively, and the native configuration
+ *   closest to a stream. Capabilities and the hardware parameters negotiated
+ *   for a configuration are kept on disk, so later boots skip both.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_CAPS_H_
+#define _ALSA_CAPS_H_
+
+#include <alsa/asoundlib.h>
+
+#include "alsa_kernels.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* When set, PCMs are opened without ALSA's automatic rate, channel and
+ * format conversions and run in a configuration the device supports; the
+ * player converts the input itself. Built with NATIVE_FORMAT=0 to leave the
+ * conversions to ALSA, see the Makefile. */
+#ifndef ALSA_NATIVE_FORMAT
+#define ALSA_NATIVE_FORMAT 1
+#endif
+
+/* File the cache persists in across boots, "" to keep it in memory only.
+ * Set with CAPS_CACHE_FILE=path, see the Makefile. */
+#ifndef ALSA_CAPS_CACHE_FILE
+#define ALSA_CAPS_CACHE_FILE "/var/cache/aap/alsa_caps"
+#endif
+
+/* Devices whose capabilities are kept */
+#define ALSA_CAPS_CACHE_SIZE 8
+/* Configurations whose hardware parameters are kept */
+#define ALSA_CAPS_HW_CACHE_SIZE 16
+/* Longest key of a device: its name, card, driver and driver version */
+#define ALSA_CAPS_KEY_LEN 160
+
+typedef struct
+{
+    /* Bit (1 << AlsaSampleFormat) per format supported */
+    unsigned int uiFormats;
+    /* Bit per entry of the rate table of alsa_caps.cpp */
+    unsigned int uiRates;
+    unsigned int uiMinChannels;
+    unsigned int uiMaxChannels;
+}AlsaCaps;
+
+typedef struct
+{
+    /* Configuration asked for */
+    snd_pcm_format_t format;
+    unsigned int uiRate;
+    unsigned int uiChannels;
+    unsigned int uiBufferUs;
+    int iResample;
+    int iPeriodWakeup;
+    /* Start threshold applied with it, 0 for the whole buffer */
+    snd_pcm_uframes_t startFrames;
+    /* Negotiated */
+    snd_pcm_uframes_t bufferSize;
+    snd_pcm_uframes_t periodSize;
+}AlsaHwSetup;
+
+int alsa_caps_key(snd_pcm_t *pcmHandle, const char *pcDevice, char *pcKey);
+int alsa_caps_get(snd_pcm_t *pcmHandle, const char *pcKey, AlsaCaps *psCaps);
+int alsa_caps_choose(const AlsaCaps *psCaps, unsigned int uiRate,
+        unsigned int uiChannels, AlsaSampleFormat *peFormat,
+        unsigned int *puiRate, unsigned int *puiChannels);
+snd_pcm_format_t alsa_caps_pcm_format(AlsaSampleFormat eFormat);
+int alsa_caps_set_hw(snd_pcm_t *pcmHandle, const char *pcKey, AlsaHwSetup *psSetup);
+void alsa_caps_put_hw(const char *pcKey, const AlsaHwSetup *psSetup);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_CAPS_H_ */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_convert.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Input format conversion of the ALSA core player. Maps the channels and
+ *   the sample rate of the data pushed onto those the PCM was opened with,
+ *   so the input format can change without reopening the device.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_CONVERT_H_
+#define _ALSA_CONVERT_H_
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of channels on either side */
+#define ALSA_CONVERT_MAX_CHANNELS 8
+
+typedef struct
+{
+    /* Format of the data pushed */
+    unsigned int uiInChannels;
+    unsigned int uiInRate;
+    /* Format of the PCM */
+    unsigned int uiOutChannels;
+    unsigned int uiOutRate;
+    /* Input frames per output frame */
+    double dStep;
+    /* Fractional read position in the staging buffer */
+    double dPhase;
+    /* History frames followed by the current chunk, in output channels */
+    short *psStage;
+    /* Capacity of psStage in frames */
+    unsigned int uiStageCap;
+    /* Converted output */
+    short *psOut;
+    /* Capacity of psOut in frames */
+    unsigned int uiOutCap;
+    /* Interpolator for uiOutChannels, see AlsaKernels */
+    unsigned int (*pfResample)(const short *psStage, short *psOut,
+            unsigned int uiChannels, double *pdPhase, double dStep, double dEnd);
+}AlsaConvert;
+
+int alsa_convert_init(AlsaConvert *psConvert, unsigned int uiChannels,
+        unsigned int uiRate);
+int alsa_convert_set_input(AlsaConvert *psConvert, unsigned int uiChannels,
+        unsigned int uiRate);
+int alsa_convert_active(const AlsaConvert *psConvert);
+int alsa_convert_process(AlsaConvert *psConvert, const short *psIn,
+        unsigned int uiInFrames, const short **ppsOut);
+void alsa_convert_deinit(AlsaConvert *psConvert);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_CONVERT_H_ */
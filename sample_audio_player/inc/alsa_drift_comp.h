@@ -0,0 +1,92 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_drift_comp.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Clock drift compensation for the ALSA core player. A PI controller
+ *   watches the ALSA buffer fill level and steers a fine-ratio resampler so
+ *   that the phone clock and the DAC clock are kept in lock.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_DRIFT_COMP_H_
+#define _ALSA_DRIFT_COMP_H_
+
+#include "aap_standard_types.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Maximum correction the controller may apply, in ppm. Covers +/-1000 ppm
+ * of crystal drift with some headroom to pull the fill level back. */
+#define ALSA_DRIFT_MAX_PPM 2000
+/* Maximum number of channels handled by the resampler */
+#define ALSA_DRIFT_MAX_CHANNELS 8
+
+typedef struct
+{
+    /* Number of interleaved channels */
+    unsigned int uiChannels;
+    /* Sample rate of the stream, used to turn frames into time */
+    unsigned int uiRate;
+    /* Fill level in frames the controller steers the ALSA buffer to */
+    double dTargetFill;
+    /* Low pass filtered fill level */
+    double dFillAvg;
+    /* Integral of the fill error, in frame-seconds */
+    double dIntegral;
+    /* Correction currently applied in ppm. Negative shortens the stream */
+    double dRatioPpm;
+    /* Fractional read position in the staging buffer */
+    double dPhase;
+    /* Set once the first fill measurement has been taken */
+    AAP_BOOL bPrimed;
+    /* History frames followed by the current input chunk */
+    short *psStage;
+    /* Capacity of psStage in frames */
+    unsigned int uiStageCap;
+    /* Resampled output handed to ALSA */
+    short *psOut;
+    /* Capacity of psOut in frames */
+    unsigned int uiOutCap;
+    /* Interpolator for uiChannels, see AlsaKernels */
+    unsigned int (*pfResample)(const short *psStage, short *psOut,
+            unsigned int uiChannels, double *pdPhase, double dStep, double dEnd);
+}AlsaDriftComp;
+
+int alsa_drift_init(AlsaDriftComp *psDrift,
+        unsigned int uiChannels,
+        unsigned int uiRate,
+        unsigned long ulTargetFill);
+void alsa_drift_update(AlsaDriftComp *psDrift,
+        long lFill,
+        unsigned int uiFrames);
+int alsa_drift_process(AlsaDriftComp *psDrift,
+        const short *psIn,
+        unsigned int uiInFrames,
+        const short **ppsOut);
+void alsa_drift_reset(AlsaDriftComp *psDrift);
+void alsa_drift_set_target(AlsaDriftComp *psDrift, unsigned long ulTargetFill);
+void alsa_drift_deinit(AlsaDriftComp *psDrift);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_DRIFT_COMP_H_ */
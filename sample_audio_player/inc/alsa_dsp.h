@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_dsp.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Vectorized sample processing kernels of the ALSA core player. The best
+ *   variant for the CPU is chosen when the library is loaded; every variant
+ *   gives bit-identical results to the scalar one.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_DSP_H_
+#define _ALSA_DSP_H_
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    /* Variant name for the logs: scalar, sse2, avx2 or neon */
+    const char *pcName;
+    /* psDst[i] = saturate(psDst[i] + psSrc[i]) */
+    void (*pfAddSatS16)(short *psDst, const short *psSrc, unsigned int uiSamples);
+    /* S16 to float in [-1, 1) */
+    void (*pfS16ToFloat)(const short *psIn, float *pfOut, unsigned int uiSamples);
+    /* Float to S16 with triangular dither of +/-1 LSB, rounded to nearest
+     * even and saturated. *puiSeed is advanced by uiSamples. */
+    void (*pfFloatToS16)(const float *pfIn, short *psOut, unsigned int uiSamples,
+            unsigned int *puiSeed);
+    /* Triangular dither of +/-1 LSB, in LSB, for samples *puiSeed on.
+     * *puiSeed is advanced by uiSamples. */
+    void (*pfTpdf)(float *pfOut, unsigned int uiSamples, unsigned int *puiSeed);
+    /* Q15 gain moving linearly from iFromQ15 towards iToQ15 over uiFrames,
+     * the same for all channels of a frame. Gains up to 32768 (unity). */
+    void (*pfGainRamp)(short *psData, unsigned int uiFrames,
+            unsigned int uiChannels, int iFromQ15, int iToQ15);
+    /* Splits interleaved float stereo into two planes */
+    void (*pfDeinterleave2)(const float *pfIn, float *pfLeft, float *pfRight,
+            unsigned int uiFrames);
+    /* Joins two float planes into interleaved stereo */
+    void (*pfInterleave2)(const float *pfLeft, const float *pfRight,
+            float *pfOut, unsigned int uiFrames);
+}AlsaDsp;
+
+const AlsaDsp *alsa_dsp_get(void);
+
+/* Shared by the variants for their tails, so that they stay exact. */
+/* Dither hash of sample number uiIndex */
+unsigned int alsa_dsp_hash(unsigned int uiIndex);
+/* Ramp of frames [uiFirst, uiLast): gain of frame i is
+ * (iBase + iStep * (i + 1)) >> 15, see alsa_dsp_ramp_params(). */
+void alsa_dsp_ramp_frames(short *psData, unsigned int uiFirst,
+        unsigned int uiLast, unsigned int uiChannels, int iBase, int iStep);
+void alsa_dsp_ramp_params(unsigned int uiFrames, int iFromQ15, int iToQ15,
+        int *piBase, int *piStep);
+
+/* Variant tables, used by alsa_dsp.cpp only. Each returns 0 when the
+ * variant is not built in. */
+int alsa_dsp_scalar(AlsaDsp *psDsp);
+int alsa_dsp_sse2(AlsaDsp *psDsp);
+int alsa_dsp_avx2(AlsaDsp *psDsp);
+int alsa_dsp_neon(AlsaDsp *psDsp);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_DSP_H_ */
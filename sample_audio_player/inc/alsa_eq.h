@@ -0,0 +1,96 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_eq.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Parametric EQ of the ALSA core player, a stage of the processing bus.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_EQ_H_
+#define _ALSA_EQ_H_
+
+#include "aap_plat_media_player_types.h"
+#include "alsa_bus.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of cascaded biquad sections */
+#define ALSA_EQ_MAX_BANDS 8
+
+#if ALSA_FIXED_POINT
+/* Coefficients are Q27, of at most ALSA_EQ_MAX_COEF in magnitude: with bus
+ * samples below 1 << 31 the products of a section sum up within 64 bits. */
+#define ALSA_EQ_COEF_BITS 27
+#endif
+#define ALSA_EQ_MAX_COEF 8.0
+
+/* One biquad section, normalized to a0 = 1 */
+typedef struct
+{
+#if ALSA_FIXED_POINT
+    int aiB[3];
+    int aiA[2];
+#else
+    float afB[3];
+    float afA[2];
+#endif
+}AlsaEqCoef;
+
+typedef struct
+{
+    /* Number of sections in use, 0 when the EQ is off */
+    unsigned int uiBands;
+    AlsaEqCoef asCoef[ALSA_EQ_MAX_BANDS];
+}AlsaEqSet;
+
+typedef struct
+{
+    /* Number of interleaved channels */
+    unsigned int uiChannels;
+    /* Sample rate the bands are designed for */
+    unsigned int uiRate;
+    /* Sections run by the render thread */
+    AlsaEqSet sActive;
+#if ALSA_FIXED_POINT
+    /* Direct form I history per section: x[n-1], x[n-2], y[n-1], y[n-2] */
+    int aiState[ALSA_EQ_MAX_BANDS][4][ALSA_BUS_MAX_CHANNELS];
+#else
+    /* Transposed direct form II state per section: z1, z2 */
+    float afState[ALSA_EQ_MAX_BANDS][2][ALSA_BUS_MAX_CHANNELS];
+#endif
+    /* Sections set by the application, taken over by the render thread at
+     * the start of its next period */
+    AlsaEqSet sPending;
+    volatile int iPendingLock;
+    volatile AAP_BOOL bPending;
+}AlsaEq;
+
+int alsa_eq_init(AlsaEq *psEq, unsigned int uiChannels, unsigned int uiRate);
+int alsa_eq_set(AlsaEq *psEq, const AAPPlayerEqBand *pasBands, unsigned int uiBands);
+/* Bus stage callbacks, pvEq is the AlsaEq */
+void alsa_eq_process(void *pvEq, AlsaBusSample *ptBus, unsigned int uiFrames);
+AAP_BOOL alsa_eq_active(void *pvEq);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_EQ_H_ */
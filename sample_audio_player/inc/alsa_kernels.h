@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_kernels.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Per sample processing of the ALSA core player, specialized per input
+ *   format and channel count. A set is selected once when the player is
+ *   initialized; the render path then calls through fixed function pointers.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_KERNELS_H_
+#define _ALSA_KERNELS_H_
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* When set, the per sample processing of the render path - resampling and
+ * the processing bus - uses Q15/Q31 integer arithmetic only, for targets
+ * without a fast FPU. Built with FIXED_POINT=1, see the Makefile. */
+#ifndef ALSA_FIXED_POINT
+#define ALSA_FIXED_POINT 0
+#endif
+
+/* Sample formats the player accepts. The player works in S16 internally. */
+typedef enum
+{
+    ALSA_SAMPLE_S16,
+    ALSA_SAMPLE_S32,
+    ALSA_SAMPLE_FLOAT
+}AlsaSampleFormat;
+
+typedef struct
+{
+    /* Format and channel count the set was selected for */
+    AlsaSampleFormat eFormat;
+    unsigned int uiChannels;
+    /* Size of one input frame in bytes */
+    unsigned int uiInFrameBytes;
+    /* Converts input frames to S16. NULL when the input is S16 already. */
+    void (*pfImport)(const void *pvIn, short *psOut, unsigned int uiFrames,
+            unsigned int uiChannels);
+    /* Applies a linear Q15 gain ramp from iFromQ15 to iToQ15 */
+    void (*pfRamp)(short *psData, unsigned int uiFrames, unsigned int uiChannels,
+            int iFromQ15, int iToQ15);
+    /* Cubic Hermite resampling of psStage, see alsa_drift_comp.cpp. Advances
+     * *pdPhase by dStep up to dEnd and returns the frames written. */
+    unsigned int (*pfResample)(const short *psStage, short *psOut,
+            unsigned int uiChannels, double *pdPhase, double dStep, double dEnd);
+    /* Name of the selected specialization, for the logs */
+    const char *pcName;
+}AlsaKernels;
+
+/* Converts S16 samples to the device format */
+typedef void (*AlsaExportFunc)(const short *psIn, void *pvOut, unsigned int uiSamples);
+
+int alsa_kernels_select(AlsaKernels *psKernels, AlsaSampleFormat eFormat,
+        unsigned int uiChannels);
+AlsaExportFunc alsa_kernels_export(AlsaSampleFormat eFormat);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_KERNELS_H_ */
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_limiter.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Look-ahead peak limiter of the ALSA core player, the last stage of the
+ *   processing bus.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_LIMITER_H_
+#define _ALSA_LIMITER_H_
+
+#include <stdint.h>
+
+#include "aap_plat_media_player_types.h"
+#include "alsa_bus.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Look-ahead, and so the delay the limiter adds */
+#define ALSA_LIMITER_LOOKAHEAD_US 1000
+/* Release time constant */
+#define ALSA_LIMITER_RELEASE_MS 50
+/* Gains are Q30 in both builds, unity is 1 << 30 */
+#define ALSA_LIMITER_UNITY (1 << 30)
+
+typedef struct
+{
+    /* Number of interleaved channels */
+    unsigned int uiChannels;
+    /* Look-ahead in frames */
+    unsigned int uiLookahead;
+    /* Release coefficient, Q24 */
+    int iRelease;
+    /* Ceiling in bus units, written by the application thread */
+    volatile AlsaBusSample tCeiling;
+    /* Set to run the limiter, written by the application thread */
+    volatile AAP_BOOL bEnable;
+    /* Set while the limiter runs, so that it starts over when enabled */
+    AAP_BOOL bRunning;
+    /* Delay line of uiLookahead frames */
+    AlsaBusSample *ptDelay;
+    /* Sliding minimum of the required gain over uiLookahead + 1 frames:
+     * a monotonic deque of frame numbers and gains, in a ring */
+    unsigned int *puiDequeAt;
+    int *piDequeGain;
+    unsigned int uiDequeHead;
+    unsigned int uiDequeCount;
+    /* Moving average over uiLookahead frames of the released gain */
+    int *piBox;
+    int64_t llBoxSum;
+    /* Frames processed, for the window of the deque */
+    unsigned int uiFrame;
+    /* Position of the current frame in the delay line and average */
+    unsigned int uiPos;
+    /* Held gain after release */
+    int iReleased;
+    /* Metrics: gain of the last frame, lowest gain since the last reset,
+     * frames played with reduced gain. iMinGain is lowered by the render
+     * thread and reset by the reader with atomic operations only. */
+    volatile int iGain;
+    volatile int iMinGain;
+    volatile unsigned long ulLimitedFrames;
+}AlsaLimiter;
+
+int alsa_limiter_init(AlsaLimiter *psLimiter, unsigned int uiChannels,
+        unsigned int uiRate);
+void alsa_limiter_set(AlsaLimiter *psLimiter, AAP_BOOL bEnable, float fCeilingDb);
+void alsa_limiter_stats(AlsaLimiter *psLimiter, AAPPlayerLimiterStats *psStats);
+/* Bus stage callbacks, pvLimiter is the AlsaLimiter */
+void alsa_limiter_process(void *pvLimiter, AlsaBusSample *ptBus, unsigned int uiFrames);
+AAP_BOOL alsa_limiter_active(void *pvLimiter);
+void alsa_limiter_deinit(AlsaLimiter *psLimiter);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_LIMITER_H_ */
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_plc.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Timestamp based gap detection and packet loss concealment for the
+ *   ALSA core player.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_PLC_H_
+#define _ALSA_PLC_H_
+
+#include <stdint.h>
+
+#include "aap_standard_types.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Units of ulTimeStamp per second. Projection audio is stamped in us. */
+#define ALSA_PLC_TS_PER_SEC 1000000ULL
+
+typedef struct
+{
+    /* Number of interleaved channels */
+    unsigned int uiChannels;
+    /* Sample rate of the stream */
+    unsigned int uiRate;
+    /* Set once a timestamp has been seen */
+    AAP_BOOL bTsValid;
+    /* Timestamp the expected position is counted from */
+    uint64_t ullBaseTs;
+    /* Frames emitted since ullBaseTs */
+    uint64_t ullBaseFrames;
+    /* Last frames sent to the device, oldest first */
+    short *psHist;
+    /* Capacity of psHist in frames */
+    unsigned int uiHistFrames;
+    /* Valid frames in psHist */
+    unsigned int uiHistFill;
+    /* Mono downmix of psHist used for the pitch search */
+    float *pfMono;
+    /* Concealed and repaired output */
+    short *psOut;
+    /* Capacity of psOut in frames */
+    unsigned int uiOutCap;
+    /* Number of gaps concealed */
+    unsigned int uiGapCount;
+    /* Frames synthesized by concealment */
+    unsigned long ulConcealedFrames;
+    /* Late frames that were dropped */
+    unsigned long ulDroppedFrames;
+    /* Silence already played in place of missing data since the last packet.
+     * Set by the caller; such a gap is not concealed again. */
+    unsigned long ulCoveredFrames;
+}AlsaPlc;
+
+int alsa_plc_init(AlsaPlc *psPlc, unsigned int uiChannels, unsigned int uiRate);
+int alsa_plc_process(AlsaPlc *psPlc,
+        const short *psIn,
+        unsigned int uiFrames,
+        uint64_t ulTimeStamp,
+        const short **ppsOut);
+void alsa_plc_reset(AlsaPlc *psPlc);
+void alsa_plc_deinit(AlsaPlc *psPlc);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_PLC_H_ */
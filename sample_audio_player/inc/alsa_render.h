@@ -0,0 +1,98 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_render.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Render thread of the ALSA core player. It owns the PCM once the player
+ *   is initialized and feeds it from the frame ring.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_RENDER_H_
+#define _ALSA_RENDER_H_
+
+#include <semaphore.h>
+
+#include "alsa_audio_player.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* When set, the render thread injects faded silence before the PCM runs
+ * dry instead of letting it underrun. */
+#ifndef ALSA_UNDERRUN_AVOIDANCE
+#define ALSA_UNDERRUN_AVOIDANCE 1
+#endif
+
+/* When set, the PCM gets a large buffer of which only the latency is kept
+ * filled. Instead of waking on every period interrupt the render thread
+ * sleeps on a timer until the fill is down to a watermark, then tops it up
+ * in one go. The watermark keeps a margin of twice the timer lateness seen
+ * lately above the underrun guard. */
+#ifndef ALSA_TSCHED
+#define ALSA_TSCHED 0
+#endif
+/* Buffer asked for in timer mode */
+#define ALSA_TSCHED_BUFFER_MS 500
+/* Frames rendered at a time in timer mode */
+#define ALSA_TSCHED_CHUNK_MS 10
+/* Smallest margin of the watermark in timer mode */
+#define ALSA_TSCHED_MIN_MARGIN_US 1000
+/* Fill of the deep buffer mode, see audio_player_set_deep_buffer() */
+#define ALSA_DEEP_BUFFER_MS 400
+/* Latencies audio_player_set_latency() takes */
+#define ALSA_LATENCY_MIN_MS 20
+#define ALSA_LATENCY_MAX_MS 500
+/* Time a running PCM may go without its hardware pointer moving before the
+ * render thread gives up on the write and restarts it, 0 for no watchdog.
+ * Set with WATCHDOG_MS=ms, see the Makefile, or audio_player_set_watchdog(). */
+#ifndef ALSA_WATCHDOG_MS
+#define ALSA_WATCHDOG_MS 500
+#endif
+/* Timeouts audio_player_set_watchdog() takes besides 0 */
+#define ALSA_WATCHDOG_MIN_MS 100
+#define ALSA_WATCHDOG_MAX_MS 10000
+
+/* Requests posted to the render thread, see alsa_render_request() */
+/* Drop what is queued in the PCM and prepare it again */
+#define ALSA_RENDER_REQ_RESTART 0x1
+/* Fade out and halt the PCM until the next restart, keeping the ring */
+#define ALSA_RENDER_REQ_PAUSE 0x2
+/* As pause, and drop what is left in the ring */
+#define ALSA_RENDER_REQ_STOP 0x4
+/* Apply a lowered bus gain to what the PCM has queued already */
+#define ALSA_RENDER_REQ_PREEMPT 0x8
+/* Move the fill to the one uiLatencyMs and bDeepBuffer ask for */
+#define ALSA_RENDER_REQ_FILL 0x10
+/* Transport requests, a new one replaces any still pending */
+#define ALSA_RENDER_REQ_TRANSPORT (ALSA_RENDER_REQ_RESTART | \
+        ALSA_RENDER_REQ_PAUSE | ALSA_RENDER_REQ_STOP)
+
+int alsa_render_start(AlsaConfig *psAlsaConfig);
+void alsa_render_stop(AlsaConfig *psAlsaConfig);
+void alsa_render_request(AlsaConfig *psAlsaConfig, unsigned int uiReq);
+int alsa_render_sem_wait(sem_t *psSem, unsigned int uiTimeoutMs);
+int alsa_render_set_thread_config(AlsaConfig *psAlsaConfig,
+        const AAP_ThreadConfig *psThreadConfig);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_RENDER_H_ */
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_ring.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Single producer / single consumer frame ring between the thread pushing
+ *   audio and the render thread of the ALSA core player. Lock free: each
+ *   index is only ever written by one side.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_RING_H_
+#define _ALSA_RING_H_
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    /* Frame storage */
+    unsigned char *pucBuf;
+    /* Bytes per frame */
+    unsigned int uiFrameBytes;
+    /* Capacity in frames */
+    unsigned int uiCapFrames;
+    /* Total frames written, only updated by the producer */
+    volatile unsigned long ulWrite;
+    /* Total frames read, only updated by the consumer */
+    volatile unsigned long ulRead;
+}AlsaRing;
+
+int alsa_ring_init(AlsaRing *psRing, unsigned int uiCapFrames,
+        unsigned int uiFrameBytes);
+unsigned int alsa_ring_fill(const AlsaRing *psRing);
+unsigned int alsa_ring_space(const AlsaRing *psRing);
+unsigned int alsa_ring_write(AlsaRing *psRing, const void *pvData,
+        unsigned int uiFrames);
+unsigned int alsa_ring_read(AlsaRing *psRing, void *pvData,
+        unsigned int uiFrames);
+unsigned int alsa_ring_skip(AlsaRing *psRing, unsigned int uiFrames);
+void alsa_ring_deinit(AlsaRing *psRing);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_RING_H_ */
@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_rt_check.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Real-time safety checks for the render thread, built in with
+ *   ALSA_RT_CHECK (make RT_CHECK=1). Once the render thread is armed, heap
+ *   calls, contended mutexes, console output and sleeping or mapping system
+ *   calls made from it are counted, or abort the process when the
+ *   environment variable AAP_RT_CHECK_ABORT is set.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_RT_CHECK_H_
+#define _ALSA_RT_CHECK_H_
+
+#include "aap_standard_types.h"
+
+#ifndef ALSA_RT_CHECK
+#define ALSA_RT_CHECK 0
+#endif
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#if ALSA_RT_CHECK
+void alsa_rt_check_init(void);
+void alsa_rt_check_arm(AAP_BOOL bArm);
+unsigned long alsa_rt_check_violations(void);
+/* Times a thread has been armed, to tell checks that never ran from a
+ * clean run */
+unsigned long alsa_rt_check_armed(void);
+void alsa_rt_check_report(void);
+#else
+#define alsa_rt_check_init()
+#define alsa_rt_check_arm(bArm)
+#define alsa_rt_check_violations() (0UL)
+#define alsa_rt_check_armed() (0UL)
+#define alsa_rt_check_report()
+#endif
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_RT_CHECK_H_ */
@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_thread.h
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Scheduling and memory locking helpers for the threads of the ALSA core
+ *   player.
+ *
+ ******************************************************************************/
+
+#ifndef _ALSA_THREAD_H_
+#define _ALSA_THREAD_H_
+
+#include <pthread.h>
+
+#include "aap_types.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+/* Stack size of the player threads, locked in memory as a whole */
+#define ALSA_THREAD_STACK_SIZE (256 * 1024)
+
+int alsa_thread_create(pthread_t *psThread, void *(*pfEntry)(void *),
+        void *pvArg);
+int alsa_thread_apply_config(pthread_t sThread,
+        const AAP_ThreadConfig *psThreadConfig);
+void alsa_thread_lock_stack(AAP_BOOL bLock);
+void alsa_thread_lock_mem(void *pvAddr, unsigned long ulSize, AAP_BOOL bLock);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif /* ifndef _ALSA_THREAD_H_ */
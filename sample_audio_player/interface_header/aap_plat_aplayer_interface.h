@@ -75,6 +75,19 @@ typedef struct
  *
  * In this function, allocate all resources which are required by audio player.
  *
+ * \note
+ * 1. The device is opened without ALSA's rate, channel and format
+ * conversions and run in the configuration it supports that is nearest to
+ * the stream; the player converts the stream onto it. Only when the device
+ * has none is the stream format used with ALSA converting. See
+ * #aap_plat_aplayer_get_output_path.
+ * 2. acAudioDeviceID may name a hardware device such as "hw:0,0" directly,
+ * leaving no plugin between the player and the driver.
+ * 3. What the device supports and the buffer sizes it settled on are kept in
+ * a file, by default /var/cache/aap/alsa_caps, keyed by device, card and
+ * driver version. Later inits, also after a reboot, take them from there
+ * instead of probing and negotiating again. The directory must be writable.
+ *
  * \ingroup Audio
  *
  * \param [out] pulPlayerHandle Returns the handle of the audio player.
@@ -96,6 +109,38 @@ AAP_RetType aap_plat_aplayer_init(AAP_HANDLE* pulPlayerHandle,
         AAPAudioConfig *psAudioConfig, AAPPlayerCbFunc pfAppCb,
         void* pvUserParam);
 
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_init_session(AAPPlayerSet *psPlayers,
+ *          const AAP_ExtAttributes *psAttributes, AAPPlayerCbFunc pfAppCb,
+ *          void *pvMediaParam, void *pvGuidanceParam);
+ *
+ * \brief Brings up the media and guidance players of a session at once. Each
+ * is initialized as by #aap_plat_aplayer_init on a thread of its own, from
+ * the codec, bits per sample and device ID given for it in psAttributes, so
+ * the call takes as long as the slowest device rather than the sum of all.
+ * It returns once both are ready to play.
+ *
+ * \note
+ * 1. Either both players are initialized or, on failure, neither.
+ * 2. The microphone is recorded outside the player, acMicDeviceID is not
+ * used.
+ * 3. #aap_plat_aplayer_deinit_session releases both players the same way.
+ *
+ * \ingroup Audio
+ *
+ * \param [out] psPlayers        Handles of the players.
+ * \param [in]  psAttributes     Session attributes the players are set up from.
+ * \param [in]  pfAppCb          Callback function of both players.
+ * \param [in]  pvMediaParam     User data passed to the callback by the media player.
+ * \param [in]  pvGuidanceParam  User data passed to the callback by the guidance player.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_init_session(AAPPlayerSet *psPlayers,
+        const AAP_ExtAttributes *psAttributes, AAPPlayerCbFunc pfAppCb,
+        void *pvMediaParam, void *pvGuidanceParam);
+
 /*!
  * \fn AAP_RetType aap_plat_aplayer_play(AAP_HANDLE ulPlayerHandle);
  *
@@ -141,6 +186,13 @@ AAP_RetType aap_plat_aplayer_play(AAP_HANDLE ulPlayerHandle);
  * 1. This function likely to get called frequently and multiple times.
  * 2. Before calling this function, only once #aap_plat_aplayer_init and
  * #aap_plat_aplayer_play functions will be called.
+ * 3. While the output device is stalled the data that does not fit is
+ * dropped at once, see #aap_plat_aplayer_set_watchdog.
+ * 4. Once the output device failed beyond recovery, reported by one
+ * E_AAP_PLAYER_FACED_ERROR, the data that does not fit is dropped at once
+ * until #aap_plat_aplayer_play prepares the device again.
+ * 5. While paused or stopped the player queues data only until it is full
+ * and then returns at once, the rest is not queued.
  *
  * \ingroup Audio
  *
@@ -151,6 +203,12 @@ AAP_RetType aap_plat_aplayer_play(AAP_HANDLE ulPlayerHandle);
  * \param [in]  ulTimeStamp     Time stamp of the audio frame.
  *
  * \retval 0 On success.
+ * \retval E_AAP_ERROR_PLAYER_TIMEOUT The output device stopped playing,
+ * the data was not queued.
+ * \retval E_AAP_ERROR_PLAYER_PUSH_BUFFER The output device failed, the data
+ * was not queued.
+ * \retval E_AAP_ERROR_PLAYER_INVALID_STATE The player is paused or stopped
+ * and full, the data that did not fit was not queued.
  * \retval -1 On failure.
  *
  * \par Sequence Diagram:
@@ -160,10 +218,372 @@ AAP_RetType aap_plat_aplayer_process_data(AAP_HANDLE ulPlayerHandle,
         unsigned char *pucData, unsigned int uiSize,
         uint64_t ulTimeStamp);
 
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_process_data_nb(AAP_HANDLE ulPlayerHandle,
+ *          unsigned char *pucData, unsigned int uiSize,
+ *          uint64_t ulTimeStamp, unsigned int *puiAccepted);
+ *
+ * \brief Non-blocking variant of #aap_plat_aplayer_process_data. It takes as
+ * much of the audio data as the player has room for and returns at once, so
+ * the caller can apply flow control to its source instead of stalling.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init\n
+ * #aap_plat_aplayer_play
+ *
+ * \note
+ * 1. The part not accepted has to be passed again later, starting at
+ * pucData + *puiAccepted, with its time stamp advanced by the duration of the
+ * accepted part.
+ * 2. The player drains one period at a time, retrying after about one
+ * period is enough. While paused or stopped it does not drain, and keeps
+ * returning AAP_ERR_RETRY once full.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  pucData         Buffer pointer of the audio data. Audio player
+ *                              MUST not free this memory.
+ * \param [in]  uiSize          Audio data size in bytes.
+ * \param [in]  ulTimeStamp     Time stamp of the audio frame.
+ * \param [out] puiAccepted     Number of bytes taken by the player.
+ *
+ * \retval 0 All data accepted.
+ * \retval AAP_ERR_RETRY The player is full, only *puiAccepted bytes (possibly
+ * none) were taken.
+ * \retval E_AAP_ERROR_PLAYER_TIMEOUT The player is full as the output device
+ * stopped playing, no bytes were taken.
+ * \retval E_AAP_ERROR_PLAYER_PUSH_BUFFER The player is full as the output
+ * device failed, no bytes were taken.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_process_data_nb(AAP_HANDLE ulPlayerHandle,
+        unsigned char *pucData, unsigned int uiSize,
+        uint64_t ulTimeStamp, unsigned int *puiAccepted);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_pull_mode(AAP_HANDLE ulPlayerHandle,
+ *          AAP_BOOL bEnable);
+ *
+ * \brief Switches the player between push and pull mode. In pull mode the
+ * player calls pfAppCb with E_AAP_PLAYER_INPUT_BUFFER and an
+ * #AAPPlayerPullBuffer each time the output device has room for one period.
+ * The application fills it before returning, so local sources produce their
+ * data just in time with no buffering in between.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init with a callback function
+ *
+ * \note
+ * 1. The callback runs on the render thread and must not block.
+ * 2. #aap_plat_aplayer_process_data fails while pull mode is on.
+ * 3. The data is played as is, so pull mode needs a stream in the format of
+ * the device, see #aap_plat_aplayer_get_output_path.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  bEnable         AAP_TRUE for pull mode, AAP_FALSE for push mode.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_pull_mode(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_gain(AAP_HANDLE ulPlayerHandle,
+ *          AAP_FLOAT fGain);
+ *
+ * \brief Sets the linear gain applied to this player's output. The change is
+ * ramped in over one period.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. Gains above 1.0 are allowed, the output saturates at full scale.
+ * 2. At a gain of exactly 1.0 S16 data is played bit exact, otherwise it is
+ *    requantized with dither.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  fGain           Linear gain, 0.0 or more.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_gain(AAP_HANDLE ulPlayerHandle,
+        AAP_FLOAT fGain);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_eq(AAP_HANDLE ulPlayerHandle,
+ *          const AAPPlayerEqBand *pasBands, AAP_UINT32 uiBands);
+ *
+ * \brief Sets the parametric EQ of this player, a cascade of up to eight
+ * biquad bands applied to its output. Each player has its own EQ, so media
+ * and guidance streams can be tuned separately.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. The new bands take effect from the next period on.
+ * 2. A band count of 0 turns the EQ off. While it is off and the gain is
+ *    1.0, S16 data is played bit exact.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  pasBands        Array of uiBands #AAPPlayerEqBand, applied in order.
+ * \param [in]  uiBands         Number of bands, 0 to 8.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_eq(AAP_HANDLE ulPlayerHandle,
+        const AAPPlayerEqBand *pasBands, AAP_UINT32 uiBands);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_limiter(AAP_HANDLE ulPlayerHandle,
+ *          AAP_BOOL bEnable, AAP_FLOAT fCeilingDb);
+ *
+ * \brief Turns the look-ahead peak limiter on this player's output on or off.
+ * Peaks above the ceiling are brought down smoothly instead of clipping. A
+ * ceiling below 0 dBFS leaves headroom for streams mixed after the player,
+ * e.g. media and guidance through dmix.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. While on, the limiter delays the output by 1 ms.
+ * 2. See #aap_plat_aplayer_get_limiter_stats for tuning the ceiling.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  bEnable         AAP_TRUE to turn the limiter on.
+ * \param [in]  fCeilingDb      Output ceiling in dBFS, -24.0 to 0.0.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_limiter(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable, AAP_FLOAT fCeilingDb);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_get_limiter_stats(AAP_HANDLE ulPlayerHandle,
+ *          AAPPlayerLimiterStats *psStats);
+ *
+ * \brief Reads the gain reduction of the output limiter.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * The largest reduction is counted from the previous call on.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [out] psStats         Gain reduction figures.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_get_limiter_stats(AAP_HANDLE ulPlayerHandle,
+        AAPPlayerLimiterStats *psStats);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_get_output_path(AAP_HANDLE ulPlayerHandle,
+ *          AAPPlayerOutputPath *psPath);
+ *
+ * \brief Reads the format the output device was opened in and whether the
+ * player converts the stream to reach it.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [out] psPath          Output format and conversions.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_get_output_path(AAP_HANDLE ulPlayerHandle,
+        AAPPlayerOutputPath *psPath);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_reconfigure(AAP_HANDLE ulPlayerHandle,
+ *          const AAPAudioConfig *psAudioConfig);
+ *
+ * \brief Changes the format of the data pushed, e.g. when the phone moves
+ * between 44.1 kHz and 48 kHz content. The channels, sample rate and bits
+ * per sample of psAudioConfig apply to all data pushed after the call.
+ *
+ * The device stays open in the format given to #aap_plat_aplayer_init. The
+ * new input is converted onto it, so playback goes on without a reopen.
+ * Data queued before the call plays out as it was, and the output fades
+ * out and back in within 3 ms either side of the change.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. Call it from the thread pushing the data, between two pushes.
+ * 2. Other fields of psAudioConfig are ignored.
+ * 3. Sample rates over twice the device one are refused.
+ * 4. Not available in pull mode.
+ * 5. Timestamps pushed after the call start a new segment.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  psAudioConfig   New input format.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_reconfigure(AAP_HANDLE ulPlayerHandle,
+        const AAPAudioConfig *psAudioConfig);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_latency(AAP_HANDLE ulPlayerHandle,
+ *          AAP_UINT32 uiLatencyMs);
+ *
+ * \brief Changes the output latency of a running player, without closing
+ * the device or losing what is queued.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. A latency the device buffer holds only moves the fill level kept. A
+ *    lower one is reached once the device has played down to it, a higher
+ *    one as data comes in.
+ * 2. A latency beyond the device buffer plays out what is queued, ending in
+ *    a short fade, and then gives the device a larger buffer. This is not
+ *    seamless: the output dips through the fade, and for up to the old
+ *    buffer length the player takes no data and acts on no other request.
+ *    A device that takes neither buffer fails as reported by
+ *    E_AAP_PLAYER_FACED_ERROR.
+ * 3. Data the application sent ahead while the device played down stays
+ *    queued, drift compensation takes it up over time.
+ * 4. The latency is given to the render thread and applied asynchronously.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  uiLatencyMs     Latency in ms, 20 to 500.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_latency(AAP_HANDLE ulPlayerHandle,
+        AAP_UINT32 uiLatencyMs);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_deep_buffer(AAP_HANDLE ulPlayerHandle,
+ *          AAP_BOOL bEnable);
+ *
+ * \brief Switches a media player between deep buffering and its configured
+ * latency. Deep buffering keeps 400 ms queued and tops it up in large
+ * batches, so the CPU is woken far less often. Meant for media-only
+ * playback with the display off.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. Only media players in the timer scheduled build (TSCHED=1) support it.
+ * 2. The deeper fill builds up over the following seconds. Switching back
+ *    takes effect at once, the excess is faded out and dropped.
+ * 3. Switch it off when guidance or user interaction starts or the display
+ *    turns on.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  bEnable         AAP_TRUE for deep buffering.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_deep_buffer(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_watchdog(AAP_HANDLE ulPlayerHandle,
+ *          AAP_UINT32 uiTimeoutMs);
+ *
+ * \brief Sets how long the output device may stop playing before the player
+ * gives up on it. Once its hardware position has not moved for the timeout
+ * while data is queued, the player drops what it holds and restarts the
+ * device, so a hung device cannot block the caller or the session.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. The timeout is 500 ms unless set otherwise, or built with WATCHDOG_MS.
+ * 2. On a stall pfAppCb gets E_AAP_PLAYER_FACED_ERROR with pvData pointing
+ *    to an int holding E_AAP_ERROR_PLAYER_TIMEOUT, and E_AAP_PLAYER_PLAYING
+ *    once the device plays again. The restart is repeated each timeout
+ *    meanwhile.
+ * 3. Until then pushing data the player has no room for returns
+ *    E_AAP_ERROR_PLAYER_TIMEOUT at once instead of waiting.
+ * 4. The timeout has to exceed the longest time the device takes to report
+ *    progress, at least one period.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  uiTimeoutMs     Timeout in ms, 100 to 10000, 0 to disable it.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_watchdog(AAP_HANDLE ulPlayerHandle,
+        AAP_UINT32 uiTimeoutMs);
+
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_set_thread_config(AAP_HANDLE ulPlayerHandle,
+ *          const AAP_ConfigParams *psConfigParams);
+ *
+ * \brief Applies the scheduling policy, priority and CPU affinity configured
+ * for this player's stream to the player's own threads. Media uses
+ * AAP_THREAD_INDEX_AUDIO_MEDIA, microphone AAP_THREAD_INDEX_AUDIO_RECORDER
+ * and all other streams AAP_THREAD_INDEX_AUDIO_GUIDANCE.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init
+ *
+ * \note
+ * 1. Real-time policies need CAP_SYS_NICE or a suitable RLIMIT_RTPRIO.
+ * 2. The setting is kept and applied again to threads started later.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ * \param [in]  psConfigParams  AAP stack configuration holding asThreadConfig.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_set_thread_config(AAP_HANDLE ulPlayerHandle,
+        const AAP_ConfigParams *psConfigParams);
+
 /*!
  * \fn AAP_RetType aap_plat_aplayer_pause(AAP_HANDLE ulPlayerHandle);
  *
  * \brief This function is called to pause the data processing temporarily.
+ * The output is faded out at once, without a click, and audio data not yet
+ * played stays queued for #aap_plat_aplayer_play to resume with, faded in.
+ * Call it on a transient loss of audio focus as well.
  *
  * \ingroup Audio
  *
@@ -178,6 +598,43 @@ AAP_RetType aap_plat_aplayer_process_data(AAP_HANDLE ulPlayerHandle,
  */
 AAP_RetType aap_plat_aplayer_pause(AAP_HANDLE ulPlayerHandle);
 
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_drain(AAP_HANDLE ulPlayerHandle);
+ *
+ * \brief Marks the end of the stream pushed so far and returns at once.
+ * pfAppCb gets E_AAP_PLAYER_FACED_ERROR with pvData pointing to an int
+ * holding E_AAP_ERROR_PLAYER_EOS when the last sample of it has left the
+ * device, as computed from the device delay.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init with a callback function\n
+ * #aap_plat_aplayer_play
+ *
+ * \note
+ * 1. Data pushed after the drain plays on right after the end, with no gap
+ *    or overlap, so the next stream can be pushed at once. Pushed later, it
+ *    starts over once the device has run dry.
+ * 2. A tail shorter than a period is played as is and padded with silence,
+ *    not faded.
+ * 3. The next stream starts a new timestamp sequence.
+ * 4. Only one drain may be pending, until its EOS.
+ * 5. If the end is dropped by #aap_plat_aplayer_stop, a pause or a stalled
+ *    device, EOS comes once the device has nothing queued. Each drain gets
+ *    exactly one EOS.
+ * 6. Wait for EOS before #aap_plat_aplayer_deinit, which cuts the output.
+ *
+ * \ingroup Audio
+ *
+ * \param [in]  ulPlayerHandle  Handle of audio player returned by aap_plat_aplayer_init() API.
+ *
+ * \retval 0 On success.
+ * \retval AAP_ERR_RETRY Data held back by #aap_plat_aplayer_process_data_nb
+ * does not fit yet, drain again later.
+ * \retval AAP_ERR_IFACE_BUSY A drain is still pending.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_drain(AAP_HANDLE ulPlayerHandle);
+
 /*!
  * \fn AAP_RetType aap_plat_aplayer_stop(AAP_HANDLE ulPlayerHandle);
  *
@@ -191,6 +648,8 @@ AAP_RetType aap_plat_aplayer_pause(AAP_HANDLE ulPlayerHandle);
  * \note
  * 1. This function can be called multiple times during an active AAP session
  * with the pair of #aap_plat_aplayer_play.
+ * 2. The output is faded out at once, without a click, and audio data not yet
+ * played is dropped. Call it on a permanent loss of audio focus as well.
  *
  * \ingroup Audio
  *
@@ -229,6 +688,24 @@ AAP_RetType aap_plat_aplayer_stop(AAP_HANDLE ulPlayerHandle);
  */
 AAP_RetType aap_plat_aplayer_deinit(AAP_HANDLE *pulPlayerHandle);
 
+/*!
+ * \fn AAP_RetType aap_plat_aplayer_deinit_session(AAPPlayerSet *psPlayers);
+ *
+ * \brief Uninitializes the players brought up by
+ * #aap_plat_aplayer_init_session, each on a thread of its own.
+ *
+ * \par Precondition:
+ * #aap_plat_aplayer_init_session
+ *
+ * \ingroup Audio
+ *
+ * \param [in,out] psPlayers  Handles of the players, cleared on return.
+ *
+ * \retval 0 On success.
+ * \retval -1 On failure.
+ */
+AAP_RetType aap_plat_aplayer_deinit_session(AAPPlayerSet *psPlayers);
+
 #if defined __cplusplus
 }
 #endif
@@ -86,15 +86,18 @@ enum
  * \brief Different players state */
 typedef enum
 {
-    /*! \brief Player faced an error */
+    /*! \brief Player faced an error. When uiDataLen is sizeof(int), pvData
+     * points to the E_AAP_ERROR_PLAYER_* code of it. */
     E_AAP_PLAYER_FACED_ERROR,
     /*! \brief Player is in ready state */
     E_AAP_PLAYER_READY,
-    /*! \brief Player is in pause state */
+    /*! \brief Player is in pause state. Also raised when the output device
+     * is suspended, E_AAP_PLAYER_PLAYING follows once it is resumed. */
     E_AAP_PLAYER_PAUSED,
     /*! \brief Player is in playing state */
     E_AAP_PLAYER_PLAYING,
-    /*! \brief input buffer from player/recorder*/
+    /*! \brief input buffer from player/recorder. In pull mode the player
+     * passes an AAPPlayerPullBuffer to be filled within the callback. */
     E_AAP_PLAYER_INPUT_BUFFER,
     /*! \brief Player is in idle state */
     E_AAP_PLAYER_IDEL,
@@ -102,6 +105,91 @@ typedef enum
     E_AAP_PLAYER_QUIT
 }AAPPlayer_Events;
 
+/*! \struct AAPPlayerPullBuffer
+ * \brief Buffer passed with E_AAP_PLAYER_INPUT_BUFFER in pull mode. */
+typedef struct
+{
+    /*! Where the application writes its audio data */
+    AAP_UCHAR *pucData;
+    /*! Bytes requested, one period of the output device */
+    AAP_UINT32 uiSize;
+    /*! Bytes written by the application. Anything short of uiSize is
+     * played as silence. */
+    AAP_UINT32 uiFilled;
+}AAPPlayerPullBuffer;
+
+/*! \enum AAPPlayerEqType
+ * \brief Filter shape of an EQ band */
+typedef enum
+{
+    /*! \brief Bell boosting or cutting around fFreqHz */
+    E_AAP_EQ_PEAKING,
+    /*! \brief Boost or cut below fFreqHz */
+    E_AAP_EQ_LOW_SHELF,
+    /*! \brief Boost or cut above fFreqHz */
+    E_AAP_EQ_HIGH_SHELF,
+    /*! \brief Second order low pass, fGainDb unused */
+    E_AAP_EQ_LOW_PASS,
+    /*! \brief Second order high pass, fGainDb unused */
+    E_AAP_EQ_HIGH_PASS
+}AAPPlayerEqType;
+
+/*! \struct AAPPlayerEqBand
+ * \brief One band of the player's parametric EQ */
+typedef struct
+{
+    /*! Filter shape */
+    AAPPlayerEqType eType;
+    /*! Center or corner frequency in Hz, below half the sample rate */
+    AAP_FLOAT fFreqHz;
+    /*! Boost (positive) or cut (negative) in dB, within +/-24 dB */
+    AAP_FLOAT fGainDb;
+    /*! Quality factor, 0.707 for a Butterworth pass filter */
+    AAP_FLOAT fQ;
+}AAPPlayerEqBand;
+
+/*! \struct AAPPlayerLimiterStats
+ * \brief Gain reduction of the player's output limiter */
+typedef struct
+{
+    /*! Gain reduction at the end of the last period, in dB */
+    AAP_FLOAT fReductionDb;
+    /*! Largest gain reduction since the previous read, in dB */
+    AAP_FLOAT fMaxReductionDb;
+    /*! Frames played with reduced gain since the player was initialized */
+    AAP_UINT64 ullLimitedFrames;
+}AAPPlayerLimiterStats;
+
+/*! \struct AAPPlayerOutputPath
+ * \brief Format the player's output device runs in, and the conversions
+ * made on the way to it */
+typedef struct
+{
+    /*! Sample rate of the device in Hz */
+    AAP_UINT32 uiRate;
+    /*! Channels of the device */
+    AAP_UINT32 uiChannels;
+    /*! Bits per sample written to the device, 16 or 32 */
+    AAP_UINT32 uiBits;
+    /*! AAP_TRUE when the device was opened without ALSA's conversions */
+    AAP_BOOL bNative;
+    /*! AAP_TRUE when the player resamples the input to uiRate */
+    AAP_BOOL bResampling;
+    /*! AAP_TRUE when the player maps the input channels onto uiChannels */
+    AAP_BOOL bChannelMapping;
+}AAPPlayerOutputPath;
+
+/*! \struct AAPPlayerSet
+ * \brief Players of a session, brought up together by
+ * #aap_plat_aplayer_init_session */
+typedef struct
+{
+    /*! Handle of the media player */
+    AAP_HANDLE ulMediaPlayer;
+    /*! Handle of the guidance player */
+    AAP_HANDLE ulGuidancePlayer;
+}AAPPlayerSet;
+
 /*! \enum AAPPlayerStreamType
  * \brief Different codec type for audio and video */
 typedef enum
@@ -48,6 +48,7 @@
  *
  ******************************************************************************/
 #include <string.h>
+#include <pthread.h>
 #include "aap_plat_aplayer_interface.h"
 #include "aap_plat_media_player_types.h"
 #ifdef GST
@@ -73,6 +74,21 @@ typedef struct
     AAP_StreamType eStreamType;
 }AAP_AudioPlayer;
 
+/*! \brief One player of a session, brought up or down on a thread */
+typedef struct
+{
+    /*! \brief Configuration derived from the session attributes */
+    AAPAudioConfig sConfig;
+    AAPPlayerCbFunc pfEventFunc;
+    void* pvCbParam;
+    /*! \brief Handle of the player, 0 until it is initialized */
+    AAP_HANDLE ulPlayer;
+    AAP_RetType iRet;
+    pthread_t sThread;
+    /*! \brief The job runs on sThread, else it ran on the caller */
+    AAP_BOOL bThread;
+}AAP_PlayerJob;
+
 AAP_RetType aap_plat_aplayer_init(AAP_HANDLE* pulPlayerHandle,
         AAPAudioConfig *psAudioConfig,
         AAPPlayerCbFunc pfAppCb, void* pvUserParam)
@@ -162,9 +178,67 @@ AAP_RetType aap_plat_aplayer_process_data(AAP_HANDLE ulPlayerHandle,
                     iRet = 1;
                     break;
                 }
-                if (0 != audio_player_push_buffer(
+                iRet = audio_player_push_buffer(
+                            (AAP_PLAYER_HANDLE)psPlayer->ulCorePlayer,
+                            pucData, uiSize, ulTimeStamp);
+                if (AAP_ERR_TIMEOUT == iRet)
+                {
+                    /* Output device stalled */
+                    iRet = E_AAP_ERROR_PLAYER_TIMEOUT;
+                    break;
+                }
+                if (AAP_ERR_RETRY == iRet)
+                {
+                    /* Paused with the player full */
+                    iRet = E_AAP_ERROR_PLAYER_INVALID_STATE;
+                    break;
+                }
+                if (0 != iRet)
+                {
+                    iRet = E_AAP_ERROR_PLAYER_PUSH_BUFFER;
+                    break;
+                }
+            }
+    }
+    return iRet;
+}
+
+/* Pushes buffer to player without waiting for space */
+AAP_RetType aap_plat_aplayer_process_data_nb(AAP_HANDLE ulPlayerHandle,
+        unsigned char *pucData, unsigned int uiSize, uint64_t ulTimeStamp,
+        unsigned int *puiAccepted)
+{
+    AAP_AudioPlayer* psPlayer = NULL;
+    AAP_RetType iRet = 0;
+    AAP_UINT32 uiState = API_TASK;
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulPlayerHandle)
+                {
+                    printf("ERR::AP::Passed a NULL handle \n");
+                    iRet = -1;
+                    break;
+                }
+                psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+                if (NULL == pucData  || 0 == uiSize || NULL == puiAccepted)
+                {
+                    /* Invalid data*/
+                    printf("ERR::AP::Invalid input pucData: %p uiSize %u puiAccepted: %p\n",
+                            pucData, uiSize, puiAccepted);
+                    iRet = 1;
+                    break;
+                }
+                iRet = audio_player_push_buffer_nb(
                             (AAP_PLAYER_HANDLE)psPlayer->ulCorePlayer,
-                            pucData, uiSize, ulTimeStamp))
+                            pucData, uiSize, ulTimeStamp, puiAccepted);
+                if (AAP_ERR_TIMEOUT == iRet)
+                {
+                    iRet = E_AAP_ERROR_PLAYER_TIMEOUT;
+                    break;
+                }
+                if ((0 != iRet) && (AAP_ERR_RETRY != iRet))
                 {
                     iRet = E_AAP_ERROR_PLAYER_PUSH_BUFFER;
                     break;
@@ -195,6 +269,257 @@ AAP_RetType aap_plat_aplayer_play(AAP_HANDLE ulPlayerHandle)
     return iRet;
 }
 
+/* Lets the player pull data from the application */
+AAP_RetType aap_plat_aplayer_set_pull_mode(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_pull_mode(psPlayer->ulCorePlayer, bEnable);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set pull mode\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_gain(AAP_HANDLE ulPlayerHandle,
+        AAP_FLOAT fGain)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_gain(psPlayer->ulCorePlayer, fGain);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set gain\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_eq(AAP_HANDLE ulPlayerHandle,
+        const AAPPlayerEqBand *pasBands, AAP_UINT32 uiBands)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_eq(psPlayer->ulCorePlayer, pasBands, uiBands);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set EQ\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_limiter(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable, AAP_FLOAT fCeilingDb)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_limiter(psPlayer->ulCorePlayer, bEnable, fCeilingDb);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set limiter\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_get_limiter_stats(AAP_HANDLE ulPlayerHandle,
+        AAPPlayerLimiterStats *psStats)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_get_limiter_stats(psPlayer->ulCorePlayer, psStats);
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_get_output_path(AAP_HANDLE ulPlayerHandle,
+        AAPPlayerOutputPath *psPath)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_get_output_path(psPlayer->ulCorePlayer, psPath);
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_reconfigure(AAP_HANDLE ulPlayerHandle,
+        const AAPAudioConfig *psAudioConfig)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_reconfigure(psPlayer->ulCorePlayer, psAudioConfig);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to reconfigure\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_latency(AAP_HANDLE ulPlayerHandle,
+        AAP_UINT32 uiLatencyMs)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_latency(psPlayer->ulCorePlayer, uiLatencyMs);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set latency\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_deep_buffer(AAP_HANDLE ulPlayerHandle,
+        AAP_BOOL bEnable)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_deep_buffer(psPlayer->ulCorePlayer, bEnable);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set deep buffering\n");
+        }
+    }
+    return iRet;
+}
+
+AAP_RetType aap_plat_aplayer_set_watchdog(AAP_HANDLE ulPlayerHandle,
+        AAP_UINT32 uiTimeoutMs)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_set_watchdog(psPlayer->ulCorePlayer, uiTimeoutMs);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set watchdog\n");
+        }
+    }
+    return iRet;
+}
+
+/* Applies the thread configuration matching the stream of this player */
+AAP_RetType aap_plat_aplayer_set_thread_config(AAP_HANDLE ulPlayerHandle,
+        const AAP_ConfigParams *psConfigParams)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    AAP_UINT32 uiIndex;
+    if (!ulPlayerHandle || (NULL == psConfigParams))
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        switch (psPlayer->eStreamType)
+        {
+            case AAP_AUDIO_STREAM_MEDIA:
+                uiIndex = AAP_THREAD_INDEX_AUDIO_MEDIA;
+                break;
+            case AAP_AUDIO_STREAM_MICROPHONE:
+                uiIndex = AAP_THREAD_INDEX_AUDIO_RECORDER;
+                break;
+            default:
+                /* Guidance, system and voice share the guidance setup */
+                uiIndex = AAP_THREAD_INDEX_AUDIO_GUIDANCE;
+                break;
+        }
+        iRet = audio_player_set_thread_config(psPlayer->ulCorePlayer,
+                &psConfigParams->asThreadConfig[uiIndex]);
+        if (0 != iRet)
+        {
+            printf("ERR::AP::Failed to set thread config\n");
+        }
+    }
+    return iRet;
+}
+
 AAP_RetType aap_plat_aplayer_pause(AAP_HANDLE ulPlayerHandle)
 {
     AAP_RetType iRet = 0;
@@ -251,6 +576,27 @@ AAP_RetType aap_plat_aplayer_stop(AAP_HANDLE ulPlayerHandle)
     return iRet;
 }
 
+AAP_RetType aap_plat_aplayer_drain(AAP_HANDLE ulPlayerHandle)
+{
+    AAP_RetType iRet = 0;
+    AAP_AudioPlayer *psPlayer = NULL;
+    if (!ulPlayerHandle)
+    {
+        printf("ERR::AP::Passed a NULL handle\n");
+        iRet = 1;
+    }
+    else
+    {
+        psPlayer = reinterpret_cast<AAP_AudioPlayer*>(ulPlayerHandle);
+        iRet = audio_player_drain(psPlayer->ulCorePlayer);
+        if ((0 != iRet) && (AAP_ERR_RETRY != iRet))
+        {
+            printf("ERR::AP::Failed to drain\n");
+        }
+    }
+    return iRet;
+}
+
 AAP_RetType aap_plat_aplayer_deinit(AAP_HANDLE *pulPlayerHandle)
 {
     AAP_RetType iRet = 0;
@@ -280,3 +626,196 @@ AAP_RetType aap_plat_aplayer_deinit(AAP_HANDLE *pulPlayerHandle)
     return iRet;
 }
 
+/* Input format of a player for the codec negotiated for its channel */
+static AAP_RetType aap_plat_aplayer_codec_config(AAP_AudioCodecType eCodec,
+        AAP_UINT32 uiBps, AAPAudioConfig *psAudioConfig)
+{
+    switch (eCodec)
+    {
+        case AAP_AUDIO_CODEC_AAC_LC_16KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_16KHZ_2:
+        case AAP_AUDIO_CODEC_AAC_LC_44KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_44KHZ_2:
+        case AAP_AUDIO_CODEC_AAC_LC_48KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_48KHZ_2:
+            psAudioConfig->eAudioType = AUDIO_STREAM_AAC_LC;
+            break;
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_16KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_16KHZ_2:
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_44KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_44KHZ_2:
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_48KHZ_1:
+        case AAP_AUDIO_CODEC_AAC_LC_ADTS_48KHZ_2:
+            psAudioConfig->eAudioType = AUDIO_STREAM_AAC_LC_ADTS;
+            break;
+        case AAP_AUDIO_CODEC_PCM_16KHZ_1:
+        case AAP_AUDIO_CODEC_PCM_16KHZ_2:
+        case AAP_AUDIO_CODEC_PCM_44KHZ_1:
+        case AAP_AUDIO_CODEC_PCM_44KHZ_2:
+        case AAP_AUDIO_CODEC_PCM_48KHZ_1:
+        case AAP_AUDIO_CODEC_PCM_48KHZ_2:
+            psAudioConfig->eAudioType = AUDIO_STREAM_PCM;
+            break;
+        default:
+            printf("ERR::AP::Unknown audio codec %d\n", eCodec);
+            return AAP_ERR_INVALID_PARAMS;
+    }
+
+    /* Each family lists 16, 44.1 and 48 kHz, mono before stereo */
+    switch ((eCodec - AAP_AUDIO_CODEC_AAC_LC_16KHZ_1) % 6)
+    {
+        case 0:
+        case 1:
+            psAudioConfig->eAudioFreq = AUDIO_SAMPLING_FREQ_16K;
+            break;
+        case 2:
+        case 3:
+            psAudioConfig->eAudioFreq = AUDIO_SAMPLING_FREQ_44K;
+            break;
+        default:
+            psAudioConfig->eAudioFreq = AUDIO_SAMPLING_FREQ_48K;
+            break;
+    }
+    psAudioConfig->uiChannels = ((eCodec - AAP_AUDIO_CODEC_AAC_LC_16KHZ_1) % 2) ? 2 : 1;
+    psAudioConfig->uiAudioBps = uiBps;
+    return 0;
+}
+
+static void *aap_plat_aplayer_init_job(void *pvArg)
+{
+    AAP_PlayerJob *psJob = static_cast<AAP_PlayerJob *>(pvArg);
+
+    psJob->iRet = aap_plat_aplayer_init(&psJob->ulPlayer, &psJob->sConfig,
+            psJob->pfEventFunc, psJob->pvCbParam);
+    if (0 != psJob->iRet)
+    {
+        psJob->ulPlayer = 0;
+    }
+    return NULL;
+}
+
+static void *aap_plat_aplayer_deinit_job(void *pvArg)
+{
+    AAP_PlayerJob *psJob = static_cast<AAP_PlayerJob *>(pvArg);
+
+    psJob->iRet = 0;
+    if (psJob->ulPlayer)
+    {
+        psJob->iRet = aap_plat_aplayer_deinit(&psJob->ulPlayer);
+    }
+    return NULL;
+}
+
+/* Runs pfJob for each of uiJobs jobs on threads of their own and waits for
+ * all of them. A job whose thread cannot be created runs on the caller. */
+static void aap_plat_aplayer_run_jobs(AAP_PlayerJob *pasJobs, AAP_UINT32 uiJobs,
+        void *(*pfJob)(void *))
+{
+    for (AAP_UINT32 i = 0; i < uiJobs; ++i)
+    {
+        pasJobs[i].bThread = (0 == pthread_create(&pasJobs[i].sThread, NULL, pfJob,
+                    &pasJobs[i])) ? AAP_TRUE : AAP_FALSE;
+    }
+    for (AAP_UINT32 i = 0; i < uiJobs; ++i)
+    {
+        if (pasJobs[i].bThread)
+        {
+            pthread_join(pasJobs[i].sThread, NULL);
+        }
+        else
+        {
+            pfJob(&pasJobs[i]);
+        }
+    }
+}
+
+/* Brings up the media and guidance players concurrently */
+AAP_RetType aap_plat_aplayer_init_session(AAPPlayerSet *psPlayers,
+        const AAP_ExtAttributes *psAttributes, AAPPlayerCbFunc pfAppCb,
+        void *pvMediaParam, void *pvGuidanceParam)
+{
+    AAP_RetType iRet = 0;
+    AAP_UINT32 uiState = API_TASK;
+    AAP_PlayerJob asJobs[2];
+    AAP_PlayerJob *const psMedia = &asJobs[0];
+    AAP_PlayerJob *const psGuidance = &asJobs[1];
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if ((NULL == psPlayers) || (NULL == psAttributes))
+                {
+                    printf("ERR::AP::Session players or attributes are NULL\n");
+                    iRet = AAP_FAILURE;
+                    break;
+                }
+                memset(psPlayers, 0, sizeof(AAPPlayerSet));
+                memset(asJobs, 0, sizeof(asJobs));
+
+                psMedia->sConfig.eStreamType = AAP_AUDIO_STREAM_MEDIA;
+                snprintf(psMedia->sConfig.acAudioDeviceID,
+                        sizeof(psMedia->sConfig.acAudioDeviceID), "%s",
+                        psAttributes->acMediaDeviceID);
+                psMedia->pfEventFunc = pfAppCb;
+                psMedia->pvCbParam = pvMediaParam;
+                iRet = aap_plat_aplayer_codec_config(psAttributes->eMediaCodec,
+                        psAttributes->uiMediaBps, &psMedia->sConfig);
+                if (0 != iRet)
+                {
+                    break;
+                }
+                psGuidance->sConfig.eStreamType = AAP_AUDIO_STREAM_GUIDANCE;
+                snprintf(psGuidance->sConfig.acAudioDeviceID,
+                        sizeof(psGuidance->sConfig.acAudioDeviceID), "%s",
+                        psAttributes->acGuidanceDeviceID);
+                psGuidance->pfEventFunc = pfAppCb;
+                psGuidance->pvCbParam = pvGuidanceParam;
+                iRet = aap_plat_aplayer_codec_config(psAttributes->eGuidanceAudioCodec,
+                        psAttributes->uiGuidanceBps, &psGuidance->sConfig);
+                if (0 != iRet)
+                {
+                    break;
+                }
+
+                aap_plat_aplayer_run_jobs(asJobs, 2, aap_plat_aplayer_init_job);
+                if ((0 != psMedia->iRet) || (0 != psGuidance->iRet))
+                {
+                    printf("ERR::AP::Session players init failed, media %d, "
+                            "guidance %d\n", psMedia->iRet, psGuidance->iRet);
+                    iRet = (0 != psMedia->iRet) ? psMedia->iRet : psGuidance->iRet;
+                    aap_plat_aplayer_run_jobs(asJobs, 2, aap_plat_aplayer_deinit_job);
+                    break;
+                }
+                psPlayers->ulMediaPlayer = psMedia->ulPlayer;
+                psPlayers->ulGuidancePlayer = psGuidance->ulPlayer;
+                printf("AP::Session players init success!\n");
+            }
+    }
+    return iRet;
+}
+
+/* Releases the players of a session concurrently */
+AAP_RetType aap_plat_aplayer_deinit_session(AAPPlayerSet *psPlayers)
+{
+    AAP_RetType iRet = 0;
+    AAP_PlayerJob asJobs[2];
+
+    if (NULL == psPlayers)
+    {
+        printf("ERR::AP::Passed a NULL handle \n");
+        return -1;
+    }
+    memset(asJobs, 0, sizeof(asJobs));
+    asJobs[0].ulPlayer = psPlayers->ulMediaPlayer;
+    asJobs[1].ulPlayer = psPlayers->ulGuidancePlayer;
+    aap_plat_aplayer_run_jobs(asJobs, 2, aap_plat_aplayer_deinit_job);
+    if ((0 != asJobs[0].iRet) || (0 != asJobs[1].iRet))
+    {
+        printf("ERR::AP::Failed uninit session players\n");
+        iRet = (0 != asJobs[0].iRet) ? asJobs[0].iRet : asJobs[1].iRet;
+    }
+    psPlayers->ulMediaPlayer = 0;
+    psPlayers->ulGuidancePlayer = 0;
+    return iRet;
+}
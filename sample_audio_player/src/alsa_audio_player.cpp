@@ -26,6 +26,7 @@
 #include <sys/time.h>
 
 #include "alsa_audio_player.h"
+#include "alsa_render.h"
 #include "aap_error_codes.h"
 
 #define API_TASK 1
@@ -33,7 +34,186 @@
  * In case of SabreAuto, it will be overridden by /etc/asound.conf */
 #define DEFAULT_LATENCY_MEDIA_MS 85
 #define DEFAULT_LATENCY_GUIDANCE_MS 100
+/* Longest time a push may wait for the render thread to free ring space */
+#define ALSA_PUSH_TIMEOUT_MS 1000
 
+#if ALSA_TSCHED
+/* Timer mode: a large buffer with period interrupts off where the device
+ * allows it. The PCM starts once the latency is queued. */
+static int audio_player_set_tsched_params(AlsaConfig *psAlsaConfig, int iLatencyMs)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    unsigned int uiBufferUs = ALSA_TSCHED_BUFFER_MS * 1000;
+    unsigned int uiPeriods = 4;
+    snd_pcm_hw_params_t *psHwParams;
+    snd_pcm_sw_params_t *psSwParams;
+    int iRet;
+
+    snd_pcm_hw_params_alloca(&psHwParams);
+    snd_pcm_sw_params_alloca(&psSwParams);
+    iRet = snd_pcm_hw_params_any(pcmHandle, psHwParams);
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_rate_resample(pcmHandle, psHwParams,
+                !psAlsaConfig->bNative);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_access(pcmHandle, psHwParams,
+                SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_format(pcmHandle, psHwParams, psAlsaConfig->format);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_channels(pcmHandle, psHwParams,
+                psAlsaConfig->psAudioConfig->uiChannels);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_rate(pcmHandle, psHwParams, uiRate, 0);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_buffer_time_near(pcmHandle, psHwParams,
+                &uiBufferUs, NULL);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_periods_near(pcmHandle, psHwParams,
+                &uiPeriods, NULL);
+    }
+    if ((0 == iRet) &&
+            (0 != snd_pcm_hw_params_set_period_wakeup(pcmHandle, psHwParams, 0)))
+    {
+        printf("AP::Period interrupts cannot be turned off\n");
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params(pcmHandle, psHwParams);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params_current(pcmHandle, psSwParams);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params_set_start_threshold(pcmHandle, psSwParams,
+                (static_cast<snd_pcm_uframes_t>(uiRate) * iLatencyMs) / 1000);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params(pcmHandle, psSwParams);
+    }
+    return iRet;
+}
+#endif
+
+/* Opens the PCM and settles the format it runs in, into sAudioConfig and
+ * format. Natively, when the device has a configuration near the stream,
+ * else in the stream format with ALSA converting. */
+static int audio_player_open(AlsaConfig *psAlsaConfig, const char *pcDevice)
+{
+    snd_pcm_stream_t const direction = SND_PCM_STREAM_PLAYBACK;
+    int iRet;
+
+#if ALSA_NATIVE_FORMAT
+    AAPAudioConfig *const psDevConfig = &psAlsaConfig->sAudioConfig;
+    AlsaCaps sCaps;
+    AlsaSampleFormat eFormat = ALSA_SAMPLE_S16;
+    unsigned int uiRate = 0;
+    unsigned int uiChannels = 0;
+
+    iRet = snd_pcm_open(&psAlsaConfig->pcmHandleOut, pcDevice, direction,
+            SND_PCM_NO_AUTO_RESAMPLE | SND_PCM_NO_AUTO_CHANNELS | SND_PCM_NO_AUTO_FORMAT);
+    if (0 == iRet)
+    {
+        alsa_caps_key(psAlsaConfig->pcmHandleOut, pcDevice, psAlsaConfig->acCapsKey);
+        iRet = alsa_caps_get(psAlsaConfig->pcmHandleOut, psAlsaConfig->acCapsKey, &sCaps);
+        if (0 == iRet)
+        {
+            iRet = alsa_caps_choose(&sCaps, psDevConfig->eAudioFreq,
+                    psDevConfig->uiChannels, &eFormat, &uiRate, &uiChannels);
+        }
+        if (0 == iRet)
+        {
+            psDevConfig->eAudioFreq = static_cast<AudioFreq>(uiRate);
+            psDevConfig->uiChannels = uiChannels;
+            psAlsaConfig->format = alsa_caps_pcm_format(eFormat);
+            psAlsaConfig->pfExport = alsa_kernels_export(eFormat);
+            psAlsaConfig->bNative = AAP_TRUE;
+            return 0;
+        }
+        printf("AP::No native configuration for %s, ALSA converts\n", pcDevice);
+        snd_pcm_close(psAlsaConfig->pcmHandleOut);
+        psAlsaConfig->pcmHandleOut = NULL;
+    }
+#endif
+    psAlsaConfig->format = SND_PCM_FORMAT_S16_LE;
+    psAlsaConfig->pfExport = NULL;
+    psAlsaConfig->bNative = AAP_FALSE;
+    iRet = snd_pcm_open(&psAlsaConfig->pcmHandleOut, pcDevice, direction, 0);
+    if (0 != iRet)
+    {
+        psAlsaConfig->pcmHandleOut = NULL;
+        return iRet;
+    }
+    alsa_caps_key(psAlsaConfig->pcmHandleOut, pcDevice, psAlsaConfig->acCapsKey);
+    return 0;
+}
+
+/* Sets the hardware and software parameters for a latency of iLatencyMs.
+ * Sizes negotiated on an earlier run are set as they are, *pbCached tells
+ * whether they were. */
+static int audio_player_set_params(AlsaConfig *psAlsaConfig, int iLatencyMs,
+        AAP_BOOL *pbCached)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    AlsaHwSetup sSetup;
+    int iRet;
+
+    memset(&sSetup, 0x0, sizeof(sSetup));
+    sSetup.format = psAlsaConfig->format;
+    sSetup.uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    sSetup.uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    sSetup.iResample = !psAlsaConfig->bNative;
+#if ALSA_TSCHED
+    sSetup.uiBufferUs = ALSA_TSCHED_BUFFER_MS * 1000;
+    sSetup.iPeriodWakeup = 0;
+    sSetup.startFrames = (static_cast<snd_pcm_uframes_t>(sSetup.uiRate) * iLatencyMs) / 1000;
+#else
+    sSetup.uiBufferUs = iLatencyMs * 1000;
+    sSetup.iPeriodWakeup = 1;
+#endif
+    *pbCached = AAP_FALSE;
+    if (0 == alsa_caps_set_hw(pcmHandle, psAlsaConfig->acCapsKey, &sSetup))
+    {
+        *pbCached = AAP_TRUE;
+        printf("AP::Parameters of %s from the cache\n", psAlsaConfig->acCapsKey);
+        return 0;
+    }
+
+#if ALSA_TSCHED
+    iRet = audio_player_set_tsched_params(psAlsaConfig, iLatencyMs);
+#else
+    iRet = snd_pcm_set_params (pcmHandle,
+            psAlsaConfig->format, SND_PCM_ACCESS_RW_INTERLEAVED,
+            sSetup.uiChannels, sSetup.uiRate,
+            sSetup.iResample, sSetup.uiBufferUs);
+#endif
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_get_params(pcmHandle, &sSetup.bufferSize, &sSetup.periodSize);
+    }
+    if (0 == iRet)
+    {
+        alsa_caps_put_hw(psAlsaConfig->acCapsKey, &sSetup);
+    }
+    return iRet;
+}
 
 int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
         AAPAlsaCoreCbFunc pfAppCb,
@@ -51,7 +231,7 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
         case API_TASK:
             {
                 snd_pcm_uframes_t bufferSize, periodSize;
-                snd_pcm_stream_t direction =  SND_PCM_STREAM_PLAYBACK;
+                AAP_BOOL bCached = AAP_FALSE;
                 AAP_CHAR acAdDevice[AAP_SMALL_ARRAY_LEN + 1] = {'\0'};
 
                 if (NULL == psAudioConfig)
@@ -69,7 +249,9 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
                 }
                 memset(psAlsaConfig, 0x0, sizeof(AlsaConfig));
                 psAlsaConfig->pcmHandleOut = NULL;
-                psAlsaConfig->psAudioConfig = psAudioConfig;
+                /* Rate and channels become those of the PCM once opened */
+                psAlsaConfig->sAudioConfig = *psAudioConfig;
+                psAlsaConfig->psAudioConfig = &psAlsaConfig->sAudioConfig;
                 psAlsaConfig->pfEventFunc = pfAppCb;
                 psAlsaConfig->pvUserParam = pvUserParam;
 
@@ -83,7 +265,7 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
                             AAP_SMALL_ARRAY_LEN);
                 }
 
-                iRet = snd_pcm_open (&psAlsaConfig->pcmHandleOut, acAdDevice, direction, 0);
+                iRet = audio_player_open(psAlsaConfig, acAdDevice);
 
                 if (0 != iRet)
                 {
@@ -99,11 +281,7 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
                     iLatency = DEFAULT_LATENCY_GUIDANCE_MS;
                 }
 
-                iRet = snd_pcm_set_params (psAlsaConfig->pcmHandleOut,
-                        SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
-                        psAlsaConfig->psAudioConfig->uiChannels,
-                        psAlsaConfig->psAudioConfig->eAudioFreq,
-                        TRUE, iLatency * 1000);
+                iRet = audio_player_set_params(psAlsaConfig, iLatency, &bCached);
 
                 if (0 != iRet)
                 {
@@ -111,13 +289,14 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
                     break;
                 }
 
-                if (snd_pcm_nonblock(psAlsaConfig->pcmHandleOut, 0))
+                /* The render thread waits with snd_pcm_wait() itself */
+                if (snd_pcm_nonblock(psAlsaConfig->pcmHandleOut, 1))
                 {
-                    printf("ERR::AP::Failed to make it block\n");
+                    printf("ERR::AP::Failed to make it non-block\n");
                 }
                 else
                 {
-                    printf("AP::Successfully set it to block\n");
+                    printf("AP::Successfully set it to non-block\n");
                 }
                 iRet = snd_pcm_get_params (psAlsaConfig->pcmHandleOut, &bufferSize, &periodSize);
                 if (0 != iRet)
@@ -138,15 +317,153 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
                 {
                     bufferSize = 4096;
                 }
-                psAlsaConfig->format = SND_PCM_FORMAT_S16_LE;
+                psAlsaConfig->bufferSize = bufferSize;
+                psAlsaConfig->periodSize = periodSize;
+                psAlsaConfig->fillSize = bufferSize;
+#if ALSA_TSCHED
+                /* Only the latency is kept queued of the large buffer, and
+                 * rendered in chunks as no period is waited for */
+                psAlsaConfig->fillSize = (static_cast<snd_pcm_uframes_t>(
+                            psAlsaConfig->psAudioConfig->eAudioFreq) * iLatency) / 1000;
+                if (psAlsaConfig->fillSize > bufferSize)
+                {
+                    psAlsaConfig->fillSize = bufferSize;
+                }
+                psAlsaConfig->periodSize = (psAlsaConfig->psAudioConfig->eAudioFreq *
+                        ALSA_TSCHED_CHUNK_MS) / 1000;
+                psAlsaConfig->guardSize = psAlsaConfig->fillSize / 4;
+                printf("AP::Timer mode, fill %lu, chunk %lu\n",
+                        psAlsaConfig->fillSize, psAlsaConfig->periodSize);
+#endif
+                psAlsaConfig->uiLatencyMs = iLatency;
+                psAlsaConfig->uiWatchdogMs = ALSA_WATCHDOG_MS;
+
+                /* Input is converted to S16 on the way in, with processing
+                 * specialized for its layout from here on. */
+                iRet = alsa_kernels_select(&psAlsaConfig->sKernels,
+                        (AUDIO_BPS_32 == psAudioConfig->uiAudioBps) ?
+                        ALSA_SAMPLE_S32 : ALSA_SAMPLE_S16,
+                        psAudioConfig->uiChannels);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Kernel selection failed\n");
+                    break;
+                }
+                psAlsaConfig->pfRamp = psAlsaConfig->sKernels.pfRamp;
+                printf("AP::Render kernels: %s\n", psAlsaConfig->sKernels.pcName);
+                printf("AP::Output %s, %u ch at %u Hz in %s\n",
+                        psAlsaConfig->bNative ? "native" : "converted by ALSA",
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        static_cast<unsigned int>(psAlsaConfig->psAudioConfig->eAudioFreq),
+                        snd_pcm_format_name(psAlsaConfig->format));
+
+                /* The ring takes the application's bursts, twice the ALSA
+                 * buffer leaves room either way of the drift target. Sized
+                 * for the largest latency, it is never reallocated. */
+                if (bufferSize < (static_cast<snd_pcm_uframes_t>(
+                                psAlsaConfig->psAudioConfig->eAudioFreq) * ALSA_LATENCY_MAX_MS) / 1000)
+                {
+                    bufferSize = (static_cast<snd_pcm_uframes_t>(
+                                psAlsaConfig->psAudioConfig->eAudioFreq) * ALSA_LATENCY_MAX_MS) / 1000;
+                }
+                iRet = alsa_ring_init(&psAlsaConfig->sRing, 2 * bufferSize,
+                        2 * psAlsaConfig->psAudioConfig->uiChannels);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Ring init failed\n");
+                    break;
+                }
+                /* Keep one ALSA buffer worth of data queued in total between
+                 * the ring and the PCM, the latency the player had when it
+                 * wrote to ALSA directly. In timer mode, the latency. */
+                iRet = alsa_drift_init(&psAlsaConfig->sDrift,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->psAudioConfig->eAudioFreq,
+                        psAlsaConfig->fillSize);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Drift compensation init failed\n");
+                    break;
+                }
+                /* From the stream format to the one of the PCM */
+                iRet = alsa_convert_init(&psAlsaConfig->sConvert,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->psAudioConfig->eAudioFreq);
+                if (0 == iRet)
+                {
+                    iRet = alsa_convert_set_input(&psAlsaConfig->sConvert,
+                            psAudioConfig->uiChannels, psAudioConfig->eAudioFreq);
+                }
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Conversion init failed\n");
+                    break;
+                }
+                iRet = alsa_plc_init(&psAlsaConfig->sPlc,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->psAudioConfig->eAudioFreq);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Concealment init failed\n");
+                    break;
+                }
+                /* Sized for the longest period drift compensation returns */
+                iRet = alsa_bus_init(&psAlsaConfig->sBus,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->periodSize +
+                        (psAlsaConfig->periodSize * ALSA_DRIFT_MAX_PPM) / 1000000 + 2);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Bus init failed\n");
+                    break;
+                }
+                iRet = alsa_eq_init(&psAlsaConfig->sEq,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->psAudioConfig->eAudioFreq);
+                if (0 == iRet)
+                {
+                    iRet = alsa_bus_add_stage(&psAlsaConfig->sBus, alsa_eq_process,
+                            alsa_eq_active, &psAlsaConfig->sEq);
+                }
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::EQ init failed\n");
+                    break;
+                }
+                iRet = alsa_limiter_init(&psAlsaConfig->sLimiter,
+                        psAlsaConfig->psAudioConfig->uiChannels,
+                        psAlsaConfig->psAudioConfig->eAudioFreq);
+                if (0 == iRet)
+                {
+                    iRet = alsa_bus_add_stage(&psAlsaConfig->sBus, alsa_limiter_process,
+                            alsa_limiter_active, &psAlsaConfig->sLimiter);
+                }
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Limiter init failed\n");
+                    break;
+                }
+
+                /* Prints the software configurations on initialization,
+                 * known already when they came from the cache */
+                if (!bCached)
+                {
+                    snd_output_stdio_attach(&out, stdout, 0);
+                    snd_pcm_dump_sw_setup(psAlsaConfig->pcmHandleOut, out);
+                    snd_output_close(out);
+                }
+
+                /* From here on the PCM belongs to the render thread */
+                iRet = alsa_render_start(psAlsaConfig);
+                if (0 != iRet)
+                {
+                    printf("ERR::AP::Render thread start failed\n");
+                    break;
+                }
                 psAlsaConfig->isConfigured  = TRUE;
 
                 *pulAlsaPlayer = reinterpret_cast<AAP_PLAYER_HANDLE>(psAlsaConfig);
                 printf("AP::Player initialized successfully\n");
-
-                /* Prints the software configurations on initialization */
-                snd_output_stdio_attach(&out, stdout, 0);
-                snd_pcm_dump_sw_setup(psAlsaConfig->pcmHandleOut, out);
             }
     }
     if (0 != iRet)
@@ -154,6 +471,16 @@ int audio_player_init(AAP_PLAYER_HANDLE* pulAlsaPlayer,
         printf("ERR::AP::Player Init failed!\n");
         if (psAlsaConfig)
         {
+            if (psAlsaConfig->pcmHandleOut)
+            {
+                snd_pcm_close(psAlsaConfig->pcmHandleOut);
+            }
+            alsa_drift_deinit(&psAlsaConfig->sDrift);
+            alsa_convert_deinit(&psAlsaConfig->sConvert);
+            alsa_plc_deinit(&psAlsaConfig->sPlc);
+            alsa_bus_deinit(&psAlsaConfig->sBus);
+            alsa_limiter_deinit(&psAlsaConfig->sLimiter);
+            alsa_ring_deinit(&psAlsaConfig->sRing);
             free(psAlsaConfig);
         }
     }
@@ -180,8 +507,12 @@ int audio_player_play(AAP_PLAYER_HANDLE ulAlsaPlayer)
                 /* When first call to push buffer happens it will prepare the pcm
                  * which takes some time resulting in underrun, instead doing it
                  * on the call to play itself.
-                 * Initial underrun was not observed after this. */
-                snd_pcm_prepare(psAlsaConfig->pcmHandleOut);
+                 * Initial underrun was not observed after this.
+                 * The PCM is owned by the render thread, which also restarts
+                 * the drift controller along with it. */
+                alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_RESTART);
+                /* Timestamps after play start a new segment */
+                alsa_plc_reset(&psAlsaConfig->sPlc);
             }
     }
     return iRet;
@@ -203,54 +534,241 @@ int audio_player_pause(AAP_PLAYER_HANDLE ulAlsaPlayer)
                     iRet = AAP_ERR_INVALID_PARAMS;
                     break;
                 }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                /* Faded out by the render thread, what is still queued in
+                 * the ring plays after the next play */
+                alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_PAUSE);
             }
     }
     return iRet;
 }
 
-static int audio_stream_recover(snd_pcm_t *pcmHandle, int iInError)
+/* Queues frames into the ring. Blocking, it waits for the render thread to
+ * make space; otherwise it stops at a full ring. *puiPut returns the frames
+ * queued. */
+static int audio_player_ring_put(AlsaConfig *psAlsaConfig,
+        const unsigned char *pucData, unsigned int uiFrames, AAP_BOOL bBlock,
+        unsigned int *puiPut)
+{
+    size_t const bytesPerUnit = 2 * psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int uiWritten;
+
+    *puiPut = 0;
+    while (uiFrames > 0)
+    {
+        uiWritten = alsa_ring_write(&psAlsaConfig->sRing, pucData, uiFrames);
+        if (uiWritten > 0)
+        {
+            sem_post(&psAlsaConfig->semData);
+            pucData += uiWritten * bytesPerUnit;
+            uiFrames -= uiWritten;
+            *puiPut += uiWritten;
+            continue;
+        }
+        if (!bBlock)
+        {
+            break;
+        }
+        if (psAlsaConfig->bSuspended)
+        {
+            /* The PCM may take a while to come back, do not hold
+             * up the caller meanwhile. */
+            __sync_fetch_and_add(&psAlsaConfig->ulSuspendDropped, uiFrames);
+            break;
+        }
+        if (psAlsaConfig->bStalled)
+        {
+            /* The device is not playing, nothing drains the ring until the
+             * watchdog restarts it */
+            return AAP_ERR_TIMEOUT;
+        }
+        if (psAlsaConfig->bFailed)
+        {
+            /* Nothing drains the ring of a failed PCM */
+            return AAP_ERR_SYS_CALL_FAILED;
+        }
+        if (psAlsaConfig->bHalted)
+        {
+            /* Paused or stopped, the ring drains only after play. The rest
+             * is not queued. */
+            return AAP_ERR_RETRY;
+        }
+        /* Ring is full, wait for the render thread to drain it */
+        if (0 != alsa_render_sem_wait(&psAlsaConfig->semSpace,
+                    ALSA_PUSH_TIMEOUT_MS))
+        {
+            printf("ERR::AP::Render thread not draining, dropped %u frames\n",
+                    uiFrames);
+            return AAP_ERR_TIMEOUT;
+        }
+    }
+    return 0;
+}
+
+/* Keeps what a non-blocking push could not queue, to go in first next time */
+static int audio_player_carry(AlsaConfig *psAlsaConfig,
+        const unsigned char *pucData, unsigned int uiFrames)
+{
+    size_t const bytesPerUnit = 2 * psAlsaConfig->psAudioConfig->uiChannels;
+
+    if (uiFrames > psAlsaConfig->uiCarryCap)
+    {
+        unsigned char *pucNew = static_cast<unsigned char *>(
+                realloc(psAlsaConfig->pucCarry, uiFrames * bytesPerUnit));
+        if (NULL == pucNew)
+        {
+            printf("ERR::AP::Memory allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        psAlsaConfig->pucCarry = pucNew;
+        psAlsaConfig->uiCarryCap = uiFrames;
+    }
+    memcpy(psAlsaConfig->pucCarry, pucData, uiFrames * bytesPerUnit);
+    psAlsaConfig->uiCarryFrames = uiFrames;
+    return 0;
+}
+
+static int audio_player_push(AlsaConfig *psAlsaConfig,
+        unsigned char* pucData,
+        unsigned int uiSize,
+        uint64_t ulTimeStamp,
+        AAP_BOOL bBlock,
+        unsigned int *puiAccepted)
 {
-    int iErrRet;
+    size_t const bytesPerUnit = 2 * psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiInBytes = psAlsaConfig->sKernels.uiInFrameBytes;
+    unsigned int uiFrames = uiSize / uiInBytes;
+    unsigned int uiTaken = uiFrames;
+    unsigned int uiConverted;
+    unsigned int uiPut;
+    unsigned long ulSilence;
+    const short *psFrames = NULL;
+    int iRet;
+    int iErr;
+    int n;
+
+    *puiAccepted = 0;
 
-    if (-EINTR == iInError)
+    if (psAlsaConfig->bPull)
     {
-        iErrRet = 0;
+        printf("ERR::AP::Player is in pull mode\n");
+        return AAP_ERR_PRECOND_NOT_MET;
     }
-    else if (-EPIPE == iInError)
-    { /* Underrun */
-        iErrRet = snd_pcm_prepare (pcmHandle);
+    /* Left over from an earlier non-blocking push */
+    if (psAlsaConfig->uiCarryFrames > 0)
+    {
+        iRet = audio_player_ring_put(psAlsaConfig, psAlsaConfig->pucCarry,
+                psAlsaConfig->uiCarryFrames, bBlock, &uiPut);
+        psAlsaConfig->uiCarryFrames -= uiPut;
+        memmove(psAlsaConfig->pucCarry,
+                psAlsaConfig->pucCarry + uiPut * bytesPerUnit,
+                psAlsaConfig->uiCarryFrames * bytesPerUnit);
+        if (0 != iRet)
+        {
+            return iRet;
+        }
+        if ((psAlsaConfig->uiCarryFrames > 0) && bBlock)
+        {
+            /* Dropped for a suspend */
+            psAlsaConfig->uiCarryFrames = 0;
+        }
+        if (psAlsaConfig->uiCarryFrames > 0)
+        {
+            return AAP_ERR_RETRY;
+        }
     }
-    else if (-ESTRPIPE == iInError)
-    { /* Hardware suspended */
-        for (int i = 0; i < 100; ++i)
+    if (!bBlock)
+    {
+        /* Take only what fits, the caller keeps the rest */
+        uiPut = alsa_ring_space(&psAlsaConfig->sRing);
+        if (uiTaken > uiPut)
+        {
+            uiTaken = uiPut;
+        }
+        if (0 == uiTaken)
         {
-            iErrRet = snd_pcm_resume (pcmHandle);
-            if (-EAGAIN != iErrRet)
+            if (psAlsaConfig->bFailed)
             {
-                break;
+                return AAP_ERR_SYS_CALL_FAILED;
             }
-            usleep (10000);
+            return (psAlsaConfig->bStalled) ? AAP_ERR_TIMEOUT : AAP_ERR_RETRY;
         }
-        if (iErrRet)
+    }
+
+    /* Silence the render thread played meanwhile already covers
+     * any hole in the timestamps. */
+    ulSilence = psAlsaConfig->ulSilenceFrames;
+    psAlsaConfig->sPlc.ulCoveredFrames += ulSilence - psAlsaConfig->ulSilenceSeen;
+    psAlsaConfig->ulSilenceSeen = ulSilence;
+
+    if (psAlsaConfig->sKernels.pfImport)
+    {
+        if (uiTaken > psAlsaConfig->uiImportCap)
         {
-            iErrRet = snd_pcm_prepare (pcmHandle);
+            short *psNew = static_cast<short *>(realloc(psAlsaConfig->psImport,
+                        uiTaken * psAlsaConfig->sKernels.uiChannels * sizeof(short)));
+            if (NULL == psNew)
+            {
+                printf("ERR::AP::Memory allocation failed!\n");
+                return AAP_ERR_OUT_OF_MEM;
+            }
+            psAlsaConfig->psImport = psNew;
+            psAlsaConfig->uiImportCap = uiTaken;
         }
+        psAlsaConfig->sKernels.pfImport(pucData, psAlsaConfig->psImport, uiTaken,
+                psAlsaConfig->sKernels.uiChannels);
+        pucData = reinterpret_cast<unsigned char *>(psAlsaConfig->psImport);
     }
-    else
+
+    /* Onto the channels and rate of the PCM */
+    n = alsa_convert_process(&psAlsaConfig->sConvert,
+            reinterpret_cast<const short *>(pucData), uiTaken, &psFrames);
+    if (n < 0)
     {
-        iErrRet = iInError;
+        return AAP_ERR_OUT_OF_MEM;
     }
+    uiConverted = static_cast<unsigned int>(n);
 
-    return iErrRet;
-}
+    /* Fill holes in the timestamp sequence and drop late data */
+    n = alsa_plc_process(&psAlsaConfig->sPlc, psFrames, uiConverted,
+            ulTimeStamp, &psFrames);
+    *puiAccepted = uiTaken * uiInBytes;
+    iRet = (uiTaken < uiFrames) ? AAP_ERR_RETRY : 0;
+    if (n <= 0)
+    {
+        return iRet;
+    }
+    if (psAlsaConfig->bSplicePending)
+    {
+        /* The first frame of the new format goes in here. The render
+         * thread may be reading the previous one, it retries on a change
+         * of the sequence. */
+        ++psAlsaConfig->uiSpliceSeq;
+        __sync_synchronize();
+        psAlsaConfig->ulSpliceFrame = psAlsaConfig->sRing.ulWrite;
+        __sync_synchronize();
+        ++psAlsaConfig->uiSpliceSeq;
+        psAlsaConfig->bSplicePending = AAP_FALSE;
+    }
 
+    iErr = audio_player_ring_put(psAlsaConfig,
+            reinterpret_cast<const unsigned char *>(psFrames), n, bBlock,
+            &uiPut);
+    if ((0 == iErr) && !bBlock && (uiPut < static_cast<unsigned int>(n)))
+    {
+        /* Concealment made the data longer than the space left */
+        iErr = audio_player_carry(psAlsaConfig,
+                reinterpret_cast<const unsigned char *>(psFrames) + uiPut * bytesPerUnit,
+                static_cast<unsigned int>(n) - uiPut);
+    }
+    return (0 != iErr) ? iErr : iRet;
+}
 
 int audio_player_push_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer,
         unsigned char* pucData,
         unsigned int uiSize,
         uint64_t ulTimeStamp)
 {
-    (void)ulTimeStamp;
     int uiState = API_TASK;
     int iRet = 0;
 
@@ -258,9 +776,7 @@ int audio_player_push_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer,
     {
         case API_TASK:
             {
-                int iErr;
-                ssize_t n;
-                int uiFrames = 0;
+                unsigned int uiAccepted;
 
                 if (!ulAlsaPlayer)
                 {
@@ -269,36 +785,446 @@ int audio_player_push_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer,
                     break;
                 }
                 AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
-                size_t const bytesPerUnit = 2 * psAlsaConfig->psAudioConfig->uiChannels;
-                snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
-                uiFrames = uiSize / bytesPerUnit;
+                iRet = audio_player_push(psAlsaConfig, pucData, uiSize,
+                        ulTimeStamp, AAP_TRUE, &uiAccepted);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_push_buffer_nb(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        unsigned char* pucData,
+        unsigned int uiSize,
+        uint64_t ulTimeStamp,
+        unsigned int *puiAccepted)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
 
-                while (uiFrames > 0)
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || (NULL == puiAccepted))
                 {
-                    n = snd_pcm_writei(pcmHandle, (void*)pucData, uiFrames);
-                    if (n <= 0)
-                    {
-                        iErr = audio_stream_recover(psAlsaConfig->pcmHandleOut, n);
-                        if (iErr != 0)
-                        {
-                            printf("ERR::AP::Audio stream recover: failed %d\n", iErr);
-                            if (psAlsaConfig->pfEventFunc)
-                            {
-                                AAPPlayer_Events ePlayerEvent = E_AAP_PLAYER_FACED_ERROR;
-                                psAlsaConfig->pfEventFunc(ePlayerEvent,
-                                        0,
-                                        NULL,
-                                        psAlsaConfig->pvUserParam);
-                            }
-                            break;
-                        }
-                    }
-                    else
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                iRet = audio_player_push(psAlsaConfig, pucData, uiSize,
+                        ulTimeStamp, AAP_FALSE, puiAccepted);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_pull_mode(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                if (bEnable && (NULL == psAlsaConfig->pfEventFunc))
+                {
+                    printf("ERR::AP::Pull mode needs an event callback\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                /* Pulled data goes to the PCM as is, unconverted */
+                if (bEnable && alsa_convert_active(&psAlsaConfig->sConvert))
+                {
+                    printf("ERR::AP::Pull mode needs input in the device format\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                /* Picked up by the render thread on its next period */
+                psAlsaConfig->bPull = bEnable ? AAP_TRUE : AAP_FALSE;
+                sem_post(&psAlsaConfig->semData);
+                printf("AP::Pull mode %s\n", bEnable ? "on" : "off");
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_gain(AAP_PLAYER_HANDLE ulAlsaPlayer, float fGain)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || !(fGain >= 0.0f))
+                {
+                    printf("ERR::AP::Invalid gain parameters\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                AAP_BOOL bLower = (fGain < psAlsaConfig->sBus.fGainTarget) ?
+                    AAP_TRUE : AAP_FALSE;
+
+                /* Ramped in by the render thread over its next period. A
+                 * lower gain, e.g. ducking for a prompt, is also applied to
+                 * what is queued in the PCM so that it is heard at once. */
+                alsa_bus_set_gain(&psAlsaConfig->sBus, fGain);
+                if (bLower)
+                {
+                    alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_PREEMPT);
+                }
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_eq(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAPPlayerEqBand *pasBands, unsigned int uiBands)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                /* Taken over by the render thread on its next period */
+                iRet = alsa_eq_set(&psAlsaConfig->sEq, pasBands, uiBands);
+                if (0 == iRet)
+                {
+                    printf("AP::EQ set with %u bands\n", uiBands);
+                }
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_limiter(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable,
+        float fCeilingDb)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || (bEnable && !(fCeilingDb <= 0.0f)))
+                {
+                    printf("ERR::AP::Invalid limiter parameters\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                alsa_limiter_set(&psAlsaConfig->sLimiter, bEnable, fCeilingDb);
+                printf("AP::Limiter %s, ceiling %.1f dBFS\n", bEnable ? "on" : "off",
+                        fCeilingDb);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_get_limiter_stats(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        AAPPlayerLimiterStats *psStats)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || (NULL == psStats))
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                alsa_limiter_stats(&psAlsaConfig->sLimiter, psStats);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_get_output_path(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        AAPPlayerOutputPath *psPath)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || (NULL == psPath))
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                const AlsaConvert *psConvert = &psAlsaConfig->sConvert;
+                psPath->uiRate = psConvert->uiOutRate;
+                psPath->uiChannels = psConvert->uiOutChannels;
+                psPath->uiBits = (SND_PCM_FORMAT_S16_LE == psAlsaConfig->format) ? 16 : 32;
+                psPath->bNative = psAlsaConfig->bNative;
+                psPath->bResampling = (psConvert->uiInRate != psConvert->uiOutRate) ?
+                    AAP_TRUE : AAP_FALSE;
+                psPath->bChannelMapping =
+                    (psConvert->uiInChannels != psConvert->uiOutChannels) ?
+                    AAP_TRUE : AAP_FALSE;
+            }
+    }
+    return iRet;
+}
+
+int audio_player_reconfigure(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAPAudioConfig *psAudioConfig)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                AlsaKernels sKernels;
+
+                if ((!ulAlsaPlayer) || (NULL == psAudioConfig))
+                {
+                    printf("ERR::AP::Passed a NULL Handle or config\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                if (psAlsaConfig->bPull)
+                {
+                    printf("ERR::AP::Player is in pull mode\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                iRet = alsa_kernels_select(&sKernels,
+                        (AUDIO_BPS_32 == psAudioConfig->uiAudioBps) ?
+                        ALSA_SAMPLE_S32 : ALSA_SAMPLE_S16,
+                        psAudioConfig->uiChannels);
+                if (0 == iRet)
+                {
+                    iRet = alsa_convert_set_input(&psAlsaConfig->sConvert,
+                            psAudioConfig->uiChannels, psAudioConfig->eAudioFreq);
+                }
+                if (0 != iRet)
+                {
+                    break;
+                }
+                /* The render thread keeps its own gain ramp */
+                psAlsaConfig->sKernels = sKernels;
+                /* Timestamps of the new format start a new segment */
+                alsa_plc_reset(&psAlsaConfig->sPlc);
+                psAlsaConfig->bSplicePending = AAP_TRUE;
+                printf("AP::Input now %u Hz, %u ch, %s\n",
+                        static_cast<unsigned int>(psAudioConfig->eAudioFreq),
+                        psAudioConfig->uiChannels, sKernels.pcName);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_latency(AAP_PLAYER_HANDLE ulAlsaPlayer, unsigned int uiLatencyMs)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                if ((uiLatencyMs < ALSA_LATENCY_MIN_MS) || (uiLatencyMs > ALSA_LATENCY_MAX_MS))
+                {
+                    printf("ERR::AP::Latency %u ms out of range\n", uiLatencyMs);
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                psAlsaConfig->uiLatencyMs = uiLatencyMs;
+                alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_FILL);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_deep_buffer(AAP_PLAYER_HANDLE ulAlsaPlayer, AAP_BOOL bEnable)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                if (AAP_AUDIO_STREAM_MEDIA != psAlsaConfig->psAudioConfig->eStreamType)
+                {
+                    printf("ERR::AP::Deep buffering is for media only\n");
+                    iRet = AAP_ERR_INVALID_REQ;
+                    break;
+                }
+                if (!ALSA_TSCHED)
+                {
+                    /* The buffer cannot grow without opening the PCM again */
+                    printf("ERR::AP::Deep buffering needs the timer mode build\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                psAlsaConfig->bDeepBuffer = bEnable;
+                alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_FILL);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_watchdog(AAP_PLAYER_HANDLE ulAlsaPlayer, unsigned int uiTimeoutMs)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                if ((0 != uiTimeoutMs) && ((uiTimeoutMs < ALSA_WATCHDOG_MIN_MS) ||
+                            (uiTimeoutMs > ALSA_WATCHDOG_MAX_MS)))
+                {
+                    printf("ERR::AP::Watchdog timeout %u ms out of range\n", uiTimeoutMs);
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                /* Taken up by the render thread on its next check */
+                psAlsaConfig->uiWatchdogMs = uiTimeoutMs;
+            }
+    }
+    return iRet;
+}
+
+int audio_player_set_thread_config(AAP_PLAYER_HANDLE ulAlsaPlayer,
+        const AAP_ThreadConfig *psThreadConfig)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                if (!ulAlsaPlayer || (NULL == psThreadConfig))
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                iRet = alsa_render_set_thread_config(psAlsaConfig, psThreadConfig);
+            }
+    }
+    return iRet;
+}
+
+int audio_player_drain(AAP_PLAYER_HANDLE ulAlsaPlayer)
+{
+    int uiState = API_TASK;
+    int iRet = 0;
+
+    switch (uiState)
+    {
+        case API_TASK:
+            {
+                size_t bytesPerUnit;
+                unsigned int uiPut;
+
+                if (!ulAlsaPlayer)
+                {
+                    printf("ERR::AP::Passed a NULL Handle\n");
+                    iRet = AAP_ERR_INVALID_PARAMS;
+                    break;
+                }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                if (NULL == psAlsaConfig->pfEventFunc)
+                {
+                    printf("ERR::AP::Drain needs an event callback\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                if (psAlsaConfig->bPull)
+                {
+                    printf("ERR::AP::Player is in pull mode\n");
+                    iRet = AAP_ERR_PRECOND_NOT_MET;
+                    break;
+                }
+                if (psAlsaConfig->bDrain || psAlsaConfig->bEosPending)
+                {
+                    printf("ERR::AP::Drain still pending\n");
+                    iRet = AAP_ERR_IFACE_BUSY;
+                    break;
+                }
+                /* Frames held back by a non-blocking push end the stream */
+                if (psAlsaConfig->uiCarryFrames > 0)
+                {
+                    bytesPerUnit = 2 * psAlsaConfig->psAudioConfig->uiChannels;
+                    audio_player_ring_put(psAlsaConfig, psAlsaConfig->pucCarry,
+                            psAlsaConfig->uiCarryFrames, AAP_FALSE, &uiPut);
+                    psAlsaConfig->uiCarryFrames -= uiPut;
+                    memmove(psAlsaConfig->pucCarry,
+                            psAlsaConfig->pucCarry + uiPut * bytesPerUnit,
+                            psAlsaConfig->uiCarryFrames * bytesPerUnit);
+                    if (psAlsaConfig->uiCarryFrames > 0)
                     {
-                        pucData += (n * bytesPerUnit);
-                        uiFrames -= n;
+                        iRet = AAP_ERR_RETRY;
+                        break;
                     }
                 }
+                psAlsaConfig->ulDrainFrame = psAlsaConfig->sRing.ulWrite;
+                __sync_synchronize();
+                psAlsaConfig->bDrain = AAP_TRUE;
+                sem_post(&psAlsaConfig->semData);
+                /* Timestamps of the next stream start a new segment */
+                alsa_plc_reset(&psAlsaConfig->sPlc);
             }
     }
     return iRet;
@@ -319,6 +1245,11 @@ int audio_player_stop(AAP_PLAYER_HANDLE ulAlsaPlayer)
                     iRet = AAP_ERR_INVALID_PARAMS;
                     break;
                 }
+                AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                /* Faded out and flushed by the render thread. Frames held
+                 * back by a non-blocking push go too. */
+                psAlsaConfig->uiCarryFrames = 0;
+                alsa_render_request(psAlsaConfig, ALSA_RENDER_REQ_STOP);
             }
     }
     return iRet;
@@ -342,11 +1273,24 @@ int audio_player_deinit(AAP_PLAYER_HANDLE ulAlsaPlayer)
                     break;
                 }
                 AlsaConfig *psAlsaConfig = reinterpret_cast<AlsaConfig *>(ulAlsaPlayer);
+                alsa_render_stop(psAlsaConfig);
                 if (psAlsaConfig->pcmHandleOut)
                 {
                     snd_pcm_close(psAlsaConfig->pcmHandleOut);
                     psAlsaConfig->pcmHandleOut = NULL;
                 }
+                printf("AP::Concealed %u gaps (%lu frames), dropped %lu late frames\n",
+                        psAlsaConfig->sPlc.uiGapCount,
+                        psAlsaConfig->sPlc.ulConcealedFrames,
+                        psAlsaConfig->sPlc.ulDroppedFrames);
+                alsa_drift_deinit(&psAlsaConfig->sDrift);
+                alsa_convert_deinit(&psAlsaConfig->sConvert);
+                alsa_plc_deinit(&psAlsaConfig->sPlc);
+                alsa_bus_deinit(&psAlsaConfig->sBus);
+                alsa_limiter_deinit(&psAlsaConfig->sLimiter);
+                alsa_ring_deinit(&psAlsaConfig->sRing);
+                free(psAlsaConfig->pucCarry);
+                free(psAlsaConfig->psImport);
                 free(psAlsaConfig);
             }
     }
@@ -0,0 +1,321 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_bus.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Float processing bus of the ALSA core player.
+ *
+ *   A period is taken onto the bus as 32 bit float, processed there with
+ *   headroom above full scale, and requantized to S16 once on the way out:
+ *   triangular dither of +/-1 LSB is added and the requantization error of
+ *   each channel is fed back into the next frame, which shapes the noise
+ *   first order towards high frequencies. The dither is generated with the
+ *   SIMD kernels of alsa_dsp.cpp; the feedback loop itself runs per frame.
+ *
+ *   Processing stages such as the EQ register with alsa_bus_add_stage() and
+ *   run after the gain, in the order they were added. While neither the
+ *   gain nor any stage changes the signal the bus is bypassed, so that
+ *   plain S16 playback stays bit exact and costs nothing.
+ *
+ *   With ALSA_FIXED_POINT the bus carries Q31 words with 24 dB of headroom
+ *   (Q4.27), the gain is applied in Q16 and dither and noise shaping work
+ *   in integers, so no float arithmetic runs per sample.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "alsa_bus.h"
+#include "alsa_dsp.h"
+#include "aap_error_codes.h"
+
+int alsa_bus_init(AlsaBus *psBus, unsigned int uiChannels, unsigned int uiCapFrames)
+{
+    unsigned int uiSamples;
+
+    if ((NULL == psBus) || (0 == uiChannels) ||
+            (ALSA_BUS_MAX_CHANNELS < uiChannels) || (0 == uiCapFrames))
+    {
+        printf("ERR::AP::Invalid bus parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psBus, 0x0, sizeof(AlsaBus));
+    uiSamples = uiCapFrames * uiChannels;
+    psBus->ptBus = static_cast<AlsaBusSample *>(
+            malloc(uiSamples * sizeof(AlsaBusSample)));
+    psBus->psOut = static_cast<short *>(malloc(uiSamples * sizeof(short)));
+#if !ALSA_FIXED_POINT
+    psBus->pfDither = static_cast<float *>(malloc(uiSamples * sizeof(float)));
+#endif
+    if ((NULL == psBus->ptBus) || (NULL == psBus->psOut) ||
+            (!ALSA_FIXED_POINT && (NULL == psBus->pfDither)))
+    {
+        printf("ERR::AP::Bus allocation failed!\n");
+        alsa_bus_deinit(psBus);
+        return AAP_ERR_OUT_OF_MEM;
+    }
+    psBus->uiChannels = uiChannels;
+    psBus->uiCapFrames = uiCapFrames;
+    psBus->fGain = 1.0f;
+    psBus->fGainTarget = 1.0f;
+    return 0;
+}
+
+/* Linear gain, taken over smoothly from the next period on. Above 1.0 the
+ * bus has headroom, the output stage saturates. */
+void alsa_bus_set_gain(AlsaBus *psBus, float fGain)
+{
+    fGain = (fGain < 0.0f) ? 0.0f : fGain;
+#if ALSA_FIXED_POINT
+    fGain = (fGain > ALSA_BUS_MAX_GAIN) ? ALSA_BUS_MAX_GAIN : fGain;
+#endif
+    psBus->fGainTarget = fGain;
+}
+
+/* Moves a lowered gain to its target at once, for the caller to apply
+ * *pfRatio to frames already rendered instead of ramping. Nothing is done
+ * for a gain that is not lower, the ratio could clip those frames. */
+AAP_BOOL alsa_bus_take_gain(AlsaBus *psBus, float *pfRatio)
+{
+    float const fTarget = psBus->fGainTarget;
+
+    if (!(fTarget < psBus->fGain))
+    {
+        return AAP_FALSE;
+    }
+    *pfRatio = fTarget / psBus->fGain;
+    psBus->fGain = fTarget;
+    return AAP_TRUE;
+}
+
+/* Called at init, before the render thread runs */
+int alsa_bus_add_stage(AlsaBus *psBus,
+        void (*pfProcess)(void *pvStage, AlsaBusSample *ptBus, unsigned int uiFrames),
+        AAP_BOOL (*pfActive)(void *pvStage),
+        void *pvStage)
+{
+    if ((NULL == pfProcess) || (NULL == pfActive) ||
+            (ALSA_BUS_MAX_STAGES <= psBus->uiStages))
+    {
+        printf("ERR::AP::Cannot add bus stage\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    psBus->asStages[psBus->uiStages].pfProcess = pfProcess;
+    psBus->asStages[psBus->uiStages].pfActive = pfActive;
+    psBus->asStages[psBus->uiStages].pvStage = pvStage;
+    ++psBus->uiStages;
+    return 0;
+}
+
+static AAP_BOOL alsa_bus_active(AlsaBus *psBus)
+{
+    if ((1.0f != psBus->fGain) || (1.0f != psBus->fGainTarget))
+    {
+        return AAP_TRUE;
+    }
+    for (unsigned int i = 0; i < psBus->uiStages; ++i)
+    {
+        if (psBus->asStages[i].pfActive(psBus->asStages[i].pvStage))
+        {
+            return AAP_TRUE;
+        }
+    }
+    return AAP_FALSE;
+}
+
+#if ALSA_FIXED_POINT
+static void alsa_bus_load(AlsaBus *psBus, const short *psIn, unsigned int uiSamples)
+{
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        psBus->ptBus[i] = static_cast<int>(psIn[i]) << (ALSA_BUS_FRAC_BITS - 15);
+    }
+}
+
+/* Q16 gain moving linearly from fGain to fGainTarget over the period */
+static void alsa_bus_gain(AlsaBus *psBus, unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psBus->uiChannels;
+    float const fTarget = psBus->fGainTarget;
+    int const iFrom = static_cast<int>(psBus->fGain * 65536.0f + 0.5f);
+    int const iStep = (static_cast<int>(fTarget * 65536.0f + 0.5f) - iFrom) /
+        static_cast<int>(uiFrames);
+    int *piBus = psBus->ptBus;
+
+    if ((1.0f == psBus->fGain) && (1.0f == fTarget))
+    {
+        return;
+    }
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        int iGain = iFrom + iStep * static_cast<int>(i + 1);
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            piBus[c] = static_cast<int>(
+                    (static_cast<int64_t>(piBus[c]) * iGain) >> 16);
+        }
+        piBus += uiChannels;
+    }
+    psBus->fGain = fTarget;
+}
+
+/* As the float version below, in bus units: one output LSB is
+ * 1 << ALSA_BUS_LSB_SHIFT, the dither is the difference of two uniform
+ * values of that many bits. */
+#define ALSA_BUS_LSB_SHIFT (ALSA_BUS_FRAC_BITS - 15)
+static void alsa_bus_requantize(AlsaBus *psBus, unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psBus->uiChannels;
+    int const iMax = (32767 << ALSA_BUS_LSB_SHIFT);
+    int const iMin = -(32768 << ALSA_BUS_LSB_SHIFT);
+    int const iMask = (1 << ALSA_BUS_LSB_SHIFT) - 1;
+    const int *piBus = psBus->ptBus;
+    short *psOut = psBus->psOut;
+    unsigned int uiSeed = psBus->uiSeed;
+
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            unsigned int uiHash = alsa_dsp_hash(uiSeed++);
+            int iDither = static_cast<int>(uiHash & iMask) -
+                static_cast<int>((uiHash >> 16) & iMask);
+            int iVal = piBus[c] - psBus->atErr[c];
+            int iOut;
+
+            iVal = (iVal > iMax) ? iMax : ((iVal < iMin) ? iMin : iVal);
+            iOut = (iVal + iDither + (1 << (ALSA_BUS_LSB_SHIFT - 1))) >>
+                ALSA_BUS_LSB_SHIFT;
+            iOut = (iOut > 32767) ? 32767 : ((iOut < -32768) ? -32768 : iOut);
+            psOut[c] = static_cast<short>(iOut);
+            psBus->atErr[c] = (iOut << ALSA_BUS_LSB_SHIFT) - iVal;
+        }
+        piBus += uiChannels;
+        psOut += uiChannels;
+    }
+    psBus->uiSeed = uiSeed;
+}
+#else
+static void alsa_bus_load(AlsaBus *psBus, const short *psIn, unsigned int uiSamples)
+{
+    alsa_dsp_get()->pfS16ToFloat(psIn, psBus->ptBus, uiSamples);
+}
+
+/* Gain moving linearly from fGain to fGainTarget over the period */
+static void alsa_bus_gain(AlsaBus *psBus, unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psBus->uiChannels;
+    float const fTarget = psBus->fGainTarget;
+    float const fStep = (fTarget - psBus->fGain) / static_cast<float>(uiFrames);
+    float *pfBus = psBus->ptBus;
+
+    if ((1.0f == psBus->fGain) && (1.0f == fTarget))
+    {
+        return;
+    }
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        float fGain = psBus->fGain + fStep * static_cast<float>(i + 1);
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            pfBus[c] *= fGain;
+        }
+        pfBus += uiChannels;
+    }
+    psBus->fGain = fTarget;
+}
+
+/* Dither and first order noise shaping: y = x - e[n-1], out = Q(y + d),
+ * e[n] = out - y, so the output error is (1 - z^-1) times the added one. */
+static void alsa_bus_requantize(AlsaBus *psBus, unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psBus->uiChannels;
+    const float *pfBus = psBus->ptBus;
+    const float *pfDither = psBus->pfDither;
+    short *psOut = psBus->psOut;
+
+    alsa_dsp_get()->pfTpdf(psBus->pfDither, uiFrames * uiChannels, &psBus->uiSeed);
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            float fVal = pfBus[c] * 32768.0f - psBus->atErr[c];
+            long lOut;
+
+            /* Clipped before the error is taken, the loop stays bounded */
+            fVal = (fVal > 32767.0f) ? 32767.0f : fVal;
+            fVal = (fVal < -32768.0f) ? -32768.0f : fVal;
+            lOut = lrintf(fVal + pfDither[c]);
+            lOut = (lOut > 32767) ? 32767 : ((lOut < -32768) ? -32768 : lOut);
+            psOut[c] = static_cast<short>(lOut);
+            psBus->atErr[c] = static_cast<float>(lOut) - fVal;
+        }
+        pfBus += uiChannels;
+        pfDither += uiChannels;
+        psOut += uiChannels;
+    }
+}
+#endif /* if ALSA_FIXED_POINT */
+
+/* Runs the bus over uiFrames of psIn. *ppsOut is psIn itself while the bus
+ * is bypassed. Returns the number of frames in *ppsOut. */
+int alsa_bus_process(AlsaBus *psBus,
+        const short *psIn,
+        unsigned int uiFrames,
+        const short **ppsOut)
+{
+    *ppsOut = psIn;
+    if (!alsa_bus_active(psBus))
+    {
+        memset(psBus->atErr, 0x0, sizeof(psBus->atErr));
+        return static_cast<int>(uiFrames);
+    }
+    if ((uiFrames > psBus->uiCapFrames) || (0 == uiFrames))
+    {
+        return static_cast<int>(uiFrames);
+    }
+
+    alsa_bus_load(psBus, psIn, uiFrames * psBus->uiChannels);
+    alsa_bus_gain(psBus, uiFrames);
+    for (unsigned int i = 0; i < psBus->uiStages; ++i)
+    {
+        psBus->asStages[i].pfProcess(psBus->asStages[i].pvStage, psBus->ptBus,
+                uiFrames);
+    }
+    alsa_bus_requantize(psBus, uiFrames);
+
+    *ppsOut = psBus->psOut;
+    return static_cast<int>(uiFrames);
+}
+
+void alsa_bus_deinit(AlsaBus *psBus)
+{
+    free(psBus->ptBus);
+    free(psBus->pfDither);
+    free(psBus->psOut);
+    psBus->ptBus = NULL;
+    psBus->pfDither = NULL;
+    psBus->psOut = NULL;
+    psBus->uiCapFrames = 0;
+}
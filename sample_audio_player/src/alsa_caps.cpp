@@ -0,0 +1,634 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_caps.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Capability probing of the ALSA core player.
+ *
+ *   The hardware parameter space of a freshly opened PCM is tested for the
+ *   sample formats the player can write, the common rates up to 48 kHz and
+ *   the channel range. Opened without ALSA's automatic conversions, that is
+ *   what the device takes natively.
+ *
+ *   The configuration chosen for a stream keeps its rate and channels when
+ *   the device has them. Otherwise the nearest higher rate is preferred, so
+ *   the player only ever upsamples when it can.
+ *
+ *   Capabilities, and the buffer and period sizes negotiated for each
+ *   configuration, are kept per device and written to ALSA_CAPS_CACHE_FILE.
+ *   A device is keyed by its name, card, PCM device, driver and the kernel's
+ *   ALSA version, so a new driver or a different card is probed afresh. On
+ *   later boots the sizes are set exactly instead of negotiated; should the
+ *   device refuse them, the entry is dropped and negotiation runs as usual.
+ *
+ *   The file is one entry per line:
+ *     c <key> <formats> <rates> <min channels> <max channels>
+ *     h <key> <format> <rate> <channels> <buffer us> <resample> <wakeup>
+ *       <buffer frames> <period frames>
+ *   and is replaced as a whole, by renaming, whenever an entry is added.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "alsa_caps.h"
+#include "alsa_convert.h"
+#include "aap_error_codes.h"
+
+/* Rates probed, a bit each in AlsaCaps::uiRates */
+static const unsigned int s_auiRates[] =
+{
+    8000, 11025, 16000, 22050, 32000, 44100, 48000
+};
+#define ALSA_CAPS_RATES (sizeof(s_auiRates) / sizeof(s_auiRates[0]))
+
+/* Scan width of a key, ALSA_CAPS_KEY_LEN - 1 */
+#define ALSA_CAPS_KEY_SCAN "%159s"
+
+typedef struct
+{
+    char acKey[ALSA_CAPS_KEY_LEN];
+    AlsaCaps sCaps;
+}AlsaCapsEntry;
+
+typedef struct
+{
+    char acKey[ALSA_CAPS_KEY_LEN];
+    AlsaHwSetup sSetup;
+}AlsaCapsHwEntry;
+
+/* Copy of the cache taken under the lock, written out without it */
+typedef struct
+{
+    AlsaCapsEntry asCache[ALSA_CAPS_CACHE_SIZE];
+    AlsaCapsHwEntry asHwCache[ALSA_CAPS_HW_CACHE_SIZE];
+    unsigned int uiGen;
+}AlsaCapsSnapshot;
+
+static pthread_mutex_t s_sCacheLock = PTHREAD_MUTEX_INITIALIZER;
+static AlsaCapsEntry s_asCache[ALSA_CAPS_CACHE_SIZE];
+static unsigned int s_uiCacheNext;
+static AlsaCapsHwEntry s_asHwCache[ALSA_CAPS_HW_CACHE_SIZE];
+static unsigned int s_uiHwCacheNext;
+/* Set once ALSA_CAPS_CACHE_FILE has been read */
+static int s_iLoaded;
+/* Changes made to the cache, under s_sCacheLock */
+static unsigned int s_uiCacheGen;
+/* Serializes the writes of the file, and the change last written */
+static pthread_mutex_t s_sSaveLock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int s_uiSavedGen;
+
+snd_pcm_format_t alsa_caps_pcm_format(AlsaSampleFormat eFormat)
+{
+    switch (eFormat)
+    {
+        case ALSA_SAMPLE_S32:
+            return SND_PCM_FORMAT_S32_LE;
+        case ALSA_SAMPLE_FLOAT:
+            return SND_PCM_FORMAT_FLOAT_LE;
+        default:
+            return SND_PCM_FORMAT_S16_LE;
+    }
+}
+
+static int alsa_caps_probe(snd_pcm_t *pcmHandle, AlsaCaps *psCaps)
+{
+    snd_pcm_hw_params_t *psHwParams;
+    int iRet;
+
+    memset(psCaps, 0x0, sizeof(AlsaCaps));
+    snd_pcm_hw_params_alloca(&psHwParams);
+    iRet = snd_pcm_hw_params_any(pcmHandle, psHwParams);
+    if (iRet < 0)
+    {
+        printf("ERR::AP::No hardware parameters to probe %d\n", iRet);
+        return iRet;
+    }
+    if (0 != snd_pcm_hw_params_test_access(pcmHandle, psHwParams,
+                SND_PCM_ACCESS_RW_INTERLEAVED))
+    {
+        printf("ERR::AP::Device has no interleaved access\n");
+        return AAP_ERR_PRECOND_NOT_MET;
+    }
+    for (int i = ALSA_SAMPLE_S16; i <= ALSA_SAMPLE_FLOAT; ++i)
+    {
+        if (0 == snd_pcm_hw_params_test_format(pcmHandle, psHwParams,
+                    alsa_caps_pcm_format(static_cast<AlsaSampleFormat>(i))))
+        {
+            psCaps->uiFormats |= 1U << i;
+        }
+    }
+    for (unsigned int i = 0; i < ALSA_CAPS_RATES; ++i)
+    {
+        if (0 == snd_pcm_hw_params_test_rate(pcmHandle, psHwParams, s_auiRates[i], 0))
+        {
+            psCaps->uiRates |= 1U << i;
+        }
+    }
+    snd_pcm_hw_params_get_channels_min(psHwParams, &psCaps->uiMinChannels);
+    snd_pcm_hw_params_get_channels_max(psHwParams, &psCaps->uiMaxChannels);
+    if ((0 == psCaps->uiFormats) || (0 == psCaps->uiRates) ||
+            (0 == psCaps->uiMaxChannels))
+    {
+        printf("ERR::AP::Device takes no format the player writes\n");
+        return AAP_ERR_PRECOND_NOT_MET;
+    }
+    return 0;
+}
+
+/* Version of the kernel's ALSA drivers, "-" when unknown */
+static void alsa_caps_driver_version(char *pcVersion, size_t uiLen)
+{
+    char acLine[128];
+    const char *pcLast = "-";
+    FILE *psFile = fopen("/proc/asound/version", "r");
+
+    if (psFile && fgets(acLine, sizeof(acLine), psFile))
+    {
+        /* "Advanced Linux Sound Architecture Driver Version k6.1.0." */
+        char *pcWord = strrchr(acLine, ' ');
+        if (pcWord)
+        {
+            pcLast = pcWord + 1;
+        }
+    }
+    snprintf(pcVersion, uiLen, "%s", pcLast);
+    if (psFile)
+    {
+        fclose(psFile);
+    }
+}
+
+/* Key of the device pcmHandle was opened on as pcDevice. Fails, leaving an
+ * empty key that is never cached, when it does not fit. */
+int alsa_caps_key(snd_pcm_t *pcmHandle, const char *pcDevice, char *pcKey)
+{
+    snd_pcm_info_t *psInfo;
+    snd_ctl_card_info_t *psCardInfo;
+    snd_ctl_t *psCtl;
+    const char *pcCard = "-";
+    const char *pcDriver = "-";
+    char acCtl[16];
+    char acVersion[32];
+    int iCard = -1;
+    unsigned int uiDevice = 0;
+    int iLen;
+
+    snd_pcm_info_alloca(&psInfo);
+    snd_ctl_card_info_alloca(&psCardInfo);
+    if (0 == snd_pcm_info(pcmHandle, psInfo))
+    {
+        iCard = snd_pcm_info_get_card(psInfo);
+        uiDevice = snd_pcm_info_get_device(psInfo);
+    }
+    if (iCard >= 0)
+    {
+        snprintf(acCtl, sizeof(acCtl), "hw:%d", iCard);
+        if (0 == snd_ctl_open(&psCtl, acCtl, 0))
+        {
+            if (0 == snd_ctl_card_info(psCtl, psCardInfo))
+            {
+                pcCard = snd_ctl_card_info_get_id(psCardInfo);
+                pcDriver = snd_ctl_card_info_get_driver(psCardInfo);
+            }
+            snd_ctl_close(psCtl);
+        }
+    }
+    alsa_caps_driver_version(acVersion, sizeof(acVersion));
+
+    iLen = snprintf(pcKey, ALSA_CAPS_KEY_LEN, "%s|%s,%u|%s|%s", pcDevice, pcCard,
+            uiDevice, pcDriver, acVersion);
+    if ((iLen < 0) || (iLen >= ALSA_CAPS_KEY_LEN))
+    {
+        pcKey[0] = '\0';
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    /* One word per key in the file */
+    for (char *pc = pcKey; *pc; ++pc)
+    {
+        if (isspace(static_cast<unsigned char>(*pc)))
+        {
+            *pc = '_';
+        }
+    }
+    return 0;
+}
+
+/* Reads ALSA_CAPS_CACHE_FILE into the cache, once. Lines that do not parse
+ * are skipped. Called with s_sCacheLock held. */
+static void alsa_caps_load(void)
+{
+    char acLine[ALSA_CAPS_KEY_LEN + 128];
+    FILE *psFile;
+
+    if (s_iLoaded || ('\0' == ALSA_CAPS_CACHE_FILE[0]))
+    {
+        s_iLoaded = 1;
+        return;
+    }
+    s_iLoaded = 1;
+    psFile = fopen(ALSA_CAPS_CACHE_FILE, "r");
+    if (NULL == psFile)
+    {
+        return;
+    }
+    while (fgets(acLine, sizeof(acLine), psFile))
+    {
+        AlsaCapsEntry sCaps;
+        AlsaCapsHwEntry sHw;
+        unsigned long ulBuffer = 0;
+        unsigned long ulPeriod = 0;
+        int iFormat = 0;
+
+        memset(&sCaps, 0x0, sizeof(sCaps));
+        memset(&sHw, 0x0, sizeof(sHw));
+        if ((5 == sscanf(acLine, "c " ALSA_CAPS_KEY_SCAN " %x %x %u %u", sCaps.acKey,
+                        &sCaps.sCaps.uiFormats, &sCaps.sCaps.uiRates,
+                        &sCaps.sCaps.uiMinChannels, &sCaps.sCaps.uiMaxChannels)) &&
+                (s_uiCacheNext < ALSA_CAPS_CACHE_SIZE))
+        {
+            s_asCache[s_uiCacheNext++] = sCaps;
+        }
+        else if ((9 == sscanf(acLine, "h " ALSA_CAPS_KEY_SCAN " %d %u %u %u %d %d %lu %lu",
+                        sHw.acKey, &iFormat, &sHw.sSetup.uiRate, &sHw.sSetup.uiChannels,
+                        &sHw.sSetup.uiBufferUs, &sHw.sSetup.iResample,
+                        &sHw.sSetup.iPeriodWakeup, &ulBuffer, &ulPeriod)) &&
+                (0 != ulPeriod) && (ulBuffer >= ulPeriod) &&
+                (s_uiHwCacheNext < ALSA_CAPS_HW_CACHE_SIZE))
+        {
+            sHw.sSetup.format = static_cast<snd_pcm_format_t>(iFormat);
+            sHw.sSetup.bufferSize = ulBuffer;
+            sHw.sSetup.periodSize = ulPeriod;
+            s_asHwCache[s_uiHwCacheNext++] = sHw;
+        }
+    }
+    fclose(psFile);
+    s_uiCacheNext %= ALSA_CAPS_CACHE_SIZE;
+    s_uiHwCacheNext %= ALSA_CAPS_HW_CACHE_SIZE;
+    printf("AP::Capability cache loaded from %s\n", ALSA_CAPS_CACHE_FILE);
+}
+
+/* Records a change of the cache and copies it for alsa_caps_save().
+ * Called with s_sCacheLock held. */
+static void alsa_caps_changed(AlsaCapsSnapshot *psSnapshot)
+{
+    memcpy(psSnapshot->asCache, s_asCache, sizeof(s_asCache));
+    memcpy(psSnapshot->asHwCache, s_asHwCache, sizeof(s_asHwCache));
+    psSnapshot->uiGen = ++s_uiCacheGen;
+}
+
+/* Writes a copy of the cache out in full. A power cut part way leaves the
+ * previous file in place. Called without s_sCacheLock, so that lookups do
+ * not wait for the disk; a copy older than the one last written is
+ * skipped. */
+static void alsa_caps_save(const AlsaCapsSnapshot *psSnapshot)
+{
+    char acTmp[256];
+    FILE *psFile;
+    int iErr = 0;
+
+    if ('\0' == ALSA_CAPS_CACHE_FILE[0])
+    {
+        return;
+    }
+    pthread_mutex_lock(&s_sSaveLock);
+    if (static_cast<int>(psSnapshot->uiGen - s_uiSavedGen) <= 0)
+    {
+        pthread_mutex_unlock(&s_sSaveLock);
+        return;
+    }
+    snprintf(acTmp, sizeof(acTmp), "%s.tmp", ALSA_CAPS_CACHE_FILE);
+    psFile = fopen(acTmp, "w");
+    if (NULL == psFile)
+    {
+        printf("AP::Capability cache %s not writable\n", ALSA_CAPS_CACHE_FILE);
+        pthread_mutex_unlock(&s_sSaveLock);
+        return;
+    }
+    for (unsigned int i = 0; i < ALSA_CAPS_CACHE_SIZE; ++i)
+    {
+        const AlsaCapsEntry *psEntry = &psSnapshot->asCache[i];
+        if (psEntry->acKey[0])
+        {
+            fprintf(psFile, "c %s %x %x %u %u\n", psEntry->acKey,
+                    psEntry->sCaps.uiFormats, psEntry->sCaps.uiRates,
+                    psEntry->sCaps.uiMinChannels, psEntry->sCaps.uiMaxChannels);
+        }
+    }
+    for (unsigned int i = 0; i < ALSA_CAPS_HW_CACHE_SIZE; ++i)
+    {
+        const AlsaCapsHwEntry *psEntry = &psSnapshot->asHwCache[i];
+        if (psEntry->acKey[0])
+        {
+            fprintf(psFile, "h %s %d %u %u %u %d %d %lu %lu\n", psEntry->acKey,
+                    static_cast<int>(psEntry->sSetup.format), psEntry->sSetup.uiRate,
+                    psEntry->sSetup.uiChannels, psEntry->sSetup.uiBufferUs,
+                    psEntry->sSetup.iResample, psEntry->sSetup.iPeriodWakeup,
+                    psEntry->sSetup.bufferSize, psEntry->sSetup.periodSize);
+        }
+    }
+    if ((0 != fflush(psFile)) || (0 != fsync(fileno(psFile))))
+    {
+        iErr = 1;
+    }
+    if ((0 != fclose(psFile)) || iErr || (0 != rename(acTmp, ALSA_CAPS_CACHE_FILE)))
+    {
+        printf("ERR::AP::Capability cache %s not written\n", ALSA_CAPS_CACHE_FILE);
+        unlink(acTmp);
+    }
+    else
+    {
+        s_uiSavedGen = psSnapshot->uiGen;
+    }
+    pthread_mutex_unlock(&s_sSaveLock);
+}
+
+/* Capabilities cached for pcKey into psCaps. Returns 0 when there are
+ * none. Called with s_sCacheLock held. */
+static int alsa_caps_find(const char *pcKey, AlsaCaps *psCaps)
+{
+    for (unsigned int i = 0; pcKey[0] && (i < ALSA_CAPS_CACHE_SIZE); ++i)
+    {
+        if (0 == strcmp(s_asCache[i].acKey, pcKey))
+        {
+            *psCaps = s_asCache[i].sCaps;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Capabilities of the device pcmHandle was opened on, probed once per key.
+ * Players opened on the same device at once may both probe it, only the
+ * first result is kept. */
+int alsa_caps_get(snd_pcm_t *pcmHandle, const char *pcKey, AlsaCaps *psCaps)
+{
+    AlsaCapsSnapshot sSnapshot;
+    int iFound;
+    int iRet;
+
+    pthread_mutex_lock(&s_sCacheLock);
+    alsa_caps_load();
+    iFound = alsa_caps_find(pcKey, psCaps);
+    pthread_mutex_unlock(&s_sCacheLock);
+    if (iFound)
+    {
+        return 0;
+    }
+
+    iRet = alsa_caps_probe(pcmHandle, psCaps);
+    if ((0 != iRet) || ('\0' == pcKey[0]))
+    {
+        return iRet;
+    }
+    pthread_mutex_lock(&s_sCacheLock);
+    if (alsa_caps_find(pcKey, psCaps))
+    {
+        /* Probed by another player meanwhile */
+        pthread_mutex_unlock(&s_sCacheLock);
+        return 0;
+    }
+    strcpy(s_asCache[s_uiCacheNext].acKey, pcKey);
+    s_asCache[s_uiCacheNext].sCaps = *psCaps;
+    s_uiCacheNext = (s_uiCacheNext + 1) % ALSA_CAPS_CACHE_SIZE;
+    alsa_caps_changed(&sSnapshot);
+    pthread_mutex_unlock(&s_sCacheLock);
+    alsa_caps_save(&sSnapshot);
+    printf("AP::Probed %s: formats 0x%x, rates 0x%x, channels %u-%u\n", pcKey,
+            psCaps->uiFormats, psCaps->uiRates, psCaps->uiMinChannels,
+            psCaps->uiMaxChannels);
+    return 0;
+}
+
+/* Native configuration for a stream of uiRate and uiChannels. S16 is
+ * preferred as the player works in it. Fails when the device only has rates
+ * so low that the stream would have to be downsampled more than twofold. */
+int alsa_caps_choose(const AlsaCaps *psCaps, unsigned int uiRate,
+        unsigned int uiChannels, AlsaSampleFormat *peFormat,
+        unsigned int *puiRate, unsigned int *puiChannels)
+{
+    unsigned int uiBest = 0;
+
+    if (psCaps->uiFormats & (1U << ALSA_SAMPLE_S16))
+    {
+        *peFormat = ALSA_SAMPLE_S16;
+    }
+    else if (psCaps->uiFormats & (1U << ALSA_SAMPLE_S32))
+    {
+        *peFormat = ALSA_SAMPLE_S32;
+    }
+    else
+    {
+        *peFormat = ALSA_SAMPLE_FLOAT;
+    }
+
+    /* The lowest rate at or above the stream's, else the highest below */
+    for (unsigned int i = 0; i < ALSA_CAPS_RATES; ++i)
+    {
+        if (0 == (psCaps->uiRates & (1U << i)))
+        {
+            continue;
+        }
+        uiBest = s_auiRates[i];
+        if (uiBest >= uiRate)
+        {
+            break;
+        }
+    }
+    if (2 * uiBest < uiRate)
+    {
+        printf("ERR::AP::No rate near %u Hz\n", uiRate);
+        return AAP_ERR_PRECOND_NOT_MET;
+    }
+    *puiRate = uiBest;
+
+    *puiChannels = uiChannels;
+    if (*puiChannels < psCaps->uiMinChannels)
+    {
+        *puiChannels = psCaps->uiMinChannels;
+    }
+    if (*puiChannels > psCaps->uiMaxChannels)
+    {
+        *puiChannels = psCaps->uiMaxChannels;
+    }
+    if (*puiChannels > ALSA_CONVERT_MAX_CHANNELS)
+    {
+        printf("ERR::AP::No channel count up to %u\n", ALSA_CONVERT_MAX_CHANNELS);
+        return AAP_ERR_PRECOND_NOT_MET;
+    }
+    return 0;
+}
+
+static int alsa_caps_hw_match(const AlsaCapsHwEntry *psEntry, const char *pcKey,
+        const AlsaHwSetup *psSetup)
+{
+    return (0 == strcmp(psEntry->acKey, pcKey)) &&
+            (psEntry->sSetup.format == psSetup->format) &&
+            (psEntry->sSetup.uiRate == psSetup->uiRate) &&
+            (psEntry->sSetup.uiChannels == psSetup->uiChannels) &&
+            (psEntry->sSetup.uiBufferUs == psSetup->uiBufferUs) &&
+            (psEntry->sSetup.iResample == psSetup->iResample) &&
+            (psEntry->sSetup.iPeriodWakeup == psSetup->iPeriodWakeup);
+}
+
+/* Sets the hardware and software parameters of pcmHandle from the sizes
+ * cached for the configuration in psSetup, filling them in. Fails when there
+ * are none or the device refuses them; the caller then negotiates. */
+int alsa_caps_set_hw(snd_pcm_t *pcmHandle, const char *pcKey, AlsaHwSetup *psSetup)
+{
+    snd_pcm_hw_params_t *psHwParams;
+    snd_pcm_sw_params_t *psSwParams;
+    AlsaCapsHwEntry *psEntry = NULL;
+    AlsaCapsSnapshot sSnapshot;
+    snd_pcm_uframes_t startFrames;
+    int iRet;
+
+    pthread_mutex_lock(&s_sCacheLock);
+    alsa_caps_load();
+    for (unsigned int i = 0; pcKey[0] && (i < ALSA_CAPS_HW_CACHE_SIZE); ++i)
+    {
+        if (alsa_caps_hw_match(&s_asHwCache[i], pcKey, psSetup))
+        {
+            psEntry = &s_asHwCache[i];
+            psSetup->bufferSize = psEntry->sSetup.bufferSize;
+            psSetup->periodSize = psEntry->sSetup.periodSize;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_sCacheLock);
+    if (NULL == psEntry)
+    {
+        return AAP_ERR_PRECOND_NOT_MET;
+    }
+
+    snd_pcm_hw_params_alloca(&psHwParams);
+    snd_pcm_sw_params_alloca(&psSwParams);
+    iRet = snd_pcm_hw_params_any(pcmHandle, psHwParams);
+    if (0 <= iRet)
+    {
+        iRet = snd_pcm_hw_params_set_rate_resample(pcmHandle, psHwParams,
+                psSetup->iResample);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_access(pcmHandle, psHwParams,
+                SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_format(pcmHandle, psHwParams, psSetup->format);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_channels(pcmHandle, psHwParams, psSetup->uiChannels);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_rate(pcmHandle, psHwParams, psSetup->uiRate, 0);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_buffer_size(pcmHandle, psHwParams,
+                psSetup->bufferSize);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params_set_period_size(pcmHandle, psHwParams,
+                psSetup->periodSize, 0);
+    }
+    if ((0 == iRet) && !psSetup->iPeriodWakeup)
+    {
+        snd_pcm_hw_params_set_period_wakeup(pcmHandle, psHwParams, 0);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_hw_params(pcmHandle, psHwParams);
+    }
+
+    /* As snd_pcm_set_params() leaves them unless told otherwise */
+    startFrames = psSetup->startFrames ? psSetup->startFrames :
+        (psSetup->bufferSize / psSetup->periodSize) * psSetup->periodSize;
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params_current(pcmHandle, psSwParams);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params_set_start_threshold(pcmHandle, psSwParams, startFrames);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params_set_avail_min(pcmHandle, psSwParams, psSetup->periodSize);
+    }
+    if (0 == iRet)
+    {
+        iRet = snd_pcm_sw_params(pcmHandle, psSwParams);
+    }
+    if (0 != iRet)
+    {
+        printf("AP::Cached parameters refused %d, negotiating\n", iRet);
+        pthread_mutex_lock(&s_sCacheLock);
+        for (unsigned int i = 0; i < ALSA_CAPS_HW_CACHE_SIZE; ++i)
+        {
+            if (alsa_caps_hw_match(&s_asHwCache[i], pcKey, psSetup))
+            {
+                s_asHwCache[i].acKey[0] = '\0';
+            }
+        }
+        alsa_caps_changed(&sSnapshot);
+        pthread_mutex_unlock(&s_sCacheLock);
+        alsa_caps_save(&sSnapshot);
+        return iRet;
+    }
+    return 0;
+}
+
+/* Keeps the sizes negotiated for the configuration in psSetup */
+void alsa_caps_put_hw(const char *pcKey, const AlsaHwSetup *psSetup)
+{
+    AlsaCapsSnapshot sSnapshot;
+    unsigned int uiSlot = ALSA_CAPS_HW_CACHE_SIZE;
+
+    if ('\0' == pcKey[0])
+    {
+        return;
+    }
+    pthread_mutex_lock(&s_sCacheLock);
+    for (unsigned int i = 0; i < ALSA_CAPS_HW_CACHE_SIZE; ++i)
+    {
+        if (alsa_caps_hw_match(&s_asHwCache[i], pcKey, psSetup))
+        {
+            uiSlot = i;
+            break;
+        }
+    }
+    if (ALSA_CAPS_HW_CACHE_SIZE == uiSlot)
+    {
+        uiSlot = s_uiHwCacheNext;
+        s_uiHwCacheNext = (s_uiHwCacheNext + 1) % ALSA_CAPS_HW_CACHE_SIZE;
+    }
+    strcpy(s_asHwCache[uiSlot].acKey, pcKey);
+    s_asHwCache[uiSlot].sSetup = *psSetup;
+    alsa_caps_changed(&sSnapshot);
+    pthread_mutex_unlock(&s_sCacheLock);
+    alsa_caps_save(&sSnapshot);
+}
@@ -0,0 +1,223 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_convert.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Input format conversion of the ALSA core player.
+ *
+ *   Channels are mapped first: fewer input channels are repeated across the
+ *   outputs, more are averaged down onto them. A different sample rate is
+ *   then converted with the cubic Hermite interpolator drift compensation
+ *   uses, at the fixed ratio of the two rates. It is meant for rates close
+ *   to the device one such as 44.1 kHz on a 48 kHz PCM; rates more than
+ *   twice the device one are refused as they would alias.
+ *
+ *   While the input has the device format nothing is done.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "alsa_convert.h"
+#include "alsa_kernels.h"
+#include "aap_error_codes.h"
+
+/* Input frames kept from the previous chunk for the interpolator */
+#define ALSA_CONVERT_HIST_FRAMES 3
+
+int alsa_convert_init(AlsaConvert *psConvert, unsigned int uiChannels,
+        unsigned int uiRate)
+{
+    AlsaKernels sKernels;
+
+    if ((NULL == psConvert) || (0 == uiChannels) ||
+            (ALSA_CONVERT_MAX_CHANNELS < uiChannels) || (0 == uiRate))
+    {
+        printf("ERR::AP::Invalid conversion parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psConvert, 0x0, sizeof(AlsaConvert));
+    if (0 != alsa_kernels_select(&sKernels, ALSA_SAMPLE_S16, uiChannels))
+    {
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    psConvert->pfResample = sKernels.pfResample;
+    psConvert->uiOutChannels = uiChannels;
+    psConvert->uiOutRate = uiRate;
+    return alsa_convert_set_input(psConvert, uiChannels, uiRate);
+}
+
+/* Retargets the conversion to a new input format. The interpolator starts
+ * over, the caller fades across the change. */
+int alsa_convert_set_input(AlsaConvert *psConvert, unsigned int uiChannels,
+        unsigned int uiRate)
+{
+    if ((0 == uiChannels) || (ALSA_CONVERT_MAX_CHANNELS < uiChannels) ||
+            (0 == uiRate) || (uiRate > 2 * psConvert->uiOutRate))
+    {
+        printf("ERR::AP::Input of %u ch at %u Hz cannot be converted\n",
+                uiChannels, uiRate);
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    psConvert->uiInChannels = uiChannels;
+    psConvert->uiInRate = uiRate;
+    psConvert->dStep = static_cast<double>(uiRate) / psConvert->uiOutRate;
+    psConvert->dPhase = 1.0;
+    if (psConvert->psStage)
+    {
+        memset(psConvert->psStage, 0x0, ALSA_CONVERT_HIST_FRAMES *
+                psConvert->uiOutChannels * sizeof(short));
+    }
+    return 0;
+}
+
+int alsa_convert_active(const AlsaConvert *psConvert)
+{
+    return (psConvert->uiInChannels != psConvert->uiOutChannels) ||
+        (psConvert->uiInRate != psConvert->uiOutRate);
+}
+
+static int alsa_convert_reserve(AlsaConvert *psConvert, unsigned int uiInFrames)
+{
+    unsigned int const uiChannels = psConvert->uiOutChannels;
+    unsigned int uiStageFrames = uiInFrames + ALSA_CONVERT_HIST_FRAMES;
+    unsigned int uiOutFrames = static_cast<unsigned int>(
+            uiInFrames / psConvert->dStep) + 2;
+
+    if (uiStageFrames > psConvert->uiStageCap)
+    {
+        short *psStage = static_cast<short *>(realloc(psConvert->psStage,
+                    uiStageFrames * uiChannels * sizeof(short)));
+        if (NULL == psStage)
+        {
+            printf("ERR::AP::Conversion stage allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        if (NULL == psConvert->psStage)
+        {
+            memset(psStage, 0x0,
+                    ALSA_CONVERT_HIST_FRAMES * uiChannels * sizeof(short));
+        }
+        psConvert->psStage = psStage;
+        psConvert->uiStageCap = uiStageFrames;
+    }
+    if (uiOutFrames > psConvert->uiOutCap)
+    {
+        short *psOut = static_cast<short *>(realloc(psConvert->psOut,
+                    uiOutFrames * uiChannels * sizeof(short)));
+        if (NULL == psOut)
+        {
+            printf("ERR::AP::Conversion output allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        psConvert->psOut = psOut;
+        psConvert->uiOutCap = uiOutFrames;
+    }
+    return 0;
+}
+
+static void alsa_convert_map(const AlsaConvert *psConvert, const short *psIn,
+        short *psOut, unsigned int uiFrames)
+{
+    unsigned int const uiIn = psConvert->uiInChannels;
+    unsigned int const uiOut = psConvert->uiOutChannels;
+
+    if (uiIn == uiOut)
+    {
+        memcpy(psOut, psIn, uiFrames * uiOut * sizeof(short));
+        return;
+    }
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        for (unsigned int c = 0; c < uiOut; ++c)
+        {
+            int iSum = 0;
+            int iCount = 0;
+
+            if (uiIn < uiOut)
+            {
+                iSum = psIn[c % uiIn];
+                iCount = 1;
+            }
+            else
+            {
+                for (unsigned int k = c; k < uiIn; k += uiOut)
+                {
+                    iSum += psIn[k];
+                    ++iCount;
+                }
+            }
+            psOut[c] = static_cast<short>(iSum / iCount);
+        }
+        psIn += uiIn;
+        psOut += uiOut;
+    }
+}
+
+/* Converts uiInFrames input frames, *ppsOut points to the result. Returns
+ * the frames of it, or -1 when out of memory. */
+int alsa_convert_process(AlsaConvert *psConvert, const short *psIn,
+        unsigned int uiInFrames, const short **ppsOut)
+{
+    unsigned int const uiChannels = psConvert->uiOutChannels;
+    short *psChunk;
+    double dPhase = psConvert->dPhase;
+    int iOutFrames;
+
+    if (!alsa_convert_active(psConvert))
+    {
+        *ppsOut = psIn;
+        return static_cast<int>(uiInFrames);
+    }
+    if (0 != alsa_convert_reserve(psConvert, uiInFrames))
+    {
+        return -1;
+    }
+    psChunk = psConvert->psStage + ALSA_CONVERT_HIST_FRAMES * uiChannels;
+    alsa_convert_map(psConvert, psIn, psChunk, uiInFrames);
+    if (psConvert->uiInRate == psConvert->uiOutRate)
+    {
+        *ppsOut = psChunk;
+        return static_cast<int>(uiInFrames);
+    }
+
+    /* Position p runs over [1, uiInFrames + 1) of the staging buffer */
+    iOutFrames = static_cast<int>(psConvert->pfResample(psConvert->psStage,
+                psConvert->psOut, uiChannels, &dPhase, psConvert->dStep,
+                static_cast<double>(uiInFrames + 1)));
+    psConvert->dPhase = dPhase - uiInFrames;
+
+    /* Last frames of this chunk become the history of the next one */
+    memmove(psConvert->psStage, psConvert->psStage + uiInFrames * uiChannels,
+            ALSA_CONVERT_HIST_FRAMES * uiChannels * sizeof(short));
+
+    *ppsOut = psConvert->psOut;
+    return iOutFrames;
+}
+
+void alsa_convert_deinit(AlsaConvert *psConvert)
+{
+    free(psConvert->psStage);
+    free(psConvert->psOut);
+    psConvert->psStage = NULL;
+    psConvert->psOut = NULL;
+    psConvert->uiStageCap = 0;
+    psConvert->uiOutCap = 0;
+}
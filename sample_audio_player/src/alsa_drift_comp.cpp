@@ -0,0 +1,243 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_drift_comp.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Asynchronous clock drift compensation for the ALSA core player.
+ *
+ *   The fill level of the ALSA buffer is sampled before every write and low
+ *   pass filtered. A PI controller turns the distance from the target fill
+ *   into a ratio correction in ppm, which is slew limited so the pitch never
+ *   jumps audibly. The stream is then resampled by that ratio with a 4 point
+ *   cubic Hermite interpolator, which is transparent at a ratio of exactly 1.
+ *   The interpolator is the kernel for the stream's channel count, see
+ *   alsa_kernels.cpp.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "alsa_drift_comp.h"
+#include "alsa_kernels.h"
+#include "aap_error_codes.h"
+
+/* Input frames kept from the previous chunk for the interpolator */
+#define ALSA_DRIFT_HIST_FRAMES 3
+/* Time constant of the fill level low pass filter, in seconds */
+#define ALSA_DRIFT_FILL_TC_S 1.0
+/* Proportional time constant: a fill error is worked off over this period */
+#define ALSA_DRIFT_TP_S 8.0
+/* Integral time constant. 4 * Tp gives a critically damped loop */
+#define ALSA_DRIFT_TI_S 32.0
+/* Maximum rate of change of the correction, in ppm per second */
+#define ALSA_DRIFT_SLEW_PPM_PER_S 200.0
+
+int alsa_drift_init(AlsaDriftComp *psDrift,
+        unsigned int uiChannels,
+        unsigned int uiRate,
+        unsigned long ulTargetFill)
+{
+    AlsaKernels sKernels;
+
+    if ((NULL == psDrift) || (0 == uiChannels) ||
+            (ALSA_DRIFT_MAX_CHANNELS < uiChannels) || (0 == uiRate))
+    {
+        printf("ERR::AP::Invalid drift compensation parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psDrift, 0x0, sizeof(AlsaDriftComp));
+    if (0 != alsa_kernels_select(&sKernels, ALSA_SAMPLE_S16, uiChannels))
+    {
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    psDrift->pfResample = sKernels.pfResample;
+    psDrift->uiChannels = uiChannels;
+    psDrift->uiRate = uiRate;
+    psDrift->dTargetFill = static_cast<double>(ulTargetFill);
+    alsa_drift_reset(psDrift);
+
+    return 0;
+}
+
+void alsa_drift_reset(AlsaDriftComp *psDrift)
+{
+    psDrift->dFillAvg = psDrift->dTargetFill;
+    psDrift->dIntegral = 0.0;
+    psDrift->dRatioPpm = 0.0;
+    psDrift->dPhase = 1.0;
+    psDrift->bPrimed = AAP_FALSE;
+    if (psDrift->psStage)
+    {
+        memset(psDrift->psStage, 0x0,
+                ALSA_DRIFT_HIST_FRAMES * psDrift->uiChannels * sizeof(short));
+    }
+}
+
+/* Moves the fill level steered to. Reaching a higher one is left to the
+ * controller, within its ppm clamp. */
+void alsa_drift_set_target(AlsaDriftComp *psDrift, unsigned long ulTargetFill)
+{
+    psDrift->dTargetFill = static_cast<double>(ulTargetFill);
+}
+
+void alsa_drift_update(AlsaDriftComp *psDrift,
+        long lFill,
+        unsigned int uiFrames)
+{
+    double dDt = static_cast<double>(uiFrames) / psDrift->uiRate;
+    double dPpmPerFrame = 1e6 / (psDrift->uiRate * ALSA_DRIFT_TP_S);
+    double dMaxIntegral = ALSA_DRIFT_MAX_PPM * ALSA_DRIFT_TI_S / dPpmPerFrame;
+    double dMaxStep = ALSA_DRIFT_SLEW_PPM_PER_S * dDt;
+    double dError;
+    double dPpm;
+
+    if (!psDrift->bPrimed)
+    {
+        /* Start from the first real measurement, not from the target */
+        psDrift->dFillAvg = static_cast<double>(lFill);
+        psDrift->bPrimed = AAP_TRUE;
+    }
+    else
+    {
+        psDrift->dFillAvg += (dDt / (ALSA_DRIFT_FILL_TC_S + dDt)) *
+            (static_cast<double>(lFill) - psDrift->dFillAvg);
+    }
+
+    dError = psDrift->dFillAvg - psDrift->dTargetFill;
+    psDrift->dIntegral += dError * dDt;
+    /* Anti windup: the integral term alone may not exceed the clamp */
+    if (psDrift->dIntegral > dMaxIntegral)
+    {
+        psDrift->dIntegral = dMaxIntegral;
+    }
+    else if (psDrift->dIntegral < -dMaxIntegral)
+    {
+        psDrift->dIntegral = -dMaxIntegral;
+    }
+
+    /* Too much data queued means the DAC is slower than the phone, so the
+     * stream has to be shortened, i.e. a negative correction. */
+    dPpm = -(dError + psDrift->dIntegral / ALSA_DRIFT_TI_S) * dPpmPerFrame;
+    if (dPpm > ALSA_DRIFT_MAX_PPM)
+    {
+        dPpm = ALSA_DRIFT_MAX_PPM;
+    }
+    else if (dPpm < -ALSA_DRIFT_MAX_PPM)
+    {
+        dPpm = -ALSA_DRIFT_MAX_PPM;
+    }
+
+    if (dPpm > psDrift->dRatioPpm + dMaxStep)
+    {
+        dPpm = psDrift->dRatioPpm + dMaxStep;
+    }
+    else if (dPpm < psDrift->dRatioPpm - dMaxStep)
+    {
+        dPpm = psDrift->dRatioPpm - dMaxStep;
+    }
+    psDrift->dRatioPpm = dPpm;
+}
+
+static int alsa_drift_reserve(AlsaDriftComp *psDrift, unsigned int uiInFrames)
+{
+    unsigned int const uiChannels = psDrift->uiChannels;
+    unsigned int uiStageFrames = uiInFrames + ALSA_DRIFT_HIST_FRAMES;
+    /* Output can grow by at most the max correction plus rounding */
+    unsigned int uiOutFrames = uiInFrames +
+        (uiInFrames * ALSA_DRIFT_MAX_PPM) / 1000000 + 2;
+
+    if (uiStageFrames > psDrift->uiStageCap)
+    {
+        short *psStage = static_cast<short *>(realloc(psDrift->psStage,
+                    uiStageFrames * uiChannels * sizeof(short)));
+        if (NULL == psStage)
+        {
+            printf("ERR::AP::Drift stage allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        if (NULL == psDrift->psStage)
+        {
+            memset(psStage, 0x0,
+                    ALSA_DRIFT_HIST_FRAMES * uiChannels * sizeof(short));
+        }
+        psDrift->psStage = psStage;
+        psDrift->uiStageCap = uiStageFrames;
+    }
+    if (uiOutFrames > psDrift->uiOutCap)
+    {
+        short *psOut = static_cast<short *>(realloc(psDrift->psOut,
+                    uiOutFrames * uiChannels * sizeof(short)));
+        if (NULL == psOut)
+        {
+            printf("ERR::AP::Drift output allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        psDrift->psOut = psOut;
+        psDrift->uiOutCap = uiOutFrames;
+    }
+    return 0;
+}
+
+int alsa_drift_process(AlsaDriftComp *psDrift,
+        const short *psIn,
+        unsigned int uiInFrames,
+        const short **ppsOut)
+{
+    unsigned int const uiChannels = psDrift->uiChannels;
+    double const dStep = 1.0 / (1.0 + psDrift->dRatioPpm * 1e-6);
+    double const dEnd = static_cast<double>(uiInFrames + 1);
+    double dPhase = psDrift->dPhase;
+    int iOutFrames;
+
+    if (0 != alsa_drift_reserve(psDrift, uiInFrames))
+    {
+        return -1;
+    }
+    memcpy(psDrift->psStage + ALSA_DRIFT_HIST_FRAMES * uiChannels, psIn,
+            uiInFrames * uiChannels * sizeof(short));
+
+    /* Position p runs over [1, uiInFrames + 1) of the staging buffer */
+    iOutFrames = static_cast<int>(psDrift->pfResample(psDrift->psStage,
+                psDrift->psOut, uiChannels, &dPhase, dStep, dEnd));
+    psDrift->dPhase = dPhase - uiInFrames;
+
+    /* Last frames of this chunk become the history of the next one */
+    memmove(psDrift->psStage, psDrift->psStage + uiInFrames * uiChannels,
+            ALSA_DRIFT_HIST_FRAMES * uiChannels * sizeof(short));
+
+    *ppsOut = psDrift->psOut;
+    return iOutFrames;
+}
+
+void alsa_drift_deinit(AlsaDriftComp *psDrift)
+{
+    if (psDrift->psStage)
+    {
+        free(psDrift->psStage);
+        psDrift->psStage = NULL;
+    }
+    if (psDrift->psOut)
+    {
+        free(psDrift->psOut);
+        psDrift->psOut = NULL;
+    }
+    psDrift->uiStageCap = 0;
+    psDrift->uiOutCap = 0;
+}
@@ -0,0 +1,305 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_dsp.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Scalar reference kernels and variant selection.
+ *
+ *   Every kernel is defined so that it can be computed exactly the same way
+ *   in vector registers: the dither comes from a hash of the sample number
+ *   rather than a sequential generator, float results are rounded with the
+ *   current (nearest even) rounding mode, and gain ramps step in integers.
+ *
+ *   When the library is loaded the fastest variant the CPU supports is
+ *   taken, after checking it against the scalar kernels on test data. A
+ *   variant that does not match bit for bit is reported and not used.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "alsa_dsp.h"
+
+/* Samples used to check a variant, odd to exercise the tails */
+#define ALSA_DSP_CHECK_SAMPLES 1027
+
+static AlsaDsp sAlsaDsp;
+
+unsigned int alsa_dsp_hash(unsigned int uiIndex)
+{
+    unsigned int x = uiIndex;
+
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+void alsa_dsp_ramp_params(unsigned int uiFrames, int iFromQ15, int iToQ15,
+        int *piBase, int *piStep)
+{
+    *piBase = iFromQ15 << 15;
+    *piStep = (0 == uiFrames) ? 0 :
+        ((iToQ15 - iFromQ15) << 15) / static_cast<int>(uiFrames);
+}
+
+void alsa_dsp_ramp_frames(short *psData, unsigned int uiFirst,
+        unsigned int uiLast, unsigned int uiChannels, int iBase, int iStep)
+{
+    psData += uiFirst * uiChannels;
+    for (unsigned int i = uiFirst; i < uiLast; ++i)
+    {
+        int iGain = (iBase + iStep * static_cast<int>(i + 1)) >> 15;
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            psData[c] = static_cast<short>((psData[c] * iGain) >> 15);
+        }
+        psData += uiChannels;
+    }
+}
+
+static void alsa_dsp_add_sat_s16(short *psDst, const short *psSrc,
+        unsigned int uiSamples)
+{
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        int iSum = psDst[i] + psSrc[i];
+
+        psDst[i] = static_cast<short>((iSum > 32767) ? 32767 :
+                ((iSum < -32768) ? -32768 : iSum));
+    }
+}
+
+static void alsa_dsp_s16_to_float(const short *psIn, float *pfOut,
+        unsigned int uiSamples)
+{
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        pfOut[i] = static_cast<float>(psIn[i]) * (1.0f / 32768.0f);
+    }
+}
+
+/* Difference of two uniform values: triangular over +/-1 LSB */
+static inline float alsa_dsp_dither(unsigned int uiIndex)
+{
+    unsigned int uiHash = alsa_dsp_hash(uiIndex);
+
+    return static_cast<float>(static_cast<int>(uiHash & 0xFFFF) -
+            static_cast<int>(uiHash >> 16)) * (1.0f / 65536.0f);
+}
+
+static void alsa_dsp_tpdf(float *pfOut, unsigned int uiSamples,
+        unsigned int *puiSeed)
+{
+    unsigned int const uiSeed = *puiSeed;
+
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        pfOut[i] = alsa_dsp_dither(uiSeed + i);
+    }
+    *puiSeed = uiSeed + uiSamples;
+}
+
+static void alsa_dsp_float_to_s16(const float *pfIn, short *psOut,
+        unsigned int uiSamples, unsigned int *puiSeed)
+{
+    unsigned int const uiSeed = *puiSeed;
+
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        float fVal = pfIn[i] * 32768.0f + alsa_dsp_dither(uiSeed + i);
+
+        fVal = (fVal > 32767.0f) ? 32767.0f : fVal;
+        fVal = (fVal < -32768.0f) ? -32768.0f : fVal;
+        psOut[i] = static_cast<short>(lrintf(fVal));
+    }
+    *puiSeed = uiSeed + uiSamples;
+}
+
+static void alsa_dsp_gain_ramp(short *psData, unsigned int uiFrames,
+        unsigned int uiChannels, int iFromQ15, int iToQ15)
+{
+    int iBase;
+    int iStep;
+
+    alsa_dsp_ramp_params(uiFrames, iFromQ15, iToQ15, &iBase, &iStep);
+    alsa_dsp_ramp_frames(psData, 0, uiFrames, uiChannels, iBase, iStep);
+}
+
+static void alsa_dsp_deinterleave2(const float *pfIn, float *pfLeft,
+        float *pfRight, unsigned int uiFrames)
+{
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        pfLeft[i] = pfIn[2 * i];
+        pfRight[i] = pfIn[2 * i + 1];
+    }
+}
+
+static void alsa_dsp_interleave2(const float *pfLeft, const float *pfRight,
+        float *pfOut, unsigned int uiFrames)
+{
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        pfOut[2 * i] = pfLeft[i];
+        pfOut[2 * i + 1] = pfRight[i];
+    }
+}
+
+int alsa_dsp_scalar(AlsaDsp *psDsp)
+{
+    psDsp->pcName = "scalar";
+    psDsp->pfAddSatS16 = alsa_dsp_add_sat_s16;
+    psDsp->pfS16ToFloat = alsa_dsp_s16_to_float;
+    psDsp->pfFloatToS16 = alsa_dsp_float_to_s16;
+    psDsp->pfTpdf = alsa_dsp_tpdf;
+    psDsp->pfGainRamp = alsa_dsp_gain_ramp;
+    psDsp->pfDeinterleave2 = alsa_dsp_deinterleave2;
+    psDsp->pfInterleave2 = alsa_dsp_interleave2;
+    return 1;
+}
+
+/* Runs every kernel of psDsp and of the scalar table on the same data */
+static int alsa_dsp_matches(const AlsaDsp *psDsp, const AlsaDsp *psRef)
+{
+    unsigned int const n = ALSA_DSP_CHECK_SAMPLES;
+    static short asIn[ALSA_DSP_CHECK_SAMPLES + 1];
+    static short asA[ALSA_DSP_CHECK_SAMPLES + 1];
+    static short asB[ALSA_DSP_CHECK_SAMPLES + 1];
+    static float afIn[2 * ALSA_DSP_CHECK_SAMPLES];
+    static float afA[2 * ALSA_DSP_CHECK_SAMPLES];
+    static float afB[2 * ALSA_DSP_CHECK_SAMPLES];
+    static float afC[2 * ALSA_DSP_CHECK_SAMPLES];
+    unsigned int uiSeedA = 0x1234;
+    unsigned int uiSeedB = 0x1234;
+    unsigned int uiCh;
+
+    for (unsigned int i = 0; i < n + 1; ++i)
+    {
+        asIn[i] = static_cast<short>(alsa_dsp_hash(i));
+    }
+    for (unsigned int i = 0; i < 2 * n; ++i)
+    {
+        /* Past full scale at both ends to cover saturation */
+        afIn[i] = static_cast<float>(static_cast<int>(alsa_dsp_hash(i + n))) *
+            (1.2f / 2147483648.0f);
+    }
+
+    memcpy(asA, asIn + 1, n * sizeof(short));
+    memcpy(asB, asIn + 1, n * sizeof(short));
+    psDsp->pfAddSatS16(asA, asIn, n);
+    psRef->pfAddSatS16(asB, asIn, n);
+    if (0 != memcmp(asA, asB, n * sizeof(short)))
+    {
+        return 0;
+    }
+
+    psDsp->pfS16ToFloat(asIn, afA, n);
+    psRef->pfS16ToFloat(asIn, afB, n);
+    if (0 != memcmp(afA, afB, n * sizeof(float)))
+    {
+        return 0;
+    }
+
+    psDsp->pfFloatToS16(afIn, asA, n, &uiSeedA);
+    psRef->pfFloatToS16(afIn, asB, n, &uiSeedB);
+    if ((0 != memcmp(asA, asB, n * sizeof(short))) || (uiSeedA != uiSeedB))
+    {
+        return 0;
+    }
+
+    uiSeedA = uiSeedB = 0xFFFFFFF0U;
+    psDsp->pfTpdf(afA, n, &uiSeedA);
+    psRef->pfTpdf(afB, n, &uiSeedB);
+    if ((0 != memcmp(afA, afB, n * sizeof(float))) || (uiSeedA != uiSeedB))
+    {
+        return 0;
+    }
+
+    for (uiCh = 1; uiCh <= 3; ++uiCh)
+    {
+        memcpy(asA, asIn, n * sizeof(short));
+        memcpy(asB, asIn, n * sizeof(short));
+        psDsp->pfGainRamp(asA, n / uiCh, uiCh, 32768, 0);
+        psRef->pfGainRamp(asB, n / uiCh, uiCh, 32768, 0);
+        if (0 != memcmp(asA, asB, n * sizeof(short)))
+        {
+            return 0;
+        }
+        psDsp->pfGainRamp(asA, n / uiCh, uiCh, 0, 32768);
+        psRef->pfGainRamp(asB, n / uiCh, uiCh, 0, 32768);
+        if (0 != memcmp(asA, asB, n * sizeof(short)))
+        {
+            return 0;
+        }
+    }
+
+    psDsp->pfDeinterleave2(afIn, afA, afA + n, n);
+    psRef->pfDeinterleave2(afIn, afB, afB + n, n);
+    if (0 != memcmp(afA, afB, 2 * n * sizeof(float)))
+    {
+        return 0;
+    }
+    /* Interleaving the planes back must give the input again */
+    psDsp->pfInterleave2(afA, afA + n, afC, n);
+    if (0 != memcmp(afC, afIn, 2 * n * sizeof(float)))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+__attribute__((constructor))
+static void alsa_dsp_load(void)
+{
+    AlsaDsp sRef;
+    AlsaDsp sCand;
+    int (*const apfVariants[])(AlsaDsp *) =
+    {
+        alsa_dsp_avx2, alsa_dsp_sse2, alsa_dsp_neon
+    };
+
+    alsa_dsp_scalar(&sRef);
+    sAlsaDsp = sRef;
+    for (unsigned int i = 0; i < sizeof(apfVariants) / sizeof(apfVariants[0]); ++i)
+    {
+        sCand = sRef;
+        if (!apfVariants[i](&sCand))
+        {
+            continue;
+        }
+        if (!alsa_dsp_matches(&sCand, &sRef))
+        {
+            printf("ERR::AP::DSP kernels %s differ from scalar, not used\n",
+                    sCand.pcName);
+            continue;
+        }
+        sAlsaDsp = sCand;
+        break;
+    }
+}
+
+const AlsaDsp *alsa_dsp_get(void)
+{
+    return &sAlsaDsp;
+}
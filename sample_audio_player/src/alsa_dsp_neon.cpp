@@ -0,0 +1,246 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_dsp_neon.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   NEON variants of the DSP kernels, see alsa_dsp.cpp.
+ *
+ *   Built for ARMv7 and AArch64 NEON alike, except for the float to S16
+ *   conversion: ARMv7 NEON has no float to integer conversion rounding to
+ *   nearest even, which it needs to match the scalar kernel, so ARMv7 keeps
+ *   the scalar one.
+ *
+ ******************************************************************************/
+
+#include "alsa_dsp.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+static void alsa_dsp_add_sat_s16_neon(short *psDst, const short *psSrc,
+        unsigned int uiSamples)
+{
+    AlsaDsp sRef;
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        vst1q_s16(psDst + i, vqaddq_s16(vld1q_s16(psDst + i), vld1q_s16(psSrc + i)));
+    }
+    alsa_dsp_scalar(&sRef);
+    sRef.pfAddSatS16(psDst + i, psSrc + i, uiSamples - i);
+}
+
+static void alsa_dsp_s16_to_float_neon(const short *psIn, float *pfOut,
+        unsigned int uiSamples)
+{
+    AlsaDsp sRef;
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        int16x8_t s = vld1q_s16(psIn + i);
+
+        vst1q_f32(pfOut + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))),
+                    1.0f / 32768.0f));
+        vst1q_f32(pfOut + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))),
+                    1.0f / 32768.0f));
+    }
+    alsa_dsp_scalar(&sRef);
+    sRef.pfS16ToFloat(psIn + i, pfOut + i, uiSamples - i);
+}
+
+static inline float32x4_t alsa_dsp_dither_neon(uint32x4_t x)
+{
+    int32x4_t d;
+
+    x = veorq_u32(x, vshrq_n_u32(x, 16));
+    x = vmulq_u32(x, vdupq_n_u32(0x7feb352dU));
+    x = veorq_u32(x, vshrq_n_u32(x, 15));
+    x = vmulq_u32(x, vdupq_n_u32(0x846ca68bU));
+    x = veorq_u32(x, vshrq_n_u32(x, 16));
+    d = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(x, vdupq_n_u32(0xFFFF))),
+            vreinterpretq_s32_u32(vshrq_n_u32(x, 16)));
+    return vmulq_n_f32(vcvtq_f32_s32(d), 1.0f / 65536.0f);
+}
+
+static void alsa_dsp_tpdf_neon(float *pfOut, unsigned int uiSamples,
+        unsigned int *puiSeed)
+{
+    static const unsigned int auiLane[4] = { 0, 1, 2, 3 };
+    AlsaDsp sRef;
+    unsigned int uiSeed = *puiSeed;
+    uint32x4_t idx = vaddq_u32(vdupq_n_u32(uiSeed), vld1q_u32(auiLane));
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiSamples; i += 4)
+    {
+        vst1q_f32(pfOut + i, alsa_dsp_dither_neon(idx));
+        idx = vaddq_u32(idx, vdupq_n_u32(4));
+    }
+    uiSeed += i;
+    alsa_dsp_scalar(&sRef);
+    sRef.pfTpdf(pfOut + i, uiSamples - i, &uiSeed);
+    *puiSeed = uiSeed;
+}
+
+#if defined(__aarch64__)
+static inline int32x4_t alsa_dsp_f2s_quad_neon(const float *pfIn, uint32x4_t x)
+{
+    float32x4_t v;
+
+    /* Multiply then add, in two roundings like the scalar code */
+    v = vaddq_f32(vmulq_n_f32(vld1q_f32(pfIn), 32768.0f), alsa_dsp_dither_neon(x));
+    v = vminq_f32(v, vdupq_n_f32(32767.0f));
+    v = vmaxq_f32(v, vdupq_n_f32(-32768.0f));
+    return vcvtnq_s32_f32(v);
+}
+
+static void alsa_dsp_float_to_s16_neon(const float *pfIn, short *psOut,
+        unsigned int uiSamples, unsigned int *puiSeed)
+{
+    static const unsigned int auiLane[4] = { 0, 1, 2, 3 };
+    AlsaDsp sRef;
+    unsigned int uiSeed = *puiSeed;
+    uint32x4_t idx = vaddq_u32(vdupq_n_u32(uiSeed), vld1q_u32(auiLane));
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        int32x4_t lo = alsa_dsp_f2s_quad_neon(pfIn + i, idx);
+        int32x4_t hi = alsa_dsp_f2s_quad_neon(pfIn + i + 4,
+                vaddq_u32(idx, vdupq_n_u32(4)));
+
+        vst1q_s16(psOut + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+        idx = vaddq_u32(idx, vdupq_n_u32(8));
+    }
+    uiSeed += i;
+    alsa_dsp_scalar(&sRef);
+    sRef.pfFloatToS16(pfIn + i, psOut + i, uiSamples - i, &uiSeed);
+    *puiSeed = uiSeed;
+}
+#endif /* if defined(__aarch64__) */
+
+/* Four frame gains per step, widened to 32 bits for the multiply so that a
+ * unity gain of 32768 needs no special case. */
+static void alsa_dsp_gain_ramp_neon(short *psData, unsigned int uiFrames,
+        unsigned int uiChannels, int iFromQ15, int iToQ15)
+{
+    static const int aiLane[4] = { 1, 2, 3, 4 };
+    int iBase;
+    int iStep;
+    int32x4_t g;
+    int32x4_t inc;
+    unsigned int i = 0;
+
+    alsa_dsp_ramp_params(uiFrames, iFromQ15, iToQ15, &iBase, &iStep);
+    if ((1 != uiChannels) && (2 != uiChannels))
+    {
+        alsa_dsp_ramp_frames(psData, 0, uiFrames, uiChannels, iBase, iStep);
+        return;
+    }
+    g = vmlaq_n_s32(vdupq_n_s32(iBase), vld1q_s32(aiLane), iStep);
+    inc = vdupq_n_s32(4 * iStep);
+
+    for (; i + 4 <= uiFrames; i += 4)
+    {
+        int32x4_t q = vshrq_n_s32(g, 15);
+
+        if (1 == uiChannels)
+        {
+            int16x4_t s = vld1_s16(psData + i);
+
+            vst1_s16(psData + i, vmovn_s32(vshrq_n_s32(vmulq_s32(vmovl_s16(s), q), 15)));
+        }
+        else
+        {
+            int16x4x2_t s = vld2_s16(psData + 2 * i);
+
+            s.val[0] = vmovn_s32(vshrq_n_s32(vmulq_s32(vmovl_s16(s.val[0]), q), 15));
+            s.val[1] = vmovn_s32(vshrq_n_s32(vmulq_s32(vmovl_s16(s.val[1]), q), 15));
+            vst2_s16(psData + 2 * i, s);
+        }
+        g = vaddq_s32(g, inc);
+    }
+    alsa_dsp_ramp_frames(psData, i, uiFrames, uiChannels, iBase, iStep);
+}
+
+static void alsa_dsp_deinterleave2_neon(const float *pfIn, float *pfLeft,
+        float *pfRight, unsigned int uiFrames)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiFrames; i += 4)
+    {
+        float32x4x2_t v = vld2q_f32(pfIn + 2 * i);
+
+        vst1q_f32(pfLeft + i, v.val[0]);
+        vst1q_f32(pfRight + i, v.val[1]);
+    }
+    for (; i < uiFrames; ++i)
+    {
+        pfLeft[i] = pfIn[2 * i];
+        pfRight[i] = pfIn[2 * i + 1];
+    }
+}
+
+static void alsa_dsp_interleave2_neon(const float *pfLeft, const float *pfRight,
+        float *pfOut, unsigned int uiFrames)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiFrames; i += 4)
+    {
+        float32x4x2_t v;
+
+        v.val[0] = vld1q_f32(pfLeft + i);
+        v.val[1] = vld1q_f32(pfRight + i);
+        vst2q_f32(pfOut + 2 * i, v);
+    }
+    for (; i < uiFrames; ++i)
+    {
+        pfOut[2 * i] = pfLeft[i];
+        pfOut[2 * i + 1] = pfRight[i];
+    }
+}
+
+int alsa_dsp_neon(AlsaDsp *psDsp)
+{
+    psDsp->pcName = "neon";
+    psDsp->pfAddSatS16 = alsa_dsp_add_sat_s16_neon;
+    psDsp->pfS16ToFloat = alsa_dsp_s16_to_float_neon;
+#if defined(__aarch64__)
+    psDsp->pfFloatToS16 = alsa_dsp_float_to_s16_neon;
+#endif
+    psDsp->pfTpdf = alsa_dsp_tpdf_neon;
+    psDsp->pfGainRamp = alsa_dsp_gain_ramp_neon;
+    psDsp->pfDeinterleave2 = alsa_dsp_deinterleave2_neon;
+    psDsp->pfInterleave2 = alsa_dsp_interleave2_neon;
+    return 1;
+}
+
+#else
+
+int alsa_dsp_neon(AlsaDsp *psDsp)
+{
+    (void)psDsp;
+    return 0;
+}
+
+#endif /* if defined(__ARM_NEON) || defined(__ARM_NEON__) */
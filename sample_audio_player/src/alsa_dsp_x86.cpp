@@ -0,0 +1,411 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_dsp_x86.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   SSE2 and AVX2 variants of the DSP kernels, see alsa_dsp.cpp.
+ *
+ *   The AVX2 functions carry a target attribute, so the file builds with
+ *   the default flags and AVX2 code only runs once the CPU is known to
+ *   support it. A Q15 gain of 32768 does not fit a signed 16 bit lane: the
+ *   ramps multiply with the gain taken as unsigned, correcting the high half
+ *   of the signed product for the sign bit.
+ *
+ ******************************************************************************/
+
+#include "alsa_dsp.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#define ALSA_DSP_AVX2 __attribute__((target("avx2")))
+
+/* 32 bit multiply, low half, with SSE2 only */
+static inline __m128i alsa_dsp_mullo32(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i alsa_dsp_hash_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = alsa_dsp_mullo32(x, _mm_set1_epi32(0x7feb352d));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = alsa_dsp_mullo32(x, _mm_set1_epi32(static_cast<int>(0x846ca68bU)));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    return x;
+}
+
+/* (s * g) >> 15 for 0 <= g <= 32768 */
+static inline __m128i alsa_dsp_mulq15_sse2(__m128i s, __m128i g)
+{
+    __m128i lo = _mm_mullo_epi16(s, g);
+    __m128i hi = _mm_add_epi16(_mm_mulhi_epi16(s, g),
+            _mm_and_si128(s, _mm_srai_epi16(g, 15)));
+
+    return _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+}
+
+/* Eight 32 bit gains, each at most 32768, to 16 bit lanes */
+static inline __m128i alsa_dsp_pack_gain_sse2(__m128i g0, __m128i g1)
+{
+    __m128i const bias = _mm_set1_epi32(32768);
+
+    return _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(g0, bias),
+                _mm_sub_epi32(g1, bias)), _mm_set1_epi16(-32768));
+}
+
+static void alsa_dsp_add_sat_s16_sse2(short *psDst, const short *psSrc,
+        unsigned int uiSamples)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(psDst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(psSrc + i));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(psDst + i), _mm_adds_epi16(a, b));
+    }
+    for (; i < uiSamples; ++i)
+    {
+        int iSum = psDst[i] + psSrc[i];
+
+        psDst[i] = static_cast<short>((iSum > 32767) ? 32767 :
+                ((iSum < -32768) ? -32768 : iSum));
+    }
+}
+
+static void alsa_dsp_s16_to_float_sse2(const short *psIn, float *pfOut,
+        unsigned int uiSamples)
+{
+    __m128 const scale = _mm_set1_ps(1.0f / 32768.0f);
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(psIn + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+        _mm_storeu_ps(pfOut + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(pfOut + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i < uiSamples; ++i)
+    {
+        pfOut[i] = static_cast<float>(psIn[i]) * (1.0f / 32768.0f);
+    }
+}
+
+static inline __m128 alsa_dsp_dither_sse2(__m128i idx)
+{
+    __m128i h = alsa_dsp_hash_sse2(idx);
+    __m128i d = _mm_sub_epi32(_mm_and_si128(h, _mm_set1_epi32(0xFFFF)),
+            _mm_srli_epi32(h, 16));
+
+    return _mm_mul_ps(_mm_cvtepi32_ps(d), _mm_set1_ps(1.0f / 65536.0f));
+}
+
+static inline __m128i alsa_dsp_f2s_quad_sse2(const float *pfIn, __m128i idx)
+{
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pfIn), _mm_set1_ps(32768.0f)),
+            alsa_dsp_dither_sse2(idx));
+
+    v = _mm_min_ps(v, _mm_set1_ps(32767.0f));
+    v = _mm_max_ps(v, _mm_set1_ps(-32768.0f));
+    return _mm_cvtps_epi32(v);
+}
+
+static void alsa_dsp_float_to_s16_sse2(const float *pfIn, short *psOut,
+        unsigned int uiSamples, unsigned int *puiSeed)
+{
+    AlsaDsp sRef;
+    unsigned int uiSeed = *puiSeed;
+    __m128i idx = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(uiSeed)),
+            _mm_set_epi32(3, 2, 1, 0));
+    __m128i const four = _mm_set1_epi32(4);
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m128i lo = alsa_dsp_f2s_quad_sse2(pfIn + i, idx);
+        __m128i hi;
+
+        idx = _mm_add_epi32(idx, four);
+        hi = alsa_dsp_f2s_quad_sse2(pfIn + i + 4, idx);
+        idx = _mm_add_epi32(idx, four);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(psOut + i),
+                _mm_packs_epi32(lo, hi));
+    }
+    uiSeed += i;
+    alsa_dsp_scalar(&sRef);
+    sRef.pfFloatToS16(pfIn + i, psOut + i, uiSamples - i, &uiSeed);
+    *puiSeed = uiSeed;
+}
+
+static void alsa_dsp_tpdf_sse2(float *pfOut, unsigned int uiSamples,
+        unsigned int *puiSeed)
+{
+    AlsaDsp sRef;
+    unsigned int uiSeed = *puiSeed;
+    __m128i idx = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(uiSeed)),
+            _mm_set_epi32(3, 2, 1, 0));
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiSamples; i += 4)
+    {
+        _mm_storeu_ps(pfOut + i, alsa_dsp_dither_sse2(idx));
+        idx = _mm_add_epi32(idx, _mm_set1_epi32(4));
+    }
+    uiSeed += i;
+    alsa_dsp_scalar(&sRef);
+    sRef.pfTpdf(pfOut + i, uiSamples - i, &uiSeed);
+    *puiSeed = uiSeed;
+}
+
+/* Gains of the next eight samples: frame gains of one (mono) or four
+ * (stereo) frames per 32 bit lane group, stepped in integers. */
+static void alsa_dsp_gain_ramp_sse2(short *psData, unsigned int uiFrames,
+        unsigned int uiChannels, int iFromQ15, int iToQ15)
+{
+    unsigned int const uiSamples = uiFrames * uiChannels;
+    unsigned int const uiPerVec = 8 / ((1 == uiChannels) ? 1 : 2);
+    int iBase;
+    int iStep;
+    __m128i g0;
+    __m128i g1;
+    __m128i inc;
+    unsigned int i = 0;
+
+    alsa_dsp_ramp_params(uiFrames, iFromQ15, iToQ15, &iBase, &iStep);
+    if ((1 != uiChannels) && (2 != uiChannels))
+    {
+        alsa_dsp_ramp_frames(psData, 0, uiFrames, uiChannels, iBase, iStep);
+        return;
+    }
+    if (1 == uiChannels)
+    {
+        g0 = _mm_add_epi32(_mm_set1_epi32(iBase),
+                alsa_dsp_mullo32(_mm_set1_epi32(iStep), _mm_set_epi32(4, 3, 2, 1)));
+        g1 = _mm_add_epi32(g0, _mm_set1_epi32(4 * iStep));
+    }
+    else
+    {
+        g0 = _mm_add_epi32(_mm_set1_epi32(iBase),
+                alsa_dsp_mullo32(_mm_set1_epi32(iStep), _mm_set_epi32(2, 2, 1, 1)));
+        g1 = _mm_add_epi32(g0, _mm_set1_epi32(2 * iStep));
+    }
+    inc = _mm_set1_epi32(static_cast<int>(uiPerVec) * iStep);
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(psData + i));
+        __m128i g = alsa_dsp_pack_gain_sse2(_mm_srai_epi32(g0, 15),
+                _mm_srai_epi32(g1, 15));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(psData + i),
+                alsa_dsp_mulq15_sse2(s, g));
+        g0 = _mm_add_epi32(g0, inc);
+        g1 = _mm_add_epi32(g1, inc);
+    }
+    alsa_dsp_ramp_frames(psData, i / uiChannels, uiFrames, uiChannels, iBase, iStep);
+}
+
+static void alsa_dsp_deinterleave2_sse2(const float *pfIn, float *pfLeft,
+        float *pfRight, unsigned int uiFrames)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiFrames; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(pfIn + 2 * i);
+        __m128 b = _mm_loadu_ps(pfIn + 2 * i + 4);
+
+        _mm_storeu_ps(pfLeft + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(pfRight + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    for (; i < uiFrames; ++i)
+    {
+        pfLeft[i] = pfIn[2 * i];
+        pfRight[i] = pfIn[2 * i + 1];
+    }
+}
+
+static void alsa_dsp_interleave2_sse2(const float *pfLeft, const float *pfRight,
+        float *pfOut, unsigned int uiFrames)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= uiFrames; i += 4)
+    {
+        __m128 l = _mm_loadu_ps(pfLeft + i);
+        __m128 r = _mm_loadu_ps(pfRight + i);
+
+        _mm_storeu_ps(pfOut + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(pfOut + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+    for (; i < uiFrames; ++i)
+    {
+        pfOut[2 * i] = pfLeft[i];
+        pfOut[2 * i + 1] = pfRight[i];
+    }
+}
+
+ALSA_DSP_AVX2
+static void alsa_dsp_add_sat_s16_avx2(short *psDst, const short *psSrc,
+        unsigned int uiSamples)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= uiSamples; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(psDst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(psSrc + i));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(psDst + i),
+                _mm256_adds_epi16(a, b));
+    }
+    alsa_dsp_add_sat_s16_sse2(psDst + i, psSrc + i, uiSamples - i);
+}
+
+ALSA_DSP_AVX2
+static void alsa_dsp_s16_to_float_avx2(const short *psIn, float *pfOut,
+        unsigned int uiSamples)
+{
+    __m256 const scale = _mm256_set1_ps(1.0f / 32768.0f);
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m256i s = _mm256_cvtepi16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(psIn + i)));
+
+        _mm256_storeu_ps(pfOut + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+    }
+    alsa_dsp_s16_to_float_sse2(psIn + i, pfOut + i, uiSamples - i);
+}
+
+ALSA_DSP_AVX2
+static inline __m256 alsa_dsp_dither_avx2(__m256i h)
+{
+    __m256i d;
+
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(0x7feb352d));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x846ca68bU)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    d = _mm256_sub_epi32(_mm256_and_si256(h, _mm256_set1_epi32(0xFFFF)),
+            _mm256_srli_epi32(h, 16));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(d), _mm256_set1_ps(1.0f / 65536.0f));
+}
+
+ALSA_DSP_AVX2
+static void alsa_dsp_tpdf_avx2(float *pfOut, unsigned int uiSamples,
+        unsigned int *puiSeed)
+{
+    __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(*puiSeed)),
+            _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        _mm256_storeu_ps(pfOut + i, alsa_dsp_dither_avx2(idx));
+        idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+    }
+    *puiSeed += i;
+    alsa_dsp_tpdf_sse2(pfOut + i, uiSamples - i, puiSeed);
+}
+
+ALSA_DSP_AVX2
+static void alsa_dsp_float_to_s16_avx2(const float *pfIn, short *psOut,
+        unsigned int uiSamples, unsigned int *puiSeed)
+{
+    __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(*puiSeed)),
+            _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    unsigned int i = 0;
+
+    for (; i + 8 <= uiSamples; i += 8)
+    {
+        __m256 v;
+        __m256i q;
+
+        v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(pfIn + i),
+                    _mm256_set1_ps(32768.0f)), alsa_dsp_dither_avx2(idx));
+        v = _mm256_min_ps(v, _mm256_set1_ps(32767.0f));
+        v = _mm256_max_ps(v, _mm256_set1_ps(-32768.0f));
+        q = _mm256_cvtps_epi32(v);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(psOut + i),
+                _mm_packs_epi32(_mm256_castsi256_si128(q),
+                    _mm256_extracti128_si256(q, 1)));
+        idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+    }
+    *puiSeed += i;
+    alsa_dsp_float_to_s16_sse2(pfIn + i, psOut + i, uiSamples - i, puiSeed);
+}
+
+int alsa_dsp_sse2(AlsaDsp *psDsp)
+{
+    psDsp->pcName = "sse2";
+    psDsp->pfAddSatS16 = alsa_dsp_add_sat_s16_sse2;
+    psDsp->pfS16ToFloat = alsa_dsp_s16_to_float_sse2;
+    psDsp->pfFloatToS16 = alsa_dsp_float_to_s16_sse2;
+    psDsp->pfTpdf = alsa_dsp_tpdf_sse2;
+    psDsp->pfGainRamp = alsa_dsp_gain_ramp_sse2;
+    psDsp->pfDeinterleave2 = alsa_dsp_deinterleave2_sse2;
+    psDsp->pfInterleave2 = alsa_dsp_interleave2_sse2;
+    return __builtin_cpu_supports("sse2") ? 1 : 0;
+}
+
+/* Builds on the SSE2 table, the ramps and plane copies gain little more */
+int alsa_dsp_avx2(AlsaDsp *psDsp)
+{
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        return 0;
+    }
+    alsa_dsp_sse2(psDsp);
+    psDsp->pcName = "avx2";
+    psDsp->pfAddSatS16 = alsa_dsp_add_sat_s16_avx2;
+    psDsp->pfS16ToFloat = alsa_dsp_s16_to_float_avx2;
+    psDsp->pfFloatToS16 = alsa_dsp_float_to_s16_avx2;
+    psDsp->pfTpdf = alsa_dsp_tpdf_avx2;
+    return 1;
+}
+
+#else
+
+int alsa_dsp_sse2(AlsaDsp *psDsp)
+{
+    (void)psDsp;
+    return 0;
+}
+
+int alsa_dsp_avx2(AlsaDsp *psDsp)
+{
+    (void)psDsp;
+    return 0;
+}
+
+#endif /* if defined(__x86_64__) || defined(__i386__) */
@@ -0,0 +1,347 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_eq.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Parametric EQ of the ALSA core player.
+ *
+ *   Each band is a biquad section designed with the RBJ audio EQ cookbook
+ *   formulas. The sections are cascaded on the processing bus, one section
+ *   at a time over the whole period, so that its coefficients and state
+ *   stay in registers. In float the channels of a frame run side by side in
+ *   the lanes of a 4 wide vector (transposed direct form II); states that
+ *   have decayed to almost nothing are flushed to zero at the end of every
+ *   period so they never become denormal. In fixed point each channel runs
+ *   a direct form I section with Q27 coefficients and a 64 bit sum.
+ *
+ *   Bands are designed on the application's thread. The render thread takes
+ *   a new set over at the start of a period, unless the application is
+ *   still writing it, in which case it tries again on the next one.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <sched.h>
+
+#include "alsa_eq.h"
+#include "aap_error_codes.h"
+
+/* Largest boost or cut of a band, in dB */
+#define ALSA_EQ_MAX_GAIN_DB 24.0f
+/* Float state below this is flushed to zero, about -400 dBFS */
+#define ALSA_EQ_DENORMAL_FLUSH 1e-20f
+
+#if !ALSA_FIXED_POINT
+/* Channels processed side by side */
+#define ALSA_EQ_LANES 4
+typedef float AlsaEqVec __attribute__((vector_size(ALSA_EQ_LANES * sizeof(float))));
+#endif
+
+int alsa_eq_init(AlsaEq *psEq, unsigned int uiChannels, unsigned int uiRate)
+{
+    if ((NULL == psEq) || (0 == uiChannels) ||
+            (ALSA_BUS_MAX_CHANNELS < uiChannels) || (0 == uiRate))
+    {
+        printf("ERR::AP::Invalid EQ parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psEq, 0x0, sizeof(AlsaEq));
+    psEq->uiChannels = uiChannels;
+    psEq->uiRate = uiRate;
+    return 0;
+}
+
+/* RBJ cookbook biquad of one band, normalized to a0 = 1 */
+static int alsa_eq_design(const AAPPlayerEqBand *psBand, unsigned int uiRate,
+        double *pdB, double *pdA)
+{
+    double const dW0 = 2.0 * M_PI * psBand->fFreqHz / uiRate;
+    double const dCos = cos(dW0);
+    double const dAlpha = sin(dW0) / (2.0 * psBand->fQ);
+    double const dGain = pow(10.0, psBand->fGainDb / 40.0);
+    double const dShelf = 2.0 * sqrt(dGain) * dAlpha;
+    double dA0;
+
+    if (!(psBand->fFreqHz > 0.0f) || !(psBand->fFreqHz < 0.5f * uiRate) ||
+            !(psBand->fQ > 0.0f) || !(fabsf(psBand->fGainDb) <= ALSA_EQ_MAX_GAIN_DB))
+    {
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    switch (psBand->eType)
+    {
+        case E_AAP_EQ_PEAKING:
+            pdB[0] = 1.0 + dAlpha * dGain;
+            pdB[1] = -2.0 * dCos;
+            pdB[2] = 1.0 - dAlpha * dGain;
+            dA0 = 1.0 + dAlpha / dGain;
+            pdA[0] = -2.0 * dCos;
+            pdA[1] = 1.0 - dAlpha / dGain;
+            break;
+        case E_AAP_EQ_LOW_SHELF:
+            pdB[0] = dGain * ((dGain + 1.0) - (dGain - 1.0) * dCos + dShelf);
+            pdB[1] = 2.0 * dGain * ((dGain - 1.0) - (dGain + 1.0) * dCos);
+            pdB[2] = dGain * ((dGain + 1.0) - (dGain - 1.0) * dCos - dShelf);
+            dA0 = (dGain + 1.0) + (dGain - 1.0) * dCos + dShelf;
+            pdA[0] = -2.0 * ((dGain - 1.0) + (dGain + 1.0) * dCos);
+            pdA[1] = (dGain + 1.0) + (dGain - 1.0) * dCos - dShelf;
+            break;
+        case E_AAP_EQ_HIGH_SHELF:
+            pdB[0] = dGain * ((dGain + 1.0) + (dGain - 1.0) * dCos + dShelf);
+            pdB[1] = -2.0 * dGain * ((dGain - 1.0) + (dGain + 1.0) * dCos);
+            pdB[2] = dGain * ((dGain + 1.0) + (dGain - 1.0) * dCos - dShelf);
+            dA0 = (dGain + 1.0) - (dGain - 1.0) * dCos + dShelf;
+            pdA[0] = 2.0 * ((dGain - 1.0) - (dGain + 1.0) * dCos);
+            pdA[1] = (dGain + 1.0) - (dGain - 1.0) * dCos - dShelf;
+            break;
+        case E_AAP_EQ_LOW_PASS:
+            pdB[0] = (1.0 - dCos) / 2.0;
+            pdB[1] = 1.0 - dCos;
+            pdB[2] = (1.0 - dCos) / 2.0;
+            dA0 = 1.0 + dAlpha;
+            pdA[0] = -2.0 * dCos;
+            pdA[1] = 1.0 - dAlpha;
+            break;
+        case E_AAP_EQ_HIGH_PASS:
+            pdB[0] = (1.0 + dCos) / 2.0;
+            pdB[1] = -(1.0 + dCos);
+            pdB[2] = (1.0 + dCos) / 2.0;
+            dA0 = 1.0 + dAlpha;
+            pdA[0] = -2.0 * dCos;
+            pdA[1] = 1.0 - dAlpha;
+            break;
+        default:
+            return AAP_ERR_INVALID_PARAMS;
+    }
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        pdB[i] /= dA0;
+        if (fabs(pdB[i]) > ALSA_EQ_MAX_COEF)
+        {
+            return AAP_ERR_INVALID_PARAMS;
+        }
+    }
+    pdA[0] /= dA0;
+    pdA[1] /= dA0;
+    return 0;
+}
+
+static void alsa_eq_quantize(const double *pdB, const double *pdA, AlsaEqCoef *psCoef)
+{
+#if ALSA_FIXED_POINT
+    double const dScale = static_cast<double>(1 << ALSA_EQ_COEF_BITS);
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        psCoef->aiB[i] = static_cast<int>(lrint(pdB[i] * dScale));
+    }
+    psCoef->aiA[0] = static_cast<int>(lrint(pdA[0] * dScale));
+    psCoef->aiA[1] = static_cast<int>(lrint(pdA[1] * dScale));
+#else
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        psCoef->afB[i] = static_cast<float>(pdB[i]);
+    }
+    psCoef->afA[0] = static_cast<float>(pdA[0]);
+    psCoef->afA[1] = static_cast<float>(pdA[1]);
+#endif
+}
+
+/* Designs the bands and hands them to the render thread. No bands turns
+ * the EQ off. */
+int alsa_eq_set(AlsaEq *psEq, const AAPPlayerEqBand *pasBands, unsigned int uiBands)
+{
+    AlsaEqSet sSet;
+    double adB[3];
+    double adA[2];
+
+    if ((ALSA_EQ_MAX_BANDS < uiBands) || ((0 != uiBands) && (NULL == pasBands)))
+    {
+        printf("ERR::AP::Invalid EQ band count %u\n", uiBands);
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(&sSet, 0x0, sizeof(sSet));
+    for (unsigned int i = 0; i < uiBands; ++i)
+    {
+        if (0 != alsa_eq_design(&pasBands[i], psEq->uiRate, adB, adA))
+        {
+            printf("ERR::AP::EQ band %u out of range\n", i);
+            return AAP_ERR_INVALID_PARAMS;
+        }
+        alsa_eq_quantize(adB, adA, &sSet.asCoef[i]);
+    }
+    sSet.uiBands = uiBands;
+
+    /* The render thread only holds the lock for a copy of the set */
+    while (__sync_lock_test_and_set(&psEq->iPendingLock, 1))
+    {
+        sched_yield();
+    }
+    psEq->sPending = sSet;
+    psEq->bPending = AAP_TRUE;
+    __sync_lock_release(&psEq->iPendingLock);
+    return 0;
+}
+
+static void alsa_eq_take_pending(AlsaEq *psEq)
+{
+    if (!psEq->bPending || __sync_lock_test_and_set(&psEq->iPendingLock, 1))
+    {
+        return;
+    }
+    /* Sections that were not running start from silence */
+    for (unsigned int i = psEq->sActive.uiBands; i < ALSA_EQ_MAX_BANDS; ++i)
+    {
+#if ALSA_FIXED_POINT
+        memset(psEq->aiState[i], 0x0, sizeof(psEq->aiState[i]));
+#else
+        memset(psEq->afState[i], 0x0, sizeof(psEq->afState[i]));
+#endif
+    }
+    psEq->sActive = psEq->sPending;
+    psEq->bPending = AAP_FALSE;
+    __sync_lock_release(&psEq->iPendingLock);
+}
+
+#if ALSA_FIXED_POINT
+static void alsa_eq_section(AlsaEq *psEq, unsigned int uiBand,
+        AlsaBusSample *ptBus, unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psEq->uiChannels;
+    const AlsaEqCoef *psCoef = &psEq->sActive.asCoef[uiBand];
+    int (*paiState)[ALSA_BUS_MAX_CHANNELS] = psEq->aiState[uiBand];
+
+    for (unsigned int c = 0; c < uiChannels; ++c)
+    {
+        int iX1 = paiState[0][c];
+        int iX2 = paiState[1][c];
+        int iY1 = paiState[2][c];
+        int iY2 = paiState[3][c];
+        int *piBus = ptBus + c;
+
+        for (unsigned int i = 0; i < uiFrames; ++i)
+        {
+            int iX = *piBus;
+            int64_t llSum = static_cast<int64_t>(psCoef->aiB[0]) * iX +
+                static_cast<int64_t>(psCoef->aiB[1]) * iX1 +
+                static_cast<int64_t>(psCoef->aiB[2]) * iX2 -
+                static_cast<int64_t>(psCoef->aiA[0]) * iY1 -
+                static_cast<int64_t>(psCoef->aiA[1]) * iY2;
+            int64_t llY = (llSum + (1LL << (ALSA_EQ_COEF_BITS - 1))) >> ALSA_EQ_COEF_BITS;
+
+            llY = (llY > INT32_MAX) ? INT32_MAX : ((llY < INT32_MIN) ? INT32_MIN : llY);
+            iX2 = iX1;
+            iX1 = iX;
+            iY2 = iY1;
+            iY1 = static_cast<int>(llY);
+            *piBus = iY1;
+            piBus += uiChannels;
+        }
+        paiState[0][c] = iX1;
+        paiState[1][c] = iX2;
+        paiState[2][c] = iY1;
+        paiState[3][c] = iY2;
+    }
+}
+#else
+/* Runs section uiBand over the channels [uiFirst, uiFirst + uiLanes) of the
+ * bus. L is the lane count when fixed at compile time, 0 otherwise. */
+template <unsigned int L>
+static void alsa_eq_section(AlsaEq *psEq, unsigned int uiBand,
+        AlsaBusSample *ptBus, unsigned int uiFrames,
+        unsigned int uiFirst, unsigned int uiLanes)
+{
+    unsigned int const uiChannels = psEq->uiChannels;
+    unsigned int const uiL = (0 != L) ? L : uiLanes;
+    const AlsaEqCoef *psCoef = &psEq->sActive.asCoef[uiBand];
+    float *pfZ1 = psEq->afState[uiBand][0] + uiFirst;
+    float *pfZ2 = psEq->afState[uiBand][1] + uiFirst;
+    float *pfBus = ptBus + uiFirst;
+    AlsaEqVec const b0 = { psCoef->afB[0], psCoef->afB[0], psCoef->afB[0], psCoef->afB[0] };
+    AlsaEqVec const b1 = { psCoef->afB[1], psCoef->afB[1], psCoef->afB[1], psCoef->afB[1] };
+    AlsaEqVec const b2 = { psCoef->afB[2], psCoef->afB[2], psCoef->afB[2], psCoef->afB[2] };
+    AlsaEqVec const a1 = { psCoef->afA[0], psCoef->afA[0], psCoef->afA[0], psCoef->afA[0] };
+    AlsaEqVec const a2 = { psCoef->afA[1], psCoef->afA[1], psCoef->afA[1], psCoef->afA[1] };
+    AlsaEqVec z1 = { 0.0f, 0.0f, 0.0f, 0.0f };
+    AlsaEqVec z2 = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for (unsigned int l = 0; l < uiL; ++l)
+    {
+        z1[l] = pfZ1[l];
+        z2[l] = pfZ2[l];
+    }
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        AlsaEqVec x = { 0.0f, 0.0f, 0.0f, 0.0f };
+        AlsaEqVec y;
+
+        for (unsigned int l = 0; l < uiL; ++l)
+        {
+            x[l] = pfBus[l];
+        }
+        y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        for (unsigned int l = 0; l < uiL; ++l)
+        {
+            pfBus[l] = y[l];
+        }
+        pfBus += uiChannels;
+    }
+    for (unsigned int l = 0; l < uiL; ++l)
+    {
+        pfZ1[l] = (fabsf(z1[l]) < ALSA_EQ_DENORMAL_FLUSH) ? 0.0f : z1[l];
+        pfZ2[l] = (fabsf(z2[l]) < ALSA_EQ_DENORMAL_FLUSH) ? 0.0f : z2[l];
+    }
+}
+#endif /* if ALSA_FIXED_POINT */
+
+void alsa_eq_process(void *pvEq, AlsaBusSample *ptBus, unsigned int uiFrames)
+{
+    AlsaEq *psEq = static_cast<AlsaEq *>(pvEq);
+
+    alsa_eq_take_pending(psEq);
+    for (unsigned int b = 0; b < psEq->sActive.uiBands; ++b)
+    {
+#if ALSA_FIXED_POINT
+        alsa_eq_section(psEq, b, ptBus, uiFrames);
+#else
+        if (2 == psEq->uiChannels)
+        {
+            alsa_eq_section<2>(psEq, b, ptBus, uiFrames, 0, 2);
+            continue;
+        }
+        for (unsigned int c = 0; c < psEq->uiChannels; c += ALSA_EQ_LANES)
+        {
+            unsigned int uiLanes = psEq->uiChannels - c;
+
+            alsa_eq_section<0>(psEq, b, ptBus, uiFrames, c,
+                    (uiLanes > ALSA_EQ_LANES) ? ALSA_EQ_LANES : uiLanes);
+        }
+#endif
+    }
+}
+
+AAP_BOOL alsa_eq_active(void *pvEq)
+{
+    AlsaEq *psEq = static_cast<AlsaEq *>(pvEq);
+
+    return ((0 != psEq->sActive.uiBands) || psEq->bPending) ? AAP_TRUE : AAP_FALSE;
+}
@@ -0,0 +1,279 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_kernels.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Per sample processing of the ALSA core player.
+ *
+ *   Every kernel is a template on the channel count, and the import kernel
+ *   on the input sample type as well. The common layouts - S16 mono and
+ *   stereo, S32 stereo and float stereo - are instantiated with the count
+ *   fixed, so inner loops have constant strides the compiler can unroll and
+ *   vectorize. Any other layout uses the instantiation for channel count 0,
+ *   which reads it at run time. The sample rate does not change any stride
+ *   and is not specialized on. The gain ramp is taken from the dispatched
+ *   SIMD kernels of alsa_dsp.cpp instead.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "alsa_kernels.h"
+#include "alsa_dsp.h"
+#include "aap_error_codes.h"
+
+/* Channel count of a kernel: the template argument, or the run time value
+ * for the generic instantiation. */
+template <unsigned int N>
+static inline unsigned int alsa_kernels_ch(unsigned int uiChannels)
+{
+    return (0 != N) ? N : uiChannels;
+}
+
+static inline short alsa_kernels_sat16(int iVal)
+{
+    if (iVal > 32767)
+    {
+        return 32767;
+    }
+    if (iVal < -32768)
+    {
+        return -32768;
+    }
+    return static_cast<short>(iVal);
+}
+
+/* Input sample to S16 */
+static inline short alsa_kernels_to_s16(int iSample)
+{
+    /* Round to nearest, S32 full scale maps onto S16 full scale */
+    return alsa_kernels_sat16((iSample >> 16) + ((iSample >> 15) & 1));
+}
+
+static inline short alsa_kernels_to_s16(float fSample)
+{
+    float fVal = fSample * 32768.0f;
+
+    fVal += (fVal >= 0.0f) ? 0.5f : -0.5f;
+    if (fVal > 32767.0f)
+    {
+        return 32767;
+    }
+    if (fVal < -32768.0f)
+    {
+        return -32768;
+    }
+    return static_cast<short>(fVal);
+}
+
+template <typename T, unsigned int N>
+static void alsa_kernels_import(const void *pvIn, short *psOut,
+        unsigned int uiFrames, unsigned int uiChannels)
+{
+    unsigned int const uiSamples = uiFrames * alsa_kernels_ch<N>(uiChannels);
+    const T *ptIn = static_cast<const T *>(pvIn);
+
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        psOut[i] = alsa_kernels_to_s16(ptIn[i]);
+    }
+}
+
+/* Position p interpolates between stage[p] and stage[p + 1] using
+ * stage[p - 1] and stage[p + 2]. */
+#if ALSA_FIXED_POINT
+/* The phase runs in 32.32 fixed point, the fraction t in Q15 and the
+ * weights in Q16, summed in 64 bits. */
+template <unsigned int N>
+static unsigned int alsa_kernels_resample(const short *psStage, short *psOut,
+        unsigned int uiChannels, double *pdPhase, double dStep, double dEnd)
+{
+    unsigned int const uiCh = alsa_kernels_ch<N>(uiChannels);
+    uint64_t ullPhase = static_cast<uint64_t>(*pdPhase * 4294967296.0);
+    uint64_t const ullStep = static_cast<uint64_t>(dStep * 4294967296.0);
+    uint64_t const ullEnd = static_cast<uint64_t>(dEnd * 4294967296.0);
+    unsigned int uiOutFrames = 0;
+
+    while (ullPhase < ullEnd)
+    {
+        unsigned int uiIdx = static_cast<unsigned int>(ullPhase >> 32);
+        int t = static_cast<int>((ullPhase >> 17) & 0x7FFF);
+        int t2 = (t * t + (1 << 14)) >> 15;
+        int t3 = (t2 * t + (1 << 14)) >> 15;
+        int c0 = -t3 + 2 * t2 - t;
+        int c1 = 3 * t3 - 5 * t2 + 65536;
+        int c2 = -3 * t3 + 4 * t2 + t;
+        int c3 = t3 - t2;
+        const short *psX = psStage + (uiIdx - 1) * uiCh;
+
+        for (unsigned int c = 0; c < uiCh; ++c)
+        {
+            int64_t llVal = static_cast<int64_t>(c0) * psX[c] +
+                static_cast<int64_t>(c1) * psX[uiCh + c] +
+                static_cast<int64_t>(c2) * psX[2 * uiCh + c] +
+                static_cast<int64_t>(c3) * psX[3 * uiCh + c];
+            psOut[c] = alsa_kernels_sat16(static_cast<int>((llVal + (1 << 15)) >> 16));
+        }
+        psOut += uiCh;
+        ullPhase += ullStep;
+        ++uiOutFrames;
+    }
+    *pdPhase = static_cast<double>(ullPhase) * (1.0 / 4294967296.0);
+    return uiOutFrames;
+}
+#else
+template <unsigned int N>
+static unsigned int alsa_kernels_resample(const short *psStage, short *psOut,
+        unsigned int uiChannels, double *pdPhase, double dStep, double dEnd)
+{
+    unsigned int const uiCh = alsa_kernels_ch<N>(uiChannels);
+    double dPhase = *pdPhase;
+    unsigned int uiOutFrames = 0;
+
+    while (dPhase < dEnd)
+    {
+        unsigned int uiIdx = static_cast<unsigned int>(dPhase);
+        float t = static_cast<float>(dPhase - uiIdx);
+        float t2 = t * t;
+        float t3 = t2 * t;
+        float c0 = -0.5f * t3 + t2 - 0.5f * t;
+        float c1 = 1.5f * t3 - 2.5f * t2 + 1.0f;
+        float c2 = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+        float c3 = 0.5f * t3 - 0.5f * t2;
+        const short *psX = psStage + (uiIdx - 1) * uiCh;
+
+        for (unsigned int c = 0; c < uiCh; ++c)
+        {
+            float fVal = c0 * psX[c] + c1 * psX[uiCh + c] +
+                c2 * psX[2 * uiCh + c] + c3 * psX[3 * uiCh + c];
+            fVal += (fVal >= 0.0f) ? 0.5f : -0.5f;
+            if (fVal > 32767.0f)
+            {
+                fVal = 32767.0f;
+            }
+            else if (fVal < -32768.0f)
+            {
+                fVal = -32768.0f;
+            }
+            psOut[c] = static_cast<short>(fVal);
+        }
+        psOut += uiCh;
+        dPhase += dStep;
+        ++uiOutFrames;
+    }
+    *pdPhase = dPhase;
+    return uiOutFrames;
+}
+#endif /* if ALSA_FIXED_POINT */
+
+static void alsa_kernels_export_s32(const short *psIn, void *pvOut,
+        unsigned int uiSamples)
+{
+    int *piOut = static_cast<int *>(pvOut);
+
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        piOut[i] = static_cast<int>(psIn[i]) * 65536;
+    }
+}
+
+static void alsa_kernels_export_float(const short *psIn, void *pvOut,
+        unsigned int uiSamples)
+{
+    float *pfOut = static_cast<float *>(pvOut);
+
+    for (unsigned int i = 0; i < uiSamples; ++i)
+    {
+        pfOut[i] = static_cast<float>(psIn[i]) * (1.0f / 32768.0f);
+    }
+}
+
+template <unsigned int N>
+static void alsa_kernels_fill(AlsaKernels *psKernels)
+{
+    psKernels->pfResample = alsa_kernels_resample<N>;
+}
+
+int alsa_kernels_select(AlsaKernels *psKernels, AlsaSampleFormat eFormat,
+        unsigned int uiChannels)
+{
+    if ((NULL == psKernels) || (0 == uiChannels))
+    {
+        printf("ERR::AP::Invalid kernel parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psKernels, 0x0, sizeof(AlsaKernels));
+    switch (uiChannels)
+    {
+        case 1:
+            alsa_kernels_fill<1>(psKernels);
+            break;
+        case 2:
+            alsa_kernels_fill<2>(psKernels);
+            break;
+        default:
+            alsa_kernels_fill<0>(psKernels);
+            break;
+    }
+    /* Gain ramps are plain sample loops, they come from the SIMD library */
+    psKernels->pfRamp = alsa_dsp_get()->pfGainRamp;
+    switch (eFormat)
+    {
+        case ALSA_SAMPLE_S16:
+            /* Taken as is */
+            psKernels->pfImport = NULL;
+            psKernels->uiInFrameBytes = uiChannels * sizeof(short);
+            psKernels->pcName = (1 == uiChannels) ? "S16 mono" :
+                ((2 == uiChannels) ? "S16 stereo" : "S16 generic");
+            break;
+        case ALSA_SAMPLE_S32:
+            psKernels->pfImport = (2 == uiChannels) ?
+                alsa_kernels_import<int, 2> : alsa_kernels_import<int, 0>;
+            psKernels->uiInFrameBytes = uiChannels * sizeof(int);
+            psKernels->pcName = (2 == uiChannels) ? "S32 stereo" : "S32 generic";
+            break;
+        case ALSA_SAMPLE_FLOAT:
+            psKernels->pfImport = (2 == uiChannels) ?
+                alsa_kernels_import<float, 2> : alsa_kernels_import<float, 0>;
+            psKernels->uiInFrameBytes = uiChannels * sizeof(float);
+            psKernels->pcName = (2 == uiChannels) ? "float stereo" : "float generic";
+            break;
+        default:
+            printf("ERR::AP::Unsupported sample format %d\n", eFormat);
+            return AAP_ERR_INVALID_PARAMS;
+    }
+    psKernels->eFormat = eFormat;
+    psKernels->uiChannels = uiChannels;
+    return 0;
+}
+
+/* Output conversion for a device that does not take S16, NULL for S16 */
+AlsaExportFunc alsa_kernels_export(AlsaSampleFormat eFormat)
+{
+    switch (eFormat)
+    {
+        case ALSA_SAMPLE_S32:
+            return alsa_kernels_export_s32;
+        case ALSA_SAMPLE_FLOAT:
+            return alsa_kernels_export_float;
+        default:
+            return NULL;
+    }
+}
@@ -0,0 +1,295 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_limiter.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Look-ahead peak limiter of the ALSA core player.
+ *
+ *   The signal is delayed by the look-ahead of L frames. For every frame the
+ *   gain that would bring its peak, over all channels, down to the ceiling
+ *   is worked out. The minimum of that gain over the last L + 1 frames is
+ *   tracked with a monotonic deque, so the hold costs O(1) per frame
+ *   however long the look-ahead. The held gain recovers with an exponential
+ *   release and is then averaged over L frames: the gain ramps down
+ *   linearly over the look-ahead and reaches the required value exactly
+ *   when the peak leaves the delay line, so the output never exceeds the
+ *   ceiling.
+ *
+ *   The gain path is Q30 integer in both builds, which keeps the running
+ *   sum of the average exact; only the peak detection and the final
+ *   multiply use the bus format.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "alsa_limiter.h"
+#include "aap_error_codes.h"
+
+/* Lowest ceiling accepted, in dBFS */
+#define ALSA_LIMITER_MIN_CEILING_DB -24.0f
+
+int alsa_limiter_init(AlsaLimiter *psLimiter, unsigned int uiChannels,
+        unsigned int uiRate)
+{
+    unsigned int uiLookahead;
+
+    if ((NULL == psLimiter) || (0 == uiChannels) ||
+            (ALSA_BUS_MAX_CHANNELS < uiChannels) || (0 == uiRate))
+    {
+        printf("ERR::AP::Invalid limiter parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psLimiter, 0x0, sizeof(AlsaLimiter));
+    uiLookahead = static_cast<unsigned int>(
+            (static_cast<unsigned long long>(uiRate) * ALSA_LIMITER_LOOKAHEAD_US) / 1000000);
+    uiLookahead = (0 == uiLookahead) ? 1 : uiLookahead;
+
+    psLimiter->ptDelay = static_cast<AlsaBusSample *>(
+            malloc(uiLookahead * uiChannels * sizeof(AlsaBusSample)));
+    psLimiter->puiDequeAt = static_cast<unsigned int *>(
+            malloc((uiLookahead + 1) * sizeof(unsigned int)));
+    psLimiter->piDequeGain = static_cast<int *>(malloc((uiLookahead + 1) * sizeof(int)));
+    psLimiter->piBox = static_cast<int *>(malloc(uiLookahead * sizeof(int)));
+    if ((NULL == psLimiter->ptDelay) || (NULL == psLimiter->puiDequeAt) ||
+            (NULL == psLimiter->piDequeGain) || (NULL == psLimiter->piBox))
+    {
+        printf("ERR::AP::Limiter allocation failed!\n");
+        alsa_limiter_deinit(psLimiter);
+        return AAP_ERR_OUT_OF_MEM;
+    }
+    psLimiter->uiChannels = uiChannels;
+    psLimiter->uiLookahead = uiLookahead;
+    psLimiter->iRelease = static_cast<int>(
+            (1.0 - exp(-1000.0 / (ALSA_LIMITER_RELEASE_MS * static_cast<double>(uiRate)))) *
+            (1 << 24));
+    psLimiter->iRelease = (0 == psLimiter->iRelease) ? 1 : psLimiter->iRelease;
+    psLimiter->iGain = ALSA_LIMITER_UNITY;
+    psLimiter->iMinGain = ALSA_LIMITER_UNITY;
+    alsa_limiter_set(psLimiter, AAP_FALSE, 0.0f);
+    return 0;
+}
+
+/* Ceiling in dBFS, from ALSA_LIMITER_MIN_CEILING_DB up to 0 */
+void alsa_limiter_set(AlsaLimiter *psLimiter, AAP_BOOL bEnable, float fCeilingDb)
+{
+    float fCeiling;
+
+    fCeilingDb = (fCeilingDb > 0.0f) ? 0.0f : fCeilingDb;
+    fCeilingDb = (fCeilingDb < ALSA_LIMITER_MIN_CEILING_DB) ?
+        ALSA_LIMITER_MIN_CEILING_DB : fCeilingDb;
+    /* Just below full scale, so that requantizing cannot round over it */
+    fCeiling = powf(10.0f, fCeilingDb / 20.0f) * (32767.0f / 32768.0f);
+#if ALSA_FIXED_POINT
+    psLimiter->tCeiling = static_cast<int>(fCeiling * (1 << ALSA_BUS_FRAC_BITS));
+#else
+    psLimiter->tCeiling = fCeiling;
+#endif
+    psLimiter->bEnable = bEnable ? AAP_TRUE : AAP_FALSE;
+}
+
+/* Starts over with unity gain and an empty delay line */
+static void alsa_limiter_reset(AlsaLimiter *psLimiter)
+{
+    unsigned int const uiLookahead = psLimiter->uiLookahead;
+
+    memset(psLimiter->ptDelay, 0x0,
+            uiLookahead * psLimiter->uiChannels * sizeof(AlsaBusSample));
+    for (unsigned int i = 0; i < uiLookahead; ++i)
+    {
+        psLimiter->piBox[i] = ALSA_LIMITER_UNITY;
+    }
+    psLimiter->llBoxSum = static_cast<int64_t>(uiLookahead) * ALSA_LIMITER_UNITY;
+    psLimiter->uiDequeHead = 0;
+    psLimiter->uiDequeCount = 0;
+    psLimiter->uiFrame = 0;
+    psLimiter->uiPos = 0;
+    psLimiter->iReleased = ALSA_LIMITER_UNITY;
+}
+
+/* Q30 gain bringing the peak of a frame down to the ceiling */
+static inline int alsa_limiter_required(const AlsaBusSample *ptFrame,
+        unsigned int uiChannels, AlsaBusSample tCeiling)
+{
+#if ALSA_FIXED_POINT
+    unsigned int uiPeak = 0;
+
+    for (unsigned int c = 0; c < uiChannels; ++c)
+    {
+        unsigned int uiAbs = (ptFrame[c] < 0) ?
+            0U - static_cast<unsigned int>(ptFrame[c]) : static_cast<unsigned int>(ptFrame[c]);
+        uiPeak = (uiAbs > uiPeak) ? uiAbs : uiPeak;
+    }
+    if (uiPeak <= static_cast<unsigned int>(tCeiling))
+    {
+        return ALSA_LIMITER_UNITY;
+    }
+    return static_cast<int>((static_cast<int64_t>(tCeiling) << 30) / uiPeak);
+#else
+    float fPeak = 0.0f;
+
+    for (unsigned int c = 0; c < uiChannels; ++c)
+    {
+        float fAbs = fabsf(ptFrame[c]);
+        fPeak = (fAbs > fPeak) ? fAbs : fPeak;
+    }
+    if (fPeak <= tCeiling)
+    {
+        return ALSA_LIMITER_UNITY;
+    }
+    /* Rounded down, the gain must not come out above the exact one */
+    return static_cast<int>(static_cast<double>(tCeiling) / fPeak * ALSA_LIMITER_UNITY);
+#endif
+}
+
+void alsa_limiter_process(void *pvLimiter, AlsaBusSample *ptBus, unsigned int uiFrames)
+{
+    AlsaLimiter *psLimiter = static_cast<AlsaLimiter *>(pvLimiter);
+    unsigned int const uiChannels = psLimiter->uiChannels;
+    unsigned int const uiLookahead = psLimiter->uiLookahead;
+    unsigned int const uiDequeCap = uiLookahead + 1;
+    AlsaBusSample const tCeiling = psLimiter->tCeiling;
+    unsigned int *puiAt = psLimiter->puiDequeAt;
+    int *piDq = psLimiter->piDequeGain;
+    int iMinGain = ALSA_LIMITER_UNITY;
+    int iSeen;
+    unsigned long ulLimited = 0;
+    int iGain = ALSA_LIMITER_UNITY;
+
+    if (!psLimiter->bEnable)
+    {
+        psLimiter->bRunning = AAP_FALSE;
+        psLimiter->iGain = ALSA_LIMITER_UNITY;
+        return;
+    }
+    if (!psLimiter->bRunning)
+    {
+        alsa_limiter_reset(psLimiter);
+        psLimiter->bRunning = AAP_TRUE;
+    }
+
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        unsigned int const uiNow = psLimiter->uiFrame;
+        unsigned int const uiPos = psLimiter->uiPos;
+        int const iRequired = alsa_limiter_required(ptBus, uiChannels, tCeiling);
+        AlsaBusSample *ptDelay = psLimiter->ptDelay + uiPos * uiChannels;
+        int iHeld;
+
+        /* Deque of increasing gains: drop what the new frame undercuts,
+         * then what has left the window */
+        while ((psLimiter->uiDequeCount > 0) && (piDq[(psLimiter->uiDequeHead +
+                        psLimiter->uiDequeCount - 1) % uiDequeCap] >= iRequired))
+        {
+            --psLimiter->uiDequeCount;
+        }
+        puiAt[(psLimiter->uiDequeHead + psLimiter->uiDequeCount) % uiDequeCap] = uiNow;
+        piDq[(psLimiter->uiDequeHead + psLimiter->uiDequeCount) % uiDequeCap] = iRequired;
+        ++psLimiter->uiDequeCount;
+        if (uiNow - puiAt[psLimiter->uiDequeHead] > uiLookahead)
+        {
+            psLimiter->uiDequeHead = (psLimiter->uiDequeHead + 1) % uiDequeCap;
+            --psLimiter->uiDequeCount;
+        }
+        iHeld = piDq[psLimiter->uiDequeHead];
+
+        /* Instant attack of the hold, exponential release, rounded up so
+         * that unity is reached */
+        if (iHeld <= psLimiter->iReleased)
+        {
+            psLimiter->iReleased = iHeld;
+        }
+        else
+        {
+            psLimiter->iReleased += static_cast<int>(
+                    (static_cast<int64_t>(iHeld - psLimiter->iReleased) *
+                     psLimiter->iRelease + (1 << 24) - 1) >> 24);
+        }
+        psLimiter->llBoxSum += psLimiter->iReleased - psLimiter->piBox[uiPos];
+        psLimiter->piBox[uiPos] = psLimiter->iReleased;
+        iGain = static_cast<int>(psLimiter->llBoxSum / uiLookahead);
+
+        /* Out goes the frame from one look-ahead ago, in the new one */
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            AlsaBusSample tOut = ptDelay[c];
+
+            ptDelay[c] = ptBus[c];
+#if ALSA_FIXED_POINT
+            ptBus[c] = static_cast<int>((static_cast<int64_t>(tOut) * iGain) >> 30);
+#else
+            ptBus[c] = tOut * (static_cast<float>(iGain) * (1.0f / ALSA_LIMITER_UNITY));
+#endif
+        }
+        if (iGain < ALSA_LIMITER_UNITY)
+        {
+            ++ulLimited;
+            iMinGain = (iGain < iMinGain) ? iGain : iMinGain;
+        }
+        ptBus += uiChannels;
+        ++psLimiter->uiFrame;
+        psLimiter->uiPos = (uiPos + 1 < uiLookahead) ? uiPos + 1 : 0;
+    }
+    psLimiter->iGain = iGain;
+    /* Lowered only, the application resets it at any time by exchange */
+    iSeen = psLimiter->iMinGain;
+    while ((iMinGain < iSeen) &&
+            !__sync_bool_compare_and_swap(&psLimiter->iMinGain, iSeen, iMinGain))
+    {
+        iSeen = psLimiter->iMinGain;
+    }
+    psLimiter->ulLimitedFrames += ulLimited;
+}
+
+static float alsa_limiter_db(int iGain)
+{
+    return 20.0f * log10f(static_cast<float>(ALSA_LIMITER_UNITY) / iGain);
+}
+
+/* Read by the application thread. The largest reduction starts over with
+ * every read, so that it can be watched period by period while tuning. */
+void alsa_limiter_stats(AlsaLimiter *psLimiter, AAPPlayerLimiterStats *psStats)
+{
+    int iGain = psLimiter->iGain;
+    int iMinGain = __sync_lock_test_and_set(&psLimiter->iMinGain, ALSA_LIMITER_UNITY);
+
+    psStats->fReductionDb = (psLimiter->bEnable && (iGain > 0)) ?
+        alsa_limiter_db(iGain) : 0.0f;
+    psStats->fMaxReductionDb = (iMinGain > 0) ? alsa_limiter_db(iMinGain) : 0.0f;
+    psStats->ullLimitedFrames = psLimiter->ulLimitedFrames;
+}
+
+AAP_BOOL alsa_limiter_active(void *pvLimiter)
+{
+    return static_cast<AlsaLimiter *>(pvLimiter)->bEnable;
+}
+
+void alsa_limiter_deinit(AlsaLimiter *psLimiter)
+{
+    free(psLimiter->ptDelay);
+    free(psLimiter->puiDequeAt);
+    free(psLimiter->piDequeGain);
+    free(psLimiter->piBox);
+    psLimiter->ptDelay = NULL;
+    psLimiter->puiDequeAt = NULL;
+    psLimiter->piDequeGain = NULL;
+    psLimiter->piBox = NULL;
+}
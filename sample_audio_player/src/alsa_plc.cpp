@@ -0,0 +1,384 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_plc.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Packet loss concealment for the ALSA core player.
+ *
+ *   Every packet's timestamp is compared with the position expected from the
+ *   previous packet and its frame count.
+ *   - A short hole is filled by repeating the last pitch period of the
+ *     history (found by normalized autocorrelation), held for a few ms and
+ *     then faded out, and the real data is crossfaded in on arrival.
+ *   - Data older than the expected position is late and is dropped; a packet
+ *     only partly overlapping is trimmed and crossfaded in.
+ *   - Jumps beyond the concealment range are taken as a new segment and the
+ *     data is faded in from silence.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "alsa_plc.h"
+#include "aap_error_codes.h"
+
+/* Timestamp jitter that is not treated as a gap or as late data */
+#define ALSA_PLC_TOLERANCE_MS 4
+/* Longest gap that is concealed. Longer jumps start a new segment */
+#define ALSA_PLC_MAX_GAP_MS 120
+/* Data further in the past than this means the timestamps restarted */
+#define ALSA_PLC_MAX_LATE_MS 500
+/* Concealment plays at full level for this long ... */
+#define ALSA_PLC_HOLD_MS 10
+/* ... and then fades out to silence over this period */
+#define ALSA_PLC_DECAY_MS 50
+/* Crossfade from concealment into the real data */
+#define ALSA_PLC_XFADE_MS 5
+/* History kept for the pitch search */
+#define ALSA_PLC_HIST_MS 40
+/* Correlation window at the end of the history */
+#define ALSA_PLC_CORR_MS 10
+/* Pitch search range, 400 Hz down to 66 Hz */
+#define ALSA_PLC_MIN_PITCH_US 2500
+#define ALSA_PLC_MAX_PITCH_US 15000
+
+static unsigned int alsa_plc_ms_to_frames(const AlsaPlc *psPlc, unsigned int uiMs)
+{
+    return (psPlc->uiRate * uiMs) / 1000;
+}
+
+int alsa_plc_init(AlsaPlc *psPlc, unsigned int uiChannels, unsigned int uiRate)
+{
+    if ((NULL == psPlc) || (0 == uiChannels) || (0 == uiRate))
+    {
+        printf("ERR::AP::Invalid concealment parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psPlc, 0x0, sizeof(AlsaPlc));
+    psPlc->uiChannels = uiChannels;
+    psPlc->uiRate = uiRate;
+    psPlc->uiHistFrames = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_HIST_MS);
+    psPlc->psHist = static_cast<short *>(
+            malloc(psPlc->uiHistFrames * uiChannels * sizeof(short)));
+    psPlc->pfMono = static_cast<float *>(
+            malloc(psPlc->uiHistFrames * sizeof(float)));
+    if ((NULL == psPlc->psHist) || (NULL == psPlc->pfMono))
+    {
+        printf("ERR::AP::Concealment history allocation failed!\n");
+        alsa_plc_deinit(psPlc);
+        return AAP_ERR_OUT_OF_MEM;
+    }
+    return 0;
+}
+
+void alsa_plc_reset(AlsaPlc *psPlc)
+{
+    psPlc->bTsValid = AAP_FALSE;
+    psPlc->ulCoveredFrames = 0;
+    psPlc->uiHistFill = 0;
+}
+
+static void alsa_plc_push_history(AlsaPlc *psPlc, const short *psFrames,
+        unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psPlc->uiChannels;
+    unsigned int const uiCap = psPlc->uiHistFrames;
+
+    if (uiFrames >= uiCap)
+    {
+        memcpy(psPlc->psHist, psFrames + (uiFrames - uiCap) * uiChannels,
+                uiCap * uiChannels * sizeof(short));
+        psPlc->uiHistFill = uiCap;
+        return;
+    }
+    if (psPlc->uiHistFill + uiFrames > uiCap)
+    {
+        unsigned int uiKeep = uiCap - uiFrames;
+        memmove(psPlc->psHist,
+                psPlc->psHist + (psPlc->uiHistFill - uiKeep) * uiChannels,
+                uiKeep * uiChannels * sizeof(short));
+        psPlc->uiHistFill = uiKeep;
+    }
+    memcpy(psPlc->psHist + psPlc->uiHistFill * uiChannels, psFrames,
+            uiFrames * uiChannels * sizeof(short));
+    psPlc->uiHistFill += uiFrames;
+}
+
+/* Returns the pitch period of the history in frames, 0 if the history is
+ * too short to search. */
+static unsigned int alsa_plc_find_pitch(AlsaPlc *psPlc)
+{
+    unsigned int const uiChannels = psPlc->uiChannels;
+    unsigned int const uiFill = psPlc->uiHistFill;
+    unsigned int uiWin = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_CORR_MS);
+    unsigned int uiMinLag = (psPlc->uiRate / 100) * ALSA_PLC_MIN_PITCH_US / 10000;
+    unsigned int uiMaxLag = (psPlc->uiRate / 100) * ALSA_PLC_MAX_PITCH_US / 10000;
+    unsigned int uiBest;
+    float *pfX = psPlc->pfMono;
+    float *pfRef;
+    float fBestScore = -1.0f;
+
+    if (uiFill < uiWin + uiMinLag)
+    {
+        return 0;
+    }
+    if (uiMaxLag > uiFill - uiWin)
+    {
+        uiMaxLag = uiFill - uiWin;
+    }
+
+    for (unsigned int i = 0; i < uiFill; ++i)
+    {
+        float fSum = 0.0f;
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            fSum += psPlc->psHist[i * uiChannels + c];
+        }
+        pfX[i] = fSum;
+    }
+
+    pfRef = pfX + uiFill - uiWin;
+    uiBest = uiMinLag;
+    for (unsigned int uiLag = uiMinLag; uiLag <= uiMaxLag; ++uiLag)
+    {
+        const float *pfCand = pfRef - uiLag;
+        float fCorr = 0.0f;
+        float fEnergy = 1.0f;
+        float fScore;
+
+        for (unsigned int i = 0; i < uiWin; ++i)
+        {
+            fCorr += pfRef[i] * pfCand[i];
+            fEnergy += pfCand[i] * pfCand[i];
+        }
+        /* Signed square of the normalized correlation, avoids a sqrt */
+        fScore = (fCorr > 0.0f) ? (fCorr * fCorr / fEnergy) : 0.0f;
+        if (fScore > fBestScore)
+        {
+            fBestScore = fScore;
+            uiBest = uiLag;
+        }
+    }
+    return uiBest;
+}
+
+/* Writes frames [uiStart, uiStart + uiCount) of the concealment signal */
+static void alsa_plc_synthesize(AlsaPlc *psPlc, short *psDst,
+        unsigned int uiStart, unsigned int uiCount, unsigned int uiPeriod)
+{
+    unsigned int const uiChannels = psPlc->uiChannels;
+    unsigned int const uiHold = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_HOLD_MS);
+    unsigned int const uiDecay = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_DECAY_MS);
+    const short *psPeriod;
+
+    if (0 == uiPeriod)
+    {
+        memset(psDst, 0x0, uiCount * uiChannels * sizeof(short));
+        return;
+    }
+    psPeriod = psPlc->psHist + (psPlc->uiHistFill - uiPeriod) * uiChannels;
+    for (unsigned int i = 0; i < uiCount; ++i)
+    {
+        unsigned int uiPos = uiStart + i;
+        const short *psSrc = psPeriod + (uiPos % uiPeriod) * uiChannels;
+        int iGain;
+
+        /* Gain in Q15 */
+        if (uiPos < uiHold)
+        {
+            iGain = 32768;
+        }
+        else if (uiPos < uiHold + uiDecay)
+        {
+            iGain = static_cast<int>(
+                    (static_cast<long long>(uiHold + uiDecay - uiPos) << 15) / uiDecay);
+        }
+        else
+        {
+            iGain = 0;
+        }
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            psDst[i * uiChannels + c] = static_cast<short>((psSrc[c] * iGain) >> 15);
+        }
+    }
+}
+
+static int alsa_plc_reserve(AlsaPlc *psPlc, unsigned int uiFrames)
+{
+    if (uiFrames > psPlc->uiOutCap)
+    {
+        short *psOut = static_cast<short *>(realloc(psPlc->psOut,
+                    uiFrames * psPlc->uiChannels * sizeof(short)));
+        if (NULL == psOut)
+        {
+            printf("ERR::AP::Concealment output allocation failed!\n");
+            return AAP_ERR_OUT_OF_MEM;
+        }
+        psPlc->psOut = psOut;
+        psPlc->uiOutCap = uiFrames;
+    }
+    return 0;
+}
+
+/* Emits uiGap concealed frames followed by psIn, crossfading the start of
+ * psIn with the continuation of the concealment. */
+static int alsa_plc_repair(AlsaPlc *psPlc, const short *psIn,
+        unsigned int uiFrames, unsigned int uiGap, const short **ppsOut)
+{
+    unsigned int const uiChannels = psPlc->uiChannels;
+    unsigned int uiXfade = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_XFADE_MS);
+    unsigned int uiPeriod;
+    short *psOut;
+
+    if (0 != alsa_plc_reserve(psPlc, uiGap + uiFrames))
+    {
+        return -1;
+    }
+    if (uiXfade > uiFrames)
+    {
+        uiXfade = uiFrames;
+    }
+    psOut = psPlc->psOut;
+    uiPeriod = alsa_plc_find_pitch(psPlc);
+    alsa_plc_synthesize(psPlc, psOut, 0, uiGap + uiXfade, uiPeriod);
+
+    for (unsigned int i = 0; i < uiXfade; ++i)
+    {
+        /* Weight of the real data in Q15, rising towards 1 */
+        int iW = static_cast<int>((static_cast<long long>(i + 1) << 15) / (uiXfade + 1));
+        short *psDst = psOut + (uiGap + i) * uiChannels;
+        const short *psSrc = psIn + i * uiChannels;
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            psDst[c] = static_cast<short>(
+                    (psSrc[c] * iW + psDst[c] * (32768 - iW)) >> 15);
+        }
+    }
+    memcpy(psOut + (uiGap + uiXfade) * uiChannels, psIn + uiXfade * uiChannels,
+            (uiFrames - uiXfade) * uiChannels * sizeof(short));
+
+    psPlc->ulConcealedFrames += uiGap;
+    alsa_plc_push_history(psPlc, psOut, uiGap + uiFrames);
+    *ppsOut = psOut;
+    return static_cast<int>(uiGap + uiFrames);
+}
+
+int alsa_plc_process(AlsaPlc *psPlc,
+        const short *psIn,
+        unsigned int uiFrames,
+        uint64_t ulTimeStamp,
+        const short **ppsOut)
+{
+    long long llDiffFrames;
+    long long llTol;
+    uint64_t ullExpected;
+
+    if (!psPlc->bTsValid || (0 != psPlc->ulCoveredFrames))
+    {
+        /* First packet, or playback already went on with silence: the data
+         * is faded in downstream, just take up the new timeline. */
+        psPlc->ulCoveredFrames = 0;
+        psPlc->bTsValid = AAP_TRUE;
+        psPlc->ullBaseTs = ulTimeStamp;
+        psPlc->ullBaseFrames = uiFrames;
+        alsa_plc_push_history(psPlc, psIn, uiFrames);
+        *ppsOut = psIn;
+        return static_cast<int>(uiFrames);
+    }
+
+    ullExpected = psPlc->ullBaseTs +
+        (psPlc->ullBaseFrames * ALSA_PLC_TS_PER_SEC) / psPlc->uiRate;
+    llDiffFrames = (static_cast<long long>(ulTimeStamp - ullExpected) *
+            static_cast<long long>(psPlc->uiRate)) /
+        static_cast<long long>(ALSA_PLC_TS_PER_SEC);
+    llTol = alsa_plc_ms_to_frames(psPlc, ALSA_PLC_TOLERANCE_MS);
+
+    if (llDiffFrames > llTol)
+    {
+        psPlc->ullBaseTs = ulTimeStamp;
+        psPlc->ullBaseFrames = uiFrames;
+        if (llDiffFrames <= alsa_plc_ms_to_frames(psPlc, ALSA_PLC_MAX_GAP_MS))
+        {
+            ++psPlc->uiGapCount;
+            printf("AP::Concealing gap of %lld frames\n", llDiffFrames);
+            return alsa_plc_repair(psPlc, psIn, uiFrames,
+                    static_cast<unsigned int>(llDiffFrames), ppsOut);
+        }
+        /* New segment, fade in from silence */
+        printf("AP::Timestamp jump of %lld frames, resyncing\n", llDiffFrames);
+        psPlc->uiHistFill = 0;
+        return alsa_plc_repair(psPlc, psIn, uiFrames, 0, ppsOut);
+    }
+
+    if (llDiffFrames < -llTol)
+    {
+        unsigned long long ullLate = static_cast<unsigned long long>(-llDiffFrames);
+
+        if (ullLate > alsa_plc_ms_to_frames(psPlc, ALSA_PLC_MAX_LATE_MS))
+        {
+            printf("AP::Timestamps restarted, resyncing\n");
+            psPlc->ullBaseTs = ulTimeStamp;
+            psPlc->ullBaseFrames = uiFrames;
+            psPlc->uiHistFill = 0;
+            return alsa_plc_repair(psPlc, psIn, uiFrames, 0, ppsOut);
+        }
+        if (ullLate >= uiFrames)
+        {
+            /* Entirely in the past, already covered by earlier output */
+            psPlc->ulDroppedFrames += uiFrames;
+            return 0;
+        }
+        psPlc->ulDroppedFrames += ullLate;
+        psPlc->ullBaseFrames += uiFrames - ullLate;
+        return alsa_plc_repair(psPlc,
+                psIn + ullLate * psPlc->uiChannels,
+                static_cast<unsigned int>(uiFrames - ullLate), 0, ppsOut);
+    }
+
+    /* In sequence. Re-anchor on every packet so that slow divergence between
+     * the timestamp clock and the frame count is never taken as a gap. */
+    psPlc->ullBaseTs = ulTimeStamp;
+    psPlc->ullBaseFrames = uiFrames;
+    alsa_plc_push_history(psPlc, psIn, uiFrames);
+    *ppsOut = psIn;
+    return static_cast<int>(uiFrames);
+}
+
+void alsa_plc_deinit(AlsaPlc *psPlc)
+{
+    if (psPlc->psHist)
+    {
+        free(psPlc->psHist);
+        psPlc->psHist = NULL;
+    }
+    if (psPlc->pfMono)
+    {
+        free(psPlc->pfMono);
+        psPlc->pfMono = NULL;
+    }
+    if (psPlc->psOut)
+    {
+        free(psPlc->psOut);
+        psPlc->psOut = NULL;
+    }
+    psPlc->uiOutCap = 0;
+}
@@ -0,0 +1,1739 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_render.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Render thread of the ALSA core player.
+ *
+ *   The thread writes one period at a time from the frame ring whenever the
+ *   PCM has room for it. When the ring runs short it waits for data only as
+ *   long as the PCM can keep playing; once a single period is left queued it
+ *   fades out what data there is and pads the period with silence, so the
+ *   device never underruns. The next real data is faded in. A true xrun is
+ *   still recovered with snd_pcm_prepare, and playback resumes faded in.
+ *
+ *   A suspended PCM (-ESTRPIPE) is resumed by a small state machine: one
+ *   snd_pcm_resume() attempt per poll interval, falling back to prepare, so
+ *   the thread keeps serving requests meanwhile. The producer keeps filling
+ *   the ring and drops what does not fit; stale data beyond one buffer is
+ *   skipped on resume. The application is told with E_AAP_PLAYER_PAUSED
+ *   when the suspend is seen and E_AAP_PLAYER_PLAYING once it is resumed.
+ *
+ *   In pull mode the ring is bypassed: each time the PCM has room for a
+ *   period the application is asked for it with E_AAP_PLAYER_INPUT_BUFFER
+ *   and fills psPeriodBuf in place. A short answer is padded as above.
+ *
+ *   After drift compensation each period passes the float bus of
+ *   alsa_bus.cpp, which requantizes it with dither when it was processed.
+ *
+ *   Pause, stop and restart of a running PCM fade its output out instead of
+ *   cutting it. Every frame written is kept in a one buffer history; on a
+ *   transition all queued frames but a short guard are rewound and the
+ *   first of them written again with a fade, so the change is heard at
+ *   once. A PCM that cannot rewind gets the fade after what it has queued.
+ *   Once the fade has played the PCM is dropped; after pause and stop the
+ *   thread renders nothing until play, which fades back in.
+ *   A lowered gain is preempted the same way: the rewound frames are scaled
+ *   down from the history, ramping over the first ALSA_RENDER_FADE_MS, and
+ *   written again, so ducking is heard within the guard whatever the
+ *   buffer size.
+ *
+ *   With ALSA_TSCHED the PCM has a large buffer without period interrupts
+ *   and is kept filled to the latency only. The thread sleeps on a timerfd
+ *   until it has played down to the guard plus a margin, twice the timer
+ *   lateness measured lately, and tops it up with all the ring holds then.
+ *   Requests wake it early through an eventfd, data does not.
+ *   In deep buffer mode the fill is raised to ALSA_DEEP_BUFFER_MS. It is
+ *   built up by prebuffering on the next start, by what the source sends
+ *   ahead, and by drift compensation stretching the stream. Going back is
+ *   immediate: the excess is rewound, faded out and dropped.
+ *
+ *   A watchdog follows the hardware position of a running PCM, the frames
+ *   written less its delay. When it has not moved for uiWatchdogMs, as on a
+ *   hung DMA where the write would wait for room forever, the write is
+ *   given up, the PCM dropped and prepared again and the ring flushed, and
+ *   the application gets E_AAP_PLAYER_FACED_ERROR with
+ *   E_AAP_ERROR_PLAYER_TIMEOUT. Until the position moves again the
+ *   producer drops what does not fit instead of waiting for room; the
+ *   restart is repeated each timeout, so a dead device costs the session
+ *   its output only. E_AAP_PLAYER_PLAYING follows once it plays again.
+ *
+ *   A drain marks the end of the stream in the ring. Once the render thread
+ *   has written the frame before the mark it keeps its position in the PCM,
+ *   from the frames written and the drift ratio of that period. A tail
+ *   short of a period is written without waiting for more, padded with
+ *   silence instead of faded, and the PCM started if it has not been.
+ *   Nothing blocks in snd_pcm_drain(): the thread keeps rendering whatever
+ *   follows, reads snd_pcm_status() and bounds its sleeps by the time left
+ *   until the hardware position reaches the end. It then raises
+ *   E_AAP_PLAYER_FACED_ERROR with E_AAP_ERROR_PLAYER_EOS. If the end is
+ *   dropped instead (stop, pause or a stall), EOS is raised once the PCM
+ *   has nothing queued, so each drain gets exactly one EOS.
+ *
+ *   The thread's stack, the ring, the period and bus buffers are locked in
+ *   memory when allowed, and the AAP_ThreadConfig of the stream is applied
+ *   to it.
+ *   With ALSA_RT_CHECK the thread arms the real-time checks after a second
+ *   of steady playback and disarms them on any transition (recovery,
+ *   requests, idling), which may log.
+ *
+ ******************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include "alsa_render.h"
+#include "alsa_thread.h"
+#include "alsa_rt_check.h"
+#include "aap_error_codes.h"
+
+/* Length of the fade applied around injected silence and after xruns */
+#define ALSA_RENDER_FADE_MS 3
+/* Length of the fade out on pause, stop and restart */
+#define ALSA_RENDER_TRANSITION_MS 10
+/* Queued frames left alone when rewinding, the device may be reading them */
+#define ALSA_RENDER_REWIND_GUARD_MS 2
+/* Injected silence after which the PCM is allowed to run dry */
+#define ALSA_RENDER_IDLE_MS 2000
+/* Longest single wait of the render thread */
+#define ALSA_RENDER_POLL_MS 100
+/* Interval and number of snd_pcm_resume() attempts after a suspend */
+#define ALSA_RESUME_POLL_MS 10
+#define ALSA_RESUME_MAX_TRIES 100
+/* Shortest interval between two reads of the hardware position */
+#define ALSA_WATCHDOG_CHECK_MS 20
+
+static int audio_stream_recover(snd_pcm_t *pcmHandle, int iInError)
+{
+    int iErrRet;
+
+    if (-EINTR == iInError)
+    {
+        iErrRet = 0;
+    }
+    else if (-EPIPE == iInError)
+    { /* Underrun */
+        iErrRet = snd_pcm_prepare (pcmHandle);
+    }
+    else
+    {
+        iErrRet = iInError;
+    }
+
+    return iErrRet;
+}
+
+int alsa_render_sem_wait(sem_t *psSem, unsigned int uiTimeoutMs)
+{
+    struct timespec sDeadline;
+    int iRet;
+
+    clock_gettime(CLOCK_REALTIME, &sDeadline);
+    sDeadline.tv_sec += uiTimeoutMs / 1000;
+    sDeadline.tv_nsec += (uiTimeoutMs % 1000) * 1000000L;
+    if (sDeadline.tv_nsec >= 1000000000L)
+    {
+        sDeadline.tv_sec += 1;
+        sDeadline.tv_nsec -= 1000000000L;
+    }
+    do
+    {
+        iRet = sem_timedwait(psSem, &sDeadline);
+    } while ((0 != iRet) && (EINTR == errno));
+
+    return iRet;
+}
+
+/* Wakes the render thread, from a timer sleep too */
+static void alsa_render_wake(AlsaConfig *psAlsaConfig)
+{
+    sem_post(&psAlsaConfig->semData);
+#if ALSA_TSCHED
+    uint64_t ullOne = 1;
+
+    if (write(psAlsaConfig->iWakeFd, &ullOne, sizeof(ullOne)) < 0)
+    {
+        printf("ERR::AP::Render wake failed %d\n", errno);
+    }
+#endif
+}
+
+void alsa_render_request(AlsaConfig *psAlsaConfig, unsigned int uiReq)
+{
+    if (uiReq & ALSA_RENDER_REQ_TRANSPORT)
+    {
+        /* Only the latest of play, pause and stop counts */
+        __sync_fetch_and_and(&psAlsaConfig->uiRenderReq,
+                ~static_cast<unsigned int>(ALSA_RENDER_REQ_TRANSPORT));
+    }
+    __sync_fetch_and_or(&psAlsaConfig->uiRenderReq, uiReq);
+    alsa_render_wake(psAlsaConfig);
+}
+
+static void alsa_render_notify(AlsaConfig *psAlsaConfig, AAPPlayer_Events eEvent)
+{
+    if (psAlsaConfig->pfEventFunc)
+    {
+        psAlsaConfig->pfEventFunc(eEvent,
+                0,
+                NULL,
+                psAlsaConfig->pvUserParam);
+    }
+}
+
+/* E_AAP_PLAYER_FACED_ERROR carrying one of the E_AAP_ERROR_PLAYER_* codes */
+static void alsa_render_notify_error(AlsaConfig *psAlsaConfig, int iError)
+{
+    if (psAlsaConfig->pfEventFunc)
+    {
+        psAlsaConfig->pfEventFunc(E_AAP_PLAYER_FACED_ERROR,
+                sizeof(iError),
+                &iError,
+                psAlsaConfig->pvUserParam);
+    }
+}
+
+static unsigned long long alsa_render_now_ms(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return static_cast<unsigned long long>(sNow.tv_sec) * 1000ULL +
+        sNow.tv_nsec / 1000000L;
+}
+
+#if ALSA_TSCHED
+static unsigned long long alsa_render_now_ns(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return static_cast<unsigned long long>(sNow.tv_sec) * 1000000000ULL +
+        sNow.tv_nsec;
+}
+#endif
+
+/* Leaves the steady state, the checks stay off until the next warm-up */
+static void alsa_render_rt_leave(AlsaConfig *psAlsaConfig)
+{
+    alsa_rt_check_arm(AAP_FALSE);
+    psAlsaConfig->ulRtWarmFrames = 0;
+}
+
+/* Counts steady playback, arms the checks after one second of it */
+static void alsa_render_rt_warm(AlsaConfig *psAlsaConfig, snd_pcm_state_t eState)
+{
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+
+    if ((SND_PCM_STATE_RUNNING != eState) ||
+            (psAlsaConfig->ulRtWarmFrames >= uiRate))
+    {
+        return;
+    }
+    psAlsaConfig->ulRtWarmFrames += psAlsaConfig->periodSize;
+    if (psAlsaConfig->ulRtWarmFrames >= uiRate)
+    {
+        alsa_rt_check_arm(AAP_TRUE);
+    }
+}
+
+static int alsa_render_recover(AlsaConfig *psAlsaConfig, int iErr)
+{
+    alsa_render_rt_leave(psAlsaConfig);
+    if (-ESTRPIPE == iErr)
+    {
+        /* Resumed asynchronously by alsa_render_resume_step() */
+        if (!psAlsaConfig->bSuspended)
+        {
+            printf("AP::PCM suspended, resuming\n");
+            ++psAlsaConfig->ulSuspendCount;
+            psAlsaConfig->uiResumeTries = 0;
+            psAlsaConfig->ullResumeAtMs = alsa_render_now_ms();
+            psAlsaConfig->bSuspended = AAP_TRUE;
+            alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_PAUSED);
+        }
+        return 0;
+    }
+    if (-EPIPE == iErr)
+    {
+        if (!psAlsaConfig->bIdle)
+        {
+            ++psAlsaConfig->ulXrunCount;
+            printf("ERR::AP::Underrun, total %lu\n", psAlsaConfig->ulXrunCount);
+        }
+        psAlsaConfig->bFadeIn = AAP_TRUE;
+        alsa_drift_reset(&psAlsaConfig->sDrift);
+    }
+    iErr = audio_stream_recover(psAlsaConfig->pcmHandleOut, iErr);
+    if ((0 != iErr) && !psAlsaConfig->bFailed)
+    {
+        /* Device gone or broken, retrying would only spin */
+        printf("ERR::AP::Audio stream recover: failed %d\n", iErr);
+        psAlsaConfig->bFailed = AAP_TRUE;
+        alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_FACED_ERROR);
+    }
+    return iErr;
+}
+
+/* Keeps frames written to the PCM, the newest buffer of them */
+static void alsa_render_history(AlsaConfig *psAlsaConfig, const short *psData,
+        unsigned int uiFrames)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiCap = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+    unsigned int uiPos = psAlsaConfig->uiHistoryPos;
+
+    if (uiFrames > uiCap)
+    {
+        psData += (uiFrames - uiCap) * uiChannels;
+        uiFrames = uiCap;
+    }
+    while (uiFrames > 0)
+    {
+        unsigned int uiRun = (uiCap - uiPos < uiFrames) ? uiCap - uiPos : uiFrames;
+
+        memcpy(psAlsaConfig->psHistory + uiPos * uiChannels, psData,
+                uiRun * uiChannels * sizeof(short));
+        psData += uiRun * uiChannels;
+        uiFrames -= uiRun;
+        uiPos = (uiPos + uiRun < uiCap) ? uiPos + uiRun : 0;
+    }
+    psAlsaConfig->uiHistoryPos = uiPos;
+}
+
+/* snd_pcm_writei() of S16 frames, exported a period at a time when the
+ * device takes another format. May write fewer frames than given. */
+static snd_pcm_sframes_t alsa_render_pcm_write(AlsaConfig *psAlsaConfig,
+        const short *psData, snd_pcm_uframes_t uiFrames)
+{
+    snd_pcm_sframes_t n;
+
+    if (NULL == psAlsaConfig->pfExport)
+    {
+        n = snd_pcm_writei(psAlsaConfig->pcmHandleOut, psData, uiFrames);
+    }
+    else
+    {
+        if (uiFrames > psAlsaConfig->periodSize)
+        {
+            uiFrames = psAlsaConfig->periodSize;
+        }
+        psAlsaConfig->pfExport(psData, psAlsaConfig->pvExport,
+                static_cast<unsigned int>(uiFrames) * psAlsaConfig->psAudioConfig->uiChannels);
+        n = snd_pcm_writei(psAlsaConfig->pcmHandleOut, psAlsaConfig->pvExport, uiFrames);
+    }
+    if (n > 0)
+    {
+        psAlsaConfig->ullWrittenFrames += n;
+    }
+    return n;
+}
+
+/* Restarts a PCM whose hardware pointer stopped, dropping what the ring
+ * holds as it is stale by now */
+static void alsa_render_stall(AlsaConfig *psAlsaConfig, unsigned long long ullNow)
+{
+    unsigned int uiDropped;
+    int iErr;
+
+    alsa_render_rt_leave(psAlsaConfig);
+    ++psAlsaConfig->ulStallCount;
+    printf("ERR::AP::Output stalled for %llu ms, restarting it, total %lu\n",
+            ullNow - psAlsaConfig->ullHwMovedMs, psAlsaConfig->ulStallCount);
+    snd_pcm_drop(psAlsaConfig->pcmHandleOut);
+    iErr = snd_pcm_prepare(psAlsaConfig->pcmHandleOut);
+    if (0 != iErr)
+    {
+        printf("ERR::AP::Prepare after stall failed %d\n", iErr);
+    }
+    alsa_drift_reset(&psAlsaConfig->sDrift);
+    psAlsaConfig->bFadeIn = AAP_TRUE;
+    psAlsaConfig->bIdle = AAP_FALSE;
+    psAlsaConfig->ulIdleFrames = 0;
+    uiDropped = alsa_ring_skip(&psAlsaConfig->sRing,
+            alsa_ring_fill(&psAlsaConfig->sRing));
+    psAlsaConfig->ulStallDropped += uiDropped;
+    /* Release a producer waiting for room */
+    sem_post(&psAlsaConfig->semSpace);
+    /* Nothing is queued now, the position goes on from what was written */
+    psAlsaConfig->ullHwFrames = psAlsaConfig->ullWrittenFrames;
+    psAlsaConfig->ullHwMovedMs = ullNow;
+    if (!psAlsaConfig->bStalled)
+    {
+        psAlsaConfig->bStalled = AAP_TRUE;
+        alsa_render_notify_error(psAlsaConfig, E_AAP_ERROR_PLAYER_TIMEOUT);
+    }
+}
+
+/* Follows the hardware position of a running PCM. Returns AAP_TRUE when it
+ * has not moved for the watchdog timeout and the PCM was restarted. */
+static AAP_BOOL alsa_render_watchdog(AlsaConfig *psAlsaConfig)
+{
+    unsigned int const uiTimeoutMs = psAlsaConfig->uiWatchdogMs;
+    unsigned long long const ullNow = alsa_render_now_ms();
+    unsigned long long ullHw;
+    snd_pcm_status_t *psStatus;
+    snd_pcm_sframes_t delay;
+
+    if ((0 == uiTimeoutMs) ||
+            (ullNow - psAlsaConfig->ullHwCheckMs < ALSA_WATCHDOG_CHECK_MS))
+    {
+        return AAP_FALSE;
+    }
+    psAlsaConfig->ullHwCheckMs = ullNow;
+    snd_pcm_status_alloca(&psStatus);
+    if (0 != snd_pcm_status(psAlsaConfig->pcmHandleOut, psStatus))
+    {
+        psAlsaConfig->ullHwMovedMs = ullNow;
+        return AAP_FALSE;
+    }
+    delay = snd_pcm_status_get_delay(psStatus);
+    if (delay < 0)
+    {
+        delay = 0;
+    }
+    ullHw = psAlsaConfig->ullWrittenFrames - static_cast<unsigned long long>(delay);
+    if ((SND_PCM_STATE_RUNNING != snd_pcm_status_get_state(psStatus)) ||
+            (0 == delay))
+    {
+        /* Nothing is due to play, so nothing to wait for either. A drop
+         * moves the position without the hardware playing, start from
+         * where it is now. */
+        psAlsaConfig->ullHwFrames = ullHw;
+        psAlsaConfig->ullHwMovedMs = ullNow;
+        return AAP_FALSE;
+    }
+    if (ullHw != psAlsaConfig->ullHwFrames)
+    {
+        psAlsaConfig->ullHwFrames = ullHw;
+        psAlsaConfig->ullHwMovedMs = ullNow;
+        if (psAlsaConfig->bStalled)
+        {
+            printf("AP::Output playing again after %lu stalls\n",
+                    psAlsaConfig->ulStallCount);
+            psAlsaConfig->bStalled = AAP_FALSE;
+            alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_PLAYING);
+        }
+        return AAP_FALSE;
+    }
+    if (ullNow - psAlsaConfig->ullHwMovedMs < uiTimeoutMs)
+    {
+        return AAP_FALSE;
+    }
+    alsa_render_stall(psAlsaConfig, ullNow);
+    return AAP_TRUE;
+}
+
+static int alsa_render_write(AlsaConfig *psAlsaConfig, const short *psData,
+        snd_pcm_uframes_t uiFrames)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    snd_pcm_sframes_t n;
+
+    while ((uiFrames > 0) && psAlsaConfig->bRenderRun)
+    {
+        n = alsa_render_pcm_write(psAlsaConfig, psData, uiFrames);
+        if (-EAGAIN == n)
+        {
+            if (alsa_render_watchdog(psAlsaConfig))
+            {
+                /* The rest of this block went with the PCM */
+                return AAP_ERR_TIMEOUT;
+            }
+            snd_pcm_wait(pcmHandle, ALSA_RENDER_POLL_MS);
+            continue;
+        }
+        if (n < 0)
+        {
+            /* The rest of this block was due in the past, drop it and let
+             * the next block fade in. */
+            return alsa_render_recover(psAlsaConfig, n);
+        }
+        alsa_render_history(psAlsaConfig, psData, n);
+        psData += n * uiChannels;
+        uiFrames -= n;
+    }
+    return 0;
+}
+
+/* Plays out the period in psPeriodBuf, of which uiGot frames are valid.
+ * lQueued is the total fill to steer the drift controller with, negative to
+ * leave it alone. When bStarving is set the data is about to run out: its
+ * tail is faded out and the period is padded with silence. */
+static int alsa_render_block(AlsaConfig *psAlsaConfig, unsigned int uiGot,
+        long lQueued, AAP_BOOL bStarving)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiFrames = psAlsaConfig->periodSize;
+    unsigned int uiFade = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_RENDER_FADE_MS) / 1000;
+    short *psBuf = psAlsaConfig->psPeriodBuf;
+    const short *psOut = NULL;
+    unsigned long long ullBefore;
+    int iRet;
+    int n;
+
+    if (psAlsaConfig->bFadeIn && (uiGot > 0))
+    {
+        psAlsaConfig->pfRamp(psBuf, (uiFade < uiGot) ? uiFade : uiGot,
+                uiChannels, 0, 32768);
+        psAlsaConfig->bFadeIn = AAP_FALSE;
+    }
+    if (bStarving)
+    {
+        unsigned int uiTail = (uiFade < uiGot) ? uiFade : uiGot;
+
+        psAlsaConfig->pfRamp(psBuf + (uiGot - uiTail) * uiChannels,
+                uiTail, uiChannels, 32768, 0);
+        memset(psBuf + uiGot * uiChannels, 0x0,
+                (uiFrames - uiGot) * uiChannels * sizeof(short));
+        if (!psAlsaConfig->bFadeIn)
+        {
+            ++psAlsaConfig->ulAvoidedUnderruns;
+        }
+        psAlsaConfig->bFadeIn = AAP_TRUE;
+        psAlsaConfig->ulSilenceFrames += uiFrames - uiGot;
+        psAlsaConfig->ulIdleFrames += uiFrames - uiGot;
+    }
+    else
+    {
+        psAlsaConfig->ulIdleFrames = 0;
+        /* Only real data played out is representative of the clocks */
+        if (lQueued >= 0)
+        {
+            alsa_drift_update(&psAlsaConfig->sDrift, lQueued, uiFrames);
+        }
+    }
+
+    n = alsa_drift_process(&psAlsaConfig->sDrift, psBuf, uiFrames, &psOut);
+    if (n < 0)
+    {
+        psOut = psBuf;
+        n = uiFrames;
+    }
+    n = alsa_bus_process(&psAlsaConfig->sBus, psOut, n, &psOut);
+    ullBefore = psAlsaConfig->ullWrittenFrames;
+    iRet = alsa_render_write(psAlsaConfig, psOut, n);
+    if (uiGot > 0)
+    {
+        /* Where the data ends in what was written, padding excluded */
+        psAlsaConfig->ullDataEndFrames = ullBefore +
+            ((psAlsaConfig->ullWrittenFrames - ullBefore) * uiGot) / uiFrames;
+    }
+    return iRet;
+}
+
+/* Waits until what the PCM has queued is played, at most a buffer and a
+ * period */
+static void alsa_render_play_out(AlsaConfig *psAlsaConfig)
+{
+    snd_pcm_sframes_t const lMax = static_cast<snd_pcm_sframes_t>(
+            psAlsaConfig->bufferSize + psAlsaConfig->periodSize);
+    snd_pcm_sframes_t lDelay = 0;
+    unsigned long long ullNs;
+    struct timespec sWait;
+
+    if ((0 != snd_pcm_delay(psAlsaConfig->pcmHandleOut, &lDelay)) || (lDelay <= 0))
+    {
+        return;
+    }
+    ullNs = (static_cast<unsigned long long>((lDelay < lMax) ? lDelay : lMax) *
+            1000000000ULL) / psAlsaConfig->psAudioConfig->eAudioFreq;
+    sWait.tv_sec = ullNs / 1000000000ULL;
+    sWait.tv_nsec = ullNs % 1000000000ULL;
+    nanosleep(&sWait, NULL);
+}
+
+/* Rewinds all that the PCM has queued but the guard, uiMax frames at most.
+ * The frames rewound are the newest of the history and start at *puiPos,
+ * which the history is set back to. Returns their number. */
+static unsigned int alsa_render_rewind(AlsaConfig *psAlsaConfig, unsigned int uiMax,
+        unsigned int *puiPos)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    unsigned int const uiCap = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+    snd_pcm_sframes_t lRewind;
+
+    if (SND_PCM_STATE_RUNNING != snd_pcm_state(pcmHandle))
+    {
+        return 0;
+    }
+    lRewind = snd_pcm_rewindable(pcmHandle) -
+        static_cast<snd_pcm_sframes_t>((uiRate * ALSA_RENDER_REWIND_GUARD_MS) / 1000);
+    if (lRewind > static_cast<snd_pcm_sframes_t>(uiCap))
+    {
+        lRewind = uiCap;
+    }
+    if (lRewind > static_cast<snd_pcm_sframes_t>(uiMax))
+    {
+        lRewind = uiMax;
+    }
+    if (lRewind > 0)
+    {
+        lRewind = snd_pcm_rewind(pcmHandle, lRewind);
+    }
+    if (lRewind <= 0)
+    {
+        return 0;
+    }
+    psAlsaConfig->ullWrittenFrames -= lRewind;
+    *puiPos = (psAlsaConfig->uiHistoryPos + uiCap -
+            static_cast<unsigned int>(lRewind)) % uiCap;
+    psAlsaConfig->uiHistoryPos = *puiPos;
+    psAlsaConfig->ulRewoundFrames += lRewind;
+    return static_cast<unsigned int>(lRewind);
+}
+
+/* Cuts the output of a running PCM short: what is queued but the guard, up
+ * to uiMax frames, is rewound and the first of it written again fading out.
+ * Returns AAP_FALSE when the PCM is not running or cannot rewind. */
+static AAP_BOOL alsa_render_cut(AlsaConfig *psAlsaConfig, unsigned int uiMax)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiCap = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+    unsigned int uiFade = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_RENDER_TRANSITION_MS) / 1000;
+    short *psFade = psAlsaConfig->psPeriodBuf;
+    unsigned int uiPos = 0;
+    unsigned int uiRewound;
+    unsigned int uiRun;
+    snd_pcm_sframes_t n;
+
+    uiRewound = alsa_render_rewind(psAlsaConfig, uiMax, &uiPos);
+    if (0 == uiRewound)
+    {
+        return AAP_FALSE;
+    }
+    if (uiFade > psAlsaConfig->periodSize)
+    {
+        uiFade = static_cast<unsigned int>(psAlsaConfig->periodSize);
+    }
+    uiFade = (uiFade < uiRewound) ? uiFade : uiRewound;
+    uiRun = (uiCap - uiPos < uiFade) ? uiCap - uiPos : uiFade;
+    memcpy(psFade, psAlsaConfig->psHistory + uiPos * uiChannels,
+            uiRun * uiChannels * sizeof(short));
+    memcpy(psFade + uiRun * uiChannels, psAlsaConfig->psHistory,
+            (uiFade - uiRun) * uiChannels * sizeof(short));
+    psAlsaConfig->pfRamp(psFade, uiFade, uiChannels, 32768, 0);
+    n = alsa_render_pcm_write(psAlsaConfig, psFade, uiFade);
+    if (n > 0)
+    {
+        alsa_render_history(psAlsaConfig, psFade, n);
+    }
+    ++psAlsaConfig->ulRewindFades;
+    return AAP_TRUE;
+}
+
+/* Fades out the output of a running PCM and returns once the fade has been
+ * played, the PCM can then be dropped without a click. With bCut what is
+ * queued is cut short by rewinding, else all of it is played. */
+static void alsa_render_fade_out(AlsaConfig *psAlsaConfig, AAP_BOOL bCut)
+{
+    unsigned int uiFade = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_RENDER_TRANSITION_MS) / 1000;
+
+    if (SND_PCM_STATE_RUNNING != snd_pcm_state(psAlsaConfig->pcmHandleOut))
+    {
+        return;
+    }
+    if (uiFade > psAlsaConfig->periodSize)
+    {
+        uiFade = static_cast<unsigned int>(psAlsaConfig->periodSize);
+    }
+    if (bCut && alsa_render_cut(psAlsaConfig,
+                static_cast<unsigned int>(psAlsaConfig->bufferSize)))
+    {
+        /* Faded within what stays queued */
+    }
+    else if (!psAlsaConfig->bPull)
+    {
+        /* Not rewindable, fade the next frames of the ring instead */
+        unsigned int uiGot = alsa_ring_read(&psAlsaConfig->sRing,
+                psAlsaConfig->psPeriodBuf, uiFade);
+
+        if (uiGot > 0)
+        {
+            sem_post(&psAlsaConfig->semSpace);
+        }
+        alsa_render_block(psAlsaConfig, uiGot, -1, AAP_TRUE);
+    }
+    alsa_render_play_out(psAlsaConfig);
+}
+
+/* Scales the rewound frames of the history down by a Q16 gain, reached
+ * linearly over the first uiRamp of them */
+static void alsa_render_rescale(AlsaConfig *psAlsaConfig, unsigned int uiPos,
+        unsigned int uiFrames, int iGainQ16, unsigned int uiRamp)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiCap = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        short *psFrame = psAlsaConfig->psHistory + uiPos * uiChannels;
+        int iGain = (i < uiRamp) ? 65536 + static_cast<int>(
+                (static_cast<int64_t>(iGainQ16 - 65536) * (i + 1)) / uiRamp) :
+            iGainQ16;
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            psFrame[c] = static_cast<short>((psFrame[c] * iGain) >> 16);
+        }
+        uiPos = (uiPos + 1 < uiCap) ? uiPos + 1 : 0;
+    }
+}
+
+/* Applies a lowered bus gain to what the PCM has queued instead of from
+ * the next period on, the ramp to it starts right after the guard. */
+static void alsa_render_preempt(AlsaConfig *psAlsaConfig)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiCap = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+    unsigned int uiRamp = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_RENDER_FADE_MS) / 1000;
+    unsigned int uiPos = 0;
+    unsigned int uiRewound;
+    unsigned int uiDone = 0;
+    float fRatio = 1.0f;
+
+    uiRewound = alsa_render_rewind(psAlsaConfig,
+            static_cast<unsigned int>(psAlsaConfig->bufferSize), &uiPos);
+    if (0 == uiRewound)
+    {
+        /* Not running or not rewindable, the bus ramps it in as usual */
+        return;
+    }
+    if (alsa_bus_take_gain(&psAlsaConfig->sBus, &fRatio))
+    {
+        alsa_render_rescale(psAlsaConfig, uiPos, uiRewound,
+                static_cast<int>(fRatio * 65536.0f), uiRamp);
+        ++psAlsaConfig->ulPreemptions;
+    }
+    /* Written again from the history, in at most two runs */
+    while (uiDone < uiRewound)
+    {
+        unsigned int uiRun = (uiCap - uiPos < uiRewound - uiDone) ?
+            uiCap - uiPos : uiRewound - uiDone;
+        snd_pcm_sframes_t n = alsa_render_pcm_write(psAlsaConfig,
+                psAlsaConfig->psHistory + uiPos * uiChannels, uiRun);
+
+        if (n <= 0)
+        {
+            alsa_render_recover(psAlsaConfig, (n < 0) ? n : -EPIPE);
+            break;
+        }
+        uiDone += n;
+        uiPos = (uiPos + n < uiCap) ? uiPos + n : 0;
+        psAlsaConfig->uiHistoryPos = uiPos;
+    }
+}
+
+/* Fades the uiGot frames read from ring position ulFirst out before the
+ * last input format change and in after it. The fade out starts at unity
+ * where it starts, shortened when frames before the change already went
+ * out at full gain. */
+static void alsa_render_splice(AlsaConfig *psAlsaConfig, unsigned long ulFirst,
+        unsigned int uiGot)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    long const lFade = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_RENDER_FADE_MS) / 1000;
+    unsigned int const uiSeq = psAlsaConfig->uiSpliceSeq;
+    long lAt;
+    long lFrom;
+    long lStart;
+    long lEnd;
+
+    if ((uiSeq != psAlsaConfig->uiSpliceSeen) && (0 == (uiSeq & 1)))
+    {
+        unsigned long ulAt;
+
+        __sync_synchronize();
+        ulAt = psAlsaConfig->ulSpliceFrame;
+        __sync_synchronize();
+        if (uiSeq == psAlsaConfig->uiSpliceSeq)
+        {
+            psAlsaConfig->uiSpliceSeen = uiSeq;
+            psAlsaConfig->ulSpliceAt = ulAt;
+            /* Frames before this period were written at full gain */
+            psAlsaConfig->ulSpliceFadeFrom =
+                (static_cast<long>(ulAt - ulFirst) > lFade) ? ulAt - lFade : ulFirst;
+            psAlsaConfig->bSplice = AAP_TRUE;
+        }
+    }
+    if (!psAlsaConfig->bSplice)
+    {
+        return;
+    }
+
+    /* Where the change and the start of its fade out are in psPeriodBuf */
+    lAt = static_cast<long>(psAlsaConfig->ulSpliceAt - ulFirst);
+    lFrom = static_cast<long>(psAlsaConfig->ulSpliceFadeFrom - ulFirst);
+    if (lAt > lFrom)
+    {
+        long const lLen = lAt - lFrom;
+
+        lStart = (lFrom > 0) ? lFrom : 0;
+        lEnd = (lAt < static_cast<long>(uiGot)) ? lAt : static_cast<long>(uiGot);
+        if (lStart < lEnd)
+        {
+            psAlsaConfig->pfRamp(psAlsaConfig->psPeriodBuf + lStart * uiChannels,
+                    lEnd - lStart, uiChannels,
+                    static_cast<int>((32768 * (lAt - lStart)) / lLen),
+                    static_cast<int>((32768 * (lAt - lEnd)) / lLen));
+        }
+        lStart = (lAt > 0) ? lAt : 0;
+        lEnd = (lAt + lFade < static_cast<long>(uiGot)) ? lAt + lFade : static_cast<long>(uiGot);
+        if (lStart < lEnd)
+        {
+            psAlsaConfig->pfRamp(psAlsaConfig->psPeriodBuf + lStart * uiChannels,
+                    lEnd - lStart, uiChannels,
+                    static_cast<int>((32768 * (lStart - lAt)) / lFade),
+                    static_cast<int>((32768 * (lEnd - lAt)) / lFade));
+        }
+    }
+    if (lAt + lFade <= static_cast<long>(uiGot))
+    {
+        /* Faded across, done with this change */
+        psAlsaConfig->bSplice = AAP_FALSE;
+    }
+}
+
+/* The end of a drained stream is due to leave the DAC at ullFrame */
+static void alsa_render_eos_at(AlsaConfig *psAlsaConfig, unsigned long long ullFrame)
+{
+    psAlsaConfig->ullEosFrame = ullFrame;
+    psAlsaConfig->bEosPending = AAP_TRUE;
+    __sync_synchronize();
+    psAlsaConfig->bDrain = AAP_FALSE;
+}
+
+/* Writes a period read from the ring holding the last frame of a drained
+ * stream, uiEnd frames into it */
+static int alsa_render_drain_end(AlsaConfig *psAlsaConfig, unsigned int uiGot,
+        unsigned int uiEnd, long lQueued, AAP_BOOL bStarving)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiFrames = psAlsaConfig->periodSize;
+    unsigned long long const ullDataEnd = psAlsaConfig->ullDataEndFrames;
+    unsigned long long const ullBefore = psAlsaConfig->ullWrittenFrames;
+    int iRet;
+
+    if (uiGot < uiFrames)
+    {
+        /* Nothing follows yet, the stream ends as it was sent */
+        memset(psAlsaConfig->psPeriodBuf + uiGot * uiChannels, 0x0,
+                (uiFrames - uiGot) * uiChannels * sizeof(short));
+        if (0 == alsa_ring_fill(&psAlsaConfig->sRing))
+        {
+            /* Let the PCM run dry quietly after it */
+            psAlsaConfig->bIdle = AAP_TRUE;
+        }
+        lQueued = -1;
+        bStarving = AAP_FALSE;
+    }
+    iRet = alsa_render_block(psAlsaConfig, uiGot, lQueued, bStarving);
+    alsa_render_eos_at(psAlsaConfig, (0 == uiEnd) ? ullDataEnd :
+            ullBefore + ((psAlsaConfig->ullWrittenFrames - ullBefore) * uiEnd) / uiFrames);
+    /* The stream ends here, the steady state with it */
+    alsa_render_rt_leave(psAlsaConfig);
+    printf("AP::Stream end written\n");
+    return iRet;
+}
+
+/* Renders one period from the ring. lQueued is the PCM fill, negative while
+ * the PCM is not running. */
+static int alsa_render_period(AlsaConfig *psAlsaConfig, long lQueued,
+        AAP_BOOL bStarving)
+{
+    unsigned int uiFill = alsa_ring_fill(&psAlsaConfig->sRing);
+    unsigned long const ulFirst = psAlsaConfig->sRing.ulRead;
+    unsigned int uiGot;
+
+    uiGot = alsa_ring_read(&psAlsaConfig->sRing, psAlsaConfig->psPeriodBuf,
+            psAlsaConfig->periodSize);
+    if (uiGot > 0)
+    {
+        sem_post(&psAlsaConfig->semSpace);
+    }
+    if (uiGot > 0)
+    {
+        alsa_render_splice(psAlsaConfig, ulFirst, uiGot);
+    }
+    if (psAlsaConfig->bDrain && (psAlsaConfig->ulDrainFrame - ulFirst <= uiGot))
+    {
+        return alsa_render_drain_end(psAlsaConfig, uiGot,
+                static_cast<unsigned int>(psAlsaConfig->ulDrainFrame - ulFirst),
+                (lQueued >= 0) ? lQueued + uiFill : -1, bStarving);
+    }
+    return alsa_render_block(psAlsaConfig, uiGot,
+            (lQueued >= 0) ? lQueued + uiFill : -1, bStarving);
+}
+
+#if ALSA_TSCHED
+/* Timer mode: sleeps until the PCM has played down to the watermark, the
+ * guard plus twice the timer lateness seen lately. Returns AAP_FALSE
+ * without sleeping when the PCM is down to it already. */
+static AAP_BOOL alsa_render_tsched_wait(AlsaConfig *psAlsaConfig, long lQueued,
+        long lGuard)
+{
+    unsigned long long ullMarginNs = 2 * psAlsaConfig->ullJitterNs;
+    unsigned long long ullDeadline;
+    unsigned long long ullNow;
+    long long llSleepNs;
+    struct itimerspec sTimer;
+    struct pollfd asFds[2];
+    uint64_t ullCount;
+
+    if (ullMarginNs < ALSA_TSCHED_MIN_MARGIN_US * 1000ULL)
+    {
+        ullMarginNs = ALSA_TSCHED_MIN_MARGIN_US * 1000ULL;
+    }
+    llSleepNs = ((lQueued - lGuard) * 1000000000LL) /
+        psAlsaConfig->psAudioConfig->eAudioFreq -
+        static_cast<long long>(ullMarginNs);
+    if (llSleepNs <= 0)
+    {
+        return AAP_FALSE;
+    }
+
+    ullDeadline = alsa_render_now_ns() + llSleepNs;
+    memset(&sTimer, 0x0, sizeof(sTimer));
+    sTimer.it_value.tv_sec = ullDeadline / 1000000000ULL;
+    sTimer.it_value.tv_nsec = ullDeadline % 1000000000ULL;
+    /* An expiry left over from a sleep cut short must not end this one */
+    while (read(psAlsaConfig->iTimerFd, &ullCount, sizeof(ullCount)) > 0)
+    {
+    }
+    timerfd_settime(psAlsaConfig->iTimerFd, TFD_TIMER_ABSTIME, &sTimer, NULL);
+
+    asFds[0].fd = psAlsaConfig->iTimerFd;
+    asFds[0].events = POLLIN;
+    asFds[1].fd = psAlsaConfig->iWakeFd;
+    asFds[1].events = POLLIN;
+    if (poll(asFds, 2, -1) <= 0)
+    {
+        return AAP_TRUE;
+    }
+    if (asFds[1].revents & POLLIN)
+    {
+        /* A request, the data that came with it can wait */
+        while (read(psAlsaConfig->iWakeFd, &ullCount, sizeof(ullCount)) > 0)
+        {
+        }
+    }
+    if (asFds[0].revents & POLLIN)
+    {
+        ullNow = alsa_render_now_ns();
+        ullNow = (ullNow > ullDeadline) ? ullNow - ullDeadline : 0;
+        /* Peak lateness, forgotten slowly */
+        psAlsaConfig->ullJitterNs = (ullNow > psAlsaConfig->ullJitterNs) ? ullNow :
+            psAlsaConfig->ullJitterNs - psAlsaConfig->ullJitterNs / 64;
+        ++psAlsaConfig->ulTimerWakeups;
+    }
+    return AAP_TRUE;
+}
+#endif
+
+/* Pull mode: asks the application for the next period just as the PCM has
+ * room for it. The source runs off the same clock, nothing to steer. */
+static void alsa_render_pull(AlsaConfig *psAlsaConfig, snd_pcm_state_t eState,
+        unsigned long ulIdleLimit)
+{
+    unsigned int const uiFrameBytes = 2 * psAlsaConfig->psAudioConfig->uiChannels;
+    AAPPlayerPullBuffer sPull;
+    unsigned int uiGot;
+
+    /* Anything pushed before pull mode was set is not wanted anymore */
+    if (alsa_ring_fill(&psAlsaConfig->sRing) > 0)
+    {
+        alsa_ring_skip(&psAlsaConfig->sRing, alsa_ring_fill(&psAlsaConfig->sRing));
+        sem_post(&psAlsaConfig->semSpace);
+    }
+
+    sPull.pucData = reinterpret_cast<AAP_UCHAR *>(psAlsaConfig->psPeriodBuf);
+    sPull.uiSize = psAlsaConfig->periodSize * uiFrameBytes;
+    sPull.uiFilled = 0;
+    if (psAlsaConfig->pfEventFunc)
+    {
+        psAlsaConfig->pfEventFunc(E_AAP_PLAYER_INPUT_BUFFER,
+                sizeof(sPull),
+                &sPull,
+                psAlsaConfig->pvUserParam);
+    }
+    uiGot = ((sPull.uiFilled < sPull.uiSize) ? sPull.uiFilled : sPull.uiSize) /
+        uiFrameBytes;
+
+    if (uiGot >= psAlsaConfig->periodSize)
+    {
+        psAlsaConfig->bIdle = AAP_FALSE;
+        alsa_render_block(psAlsaConfig, uiGot, -1, AAP_FALSE);
+        alsa_render_rt_warm(psAlsaConfig, eState);
+        return;
+    }
+    if ((SND_PCM_STATE_RUNNING == eState) && !psAlsaConfig->bIdle &&
+            ((uiGot > 0) || (psAlsaConfig->ulIdleFrames < ulIdleLimit)))
+    {
+        /* Short of data, keep the PCM going with faded silence */
+        alsa_render_block(psAlsaConfig, uiGot, -1, AAP_TRUE);
+        return;
+    }
+    if (uiGot > 0)
+    {
+        /* Not started yet or run dry, play what came in faded */
+        psAlsaConfig->bIdle = AAP_FALSE;
+        alsa_render_block(psAlsaConfig, uiGot, -1, AAP_TRUE);
+        return;
+    }
+    if (!psAlsaConfig->bIdle && (SND_PCM_STATE_RUNNING == eState))
+    {
+        alsa_render_rt_leave(psAlsaConfig);
+        printf("AP::No data, stopping silence fill\n");
+        psAlsaConfig->bIdle = AAP_TRUE;
+    }
+    /* Ask again in a period */
+    alsa_render_sem_wait(&psAlsaConfig->semData,
+            (psAlsaConfig->periodSize * 1000) /
+            psAlsaConfig->psAudioConfig->eAudioFreq + 1);
+}
+
+/* One step of the suspend recovery. Waits for the next attempt while it is
+ * not due, so requests are still picked up in between. */
+static void alsa_render_resume_step(AlsaConfig *psAlsaConfig)
+{
+    unsigned long long ullNow = alsa_render_now_ms();
+    unsigned int uiStale;
+    int iErr;
+
+    if (ullNow < psAlsaConfig->ullResumeAtMs)
+    {
+        alsa_render_sem_wait(&psAlsaConfig->semData,
+                static_cast<unsigned int>(psAlsaConfig->ullResumeAtMs - ullNow));
+        return;
+    }
+
+    iErr = snd_pcm_resume(psAlsaConfig->pcmHandleOut);
+    if ((-EAGAIN == iErr) &&
+            (++psAlsaConfig->uiResumeTries < ALSA_RESUME_MAX_TRIES))
+    {
+        psAlsaConfig->ullResumeAtMs = ullNow + ALSA_RESUME_POLL_MS;
+        return;
+    }
+    if (0 != iErr)
+    {
+        /* Resume not supported or timed out, start over */
+        iErr = snd_pcm_prepare(psAlsaConfig->pcmHandleOut);
+        if (0 != iErr)
+        {
+            printf("ERR::AP::Prepare after suspend failed %d\n", iErr);
+            alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_FACED_ERROR);
+        }
+    }
+
+    /* Whatever piled up beyond one fill during the suspend is stale */
+    uiStale = alsa_ring_fill(&psAlsaConfig->sRing);
+    if (uiStale > psAlsaConfig->fillSize)
+    {
+        uiStale = alsa_ring_skip(&psAlsaConfig->sRing,
+                uiStale - psAlsaConfig->fillSize);
+        __sync_fetch_and_add(&psAlsaConfig->ulSuspendDropped, uiStale);
+        sem_post(&psAlsaConfig->semSpace);
+    }
+    alsa_drift_reset(&psAlsaConfig->sDrift);
+    psAlsaConfig->bFadeIn = AAP_TRUE;
+    psAlsaConfig->bSuspended = AAP_FALSE;
+    printf("AP::PCM resumed after %u tries\n", psAlsaConfig->uiResumeTries);
+    alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_PLAYING);
+}
+
+/* Raises EOS once the end of a drained stream has left the DAC. Returns
+ * the frames until it does, -1 when no EOS is pending. */
+static long alsa_render_eos(AlsaConfig *psAlsaConfig)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    snd_pcm_status_t *psStatus;
+    snd_pcm_state_t eState = SND_PCM_STATE_DISCONNECTED;
+    snd_pcm_sframes_t delay = 0;
+    unsigned long long ullHw;
+
+    if (psAlsaConfig->bDrain && (static_cast<long>(psAlsaConfig->sRing.ulRead -
+                    psAlsaConfig->ulDrainFrame) >= 0))
+    {
+        /* Nothing of the stream is left in the ring, it was all written
+         * before the drain or dropped from it */
+        alsa_render_eos_at(psAlsaConfig, psAlsaConfig->ullDataEndFrames);
+    }
+    if (!psAlsaConfig->bEosPending)
+    {
+        return -1;
+    }
+    snd_pcm_status_alloca(&psStatus);
+    if (0 == snd_pcm_status(pcmHandle, psStatus))
+    {
+        eState = snd_pcm_status_get_state(psStatus);
+        delay = snd_pcm_status_get_delay(psStatus);
+    }
+    if ((SND_PCM_STATE_SUSPENDED == eState) || (SND_PCM_STATE_PAUSED == eState))
+    {
+        /* Plays on with what it has queued once back */
+        return static_cast<long>(psAlsaConfig->periodSize);
+    }
+    ullHw = psAlsaConfig->ullWrittenFrames - static_cast<unsigned long long>(delay);
+    if (((SND_PCM_STATE_RUNNING == eState) || (SND_PCM_STATE_PREPARED == eState)) &&
+            (delay > 0) && (ullHw < psAlsaConfig->ullEosFrame))
+    {
+        if (SND_PCM_STATE_PREPARED == eState)
+        {
+            /* A stream shorter than the start threshold */
+            snd_pcm_start(pcmHandle);
+        }
+        return static_cast<long>(psAlsaConfig->ullEosFrame - ullHw);
+    }
+    /* Played, or dropped with all the PCM had queued */
+    psAlsaConfig->bEosPending = AAP_FALSE;
+    alsa_render_rt_leave(psAlsaConfig);
+    printf("AP::End of stream played\n");
+    alsa_render_notify_error(psAlsaConfig, E_AAP_ERROR_PLAYER_EOS);
+    return -1;
+}
+
+/* Queue level to sleep down to, the guard unless EOS is due before */
+static long alsa_render_wake_level(long lQueued, long lGuard, long lEos)
+{
+    if ((lEos >= 0) && (lQueued - lEos > lGuard))
+    {
+        return lQueued - lEos;
+    }
+    return lGuard;
+}
+
+/* Frames the PCM is never let down to while running */
+static long alsa_render_guard(const AlsaConfig *psAlsaConfig)
+{
+    long const lPeriod = static_cast<long>(psAlsaConfig->periodSize);
+#if ALSA_TSCHED
+    /* Chunks are small, guard a quarter of the fill as periods would, of
+     * the fill at init at most */
+    long const lQuarter = static_cast<long>(
+            (psAlsaConfig->fillSize / 4 < psAlsaConfig->guardSize) ?
+            psAlsaConfig->fillSize / 4 : psAlsaConfig->guardSize);
+
+    return (lQuarter > lPeriod) ? lQuarter : lPeriod;
+#else
+    return lPeriod;
+#endif
+}
+
+#if !ALSA_TSCHED
+/* Gives the PCM a buffer for a latency the one it has cannot hold. What is
+ * queued is played out first, ending in a fade, so nothing is dropped. The
+ * thread sleeps through that, up to a buffer, and takes no data or requests
+ * until it is done. When the PCM takes neither the new buffer nor the old
+ * one back, it is left failed and an error returned. */
+static int alsa_render_reparam(AlsaConfig *psAlsaConfig, unsigned int uiLatencyMs)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    unsigned int const uiOldUs = static_cast<unsigned int>(
+            (psAlsaConfig->bufferSize * 1000000ULL) / uiRate);
+    snd_pcm_uframes_t bufferSize = 0;
+    snd_pcm_uframes_t periodSize = 0;
+    int iErr;
+
+    alsa_render_fade_out(psAlsaConfig, AAP_FALSE);
+    snd_pcm_drop(pcmHandle);
+    iErr = snd_pcm_set_params(pcmHandle, psAlsaConfig->format,
+            SND_PCM_ACCESS_RW_INTERLEAVED, uiChannels, uiRate, !psAlsaConfig->bNative,
+            uiLatencyMs * 1000);
+    if (0 == iErr)
+    {
+        iErr = snd_pcm_get_params(pcmHandle, &bufferSize, &periodSize);
+    }
+    if ((0 == iErr) && (bufferSize > psAlsaConfig->uiHistoryFrames))
+    {
+        iErr = -ENOMEM;
+    }
+    if (0 != iErr)
+    {
+        printf("ERR::AP::Buffer for %u ms not set %d\n", uiLatencyMs, iErr);
+        if ((0 != snd_pcm_set_params(pcmHandle, psAlsaConfig->format,
+                        SND_PCM_ACCESS_RW_INTERLEAVED, uiChannels, uiRate,
+                        !psAlsaConfig->bNative, uiOldUs)) ||
+                (0 != snd_pcm_get_params(pcmHandle, &bufferSize, &periodSize)))
+        {
+            printf("ERR::AP::Buffer not restored\n");
+            psAlsaConfig->bFailed = AAP_TRUE;
+            alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_FACED_ERROR);
+            return AAP_ERR_SYS_CALL_FAILED;
+        }
+    }
+    iErr = snd_pcm_prepare(pcmHandle);
+    if (0 != iErr)
+    {
+        printf("ERR::AP::PCM not prepared %d\n", iErr);
+        psAlsaConfig->bFailed = AAP_TRUE;
+        alsa_render_notify(psAlsaConfig, E_AAP_PLAYER_FACED_ERROR);
+        return AAP_ERR_SYS_CALL_FAILED;
+    }
+    printf("AP::Buffer size=%lu, period size=%lu\n", bufferSize, periodSize);
+    /* The render chunk stays, it sizes the buffers of the path */
+    psAlsaConfig->bufferSize = bufferSize;
+    psAlsaConfig->uiHistoryPos = 0;
+    psAlsaConfig->bFadeIn = AAP_TRUE;
+    alsa_drift_reset(&psAlsaConfig->sDrift);
+    return 0;
+}
+#endif
+
+/* Frames queued in the ring and the PCM together */
+static unsigned long alsa_render_queued(AlsaConfig *psAlsaConfig)
+{
+    snd_pcm_sframes_t delay = 0;
+
+    snd_pcm_delay(psAlsaConfig->pcmHandleOut, &delay);
+    return alsa_ring_fill(&psAlsaConfig->sRing) +
+        static_cast<unsigned long>((delay > 0) ? delay : 0);
+}
+
+/* Moves the fill to the latency asked for, or the deep buffer one. Within
+ * the buffer only the software side changes: a deeper fill is grown into, a
+ * shallower one is drained to. Leaving deep buffering cuts what is queued
+ * beyond the latency at once instead. A latency beyond the buffer
+ * reconfigures the PCM. */
+static void alsa_render_set_fill(AlsaConfig *psAlsaConfig)
+{
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    unsigned int const uiLatencyMs = psAlsaConfig->uiLatencyMs;
+    AAP_BOOL const bDeep = psAlsaConfig->bDeepBuffer;
+    snd_pcm_uframes_t fill = (static_cast<snd_pcm_uframes_t>(uiRate) * uiLatencyMs) / 1000;
+    AAP_BOOL bReparam = AAP_FALSE;
+    snd_pcm_sw_params_t *psSwParams;
+    snd_pcm_uframes_t fillMax;
+    int iErr;
+
+    if (bDeep && (fill < (uiRate * ALSA_DEEP_BUFFER_MS) / 1000))
+    {
+        fill = (uiRate * ALSA_DEEP_BUFFER_MS) / 1000;
+    }
+#if ALSA_TSCHED
+    /* The buffer is as large as latencies go, the fill stays a chunk short */
+    fillMax = psAlsaConfig->bufferSize - psAlsaConfig->periodSize;
+#else
+    if (fill > psAlsaConfig->bufferSize)
+    {
+        bReparam = AAP_TRUE;
+        if (0 != alsa_render_reparam(psAlsaConfig, uiLatencyMs))
+        {
+            return;
+        }
+    }
+    fillMax = psAlsaConfig->bufferSize;
+#endif
+    fill = (fill > fillMax) ? fillMax : fill;
+    /* The thread renders a chunk at a time above the guard */
+    fill = (fill < 2 * psAlsaConfig->periodSize) ? 2 * psAlsaConfig->periodSize : fill;
+    if ((fill == psAlsaConfig->fillSize) && !bReparam)
+    {
+        return;
+    }
+
+    if (psAlsaConfig->bDeepFill && !bDeep && (fill < psAlsaConfig->fillSize) &&
+            (SND_PCM_STATE_RUNNING == snd_pcm_state(pcmHandle)) &&
+            (alsa_render_queued(psAlsaConfig) > fill))
+    {
+        /* Only what is queued beyond the new fill is dropped: the newest
+         * of the PCM, less the fade written again, then the oldest of the
+         * ring when rewinding did not reach that far */
+        unsigned long const ulExcess = alsa_render_queued(psAlsaConfig) - fill;
+        unsigned int uiFade = (uiRate * ALSA_RENDER_TRANSITION_MS) / 1000;
+
+        uiFade = (uiFade < psAlsaConfig->periodSize) ? uiFade :
+            static_cast<unsigned int>(psAlsaConfig->periodSize);
+        if (alsa_render_cut(psAlsaConfig, static_cast<unsigned int>(
+                        (ulExcess + uiFade < psAlsaConfig->bufferSize) ?
+                        ulExcess + uiFade : psAlsaConfig->bufferSize)))
+        {
+            unsigned long const ulRing = alsa_ring_fill(&psAlsaConfig->sRing);
+            unsigned long const ulQueued = alsa_render_queued(psAlsaConfig);
+
+            if (ulQueued > fill)
+            {
+                unsigned long ulDrop = ulQueued - fill;
+
+                alsa_ring_skip(&psAlsaConfig->sRing, (ulDrop < ulRing) ? ulDrop : ulRing);
+                sem_post(&psAlsaConfig->semSpace);
+            }
+            psAlsaConfig->bFadeIn = AAP_TRUE;
+            alsa_drift_reset(&psAlsaConfig->sDrift);
+        }
+    }
+    psAlsaConfig->bDeepFill = bDeep;
+    psAlsaConfig->fillSize = fill;
+    alsa_drift_set_target(&psAlsaConfig->sDrift, fill);
+
+    /* Restarts prebuffer the whole fill, and the PCM wakes the thread once
+     * a chunk of it is free */
+    snd_pcm_sw_params_alloca(&psSwParams);
+    iErr = snd_pcm_sw_params_current(pcmHandle, psSwParams);
+    if (0 == iErr)
+    {
+        iErr = snd_pcm_sw_params_set_start_threshold(pcmHandle, psSwParams, fill);
+    }
+    if (0 == iErr)
+    {
+        iErr = snd_pcm_sw_params_set_avail_min(pcmHandle, psSwParams,
+                psAlsaConfig->bufferSize - fill + psAlsaConfig->periodSize);
+    }
+    if (0 == iErr)
+    {
+        iErr = snd_pcm_sw_params(pcmHandle, psSwParams);
+    }
+    if (0 != iErr)
+    {
+        printf("ERR::AP::Fill thresholds not set %d\n", iErr);
+    }
+    printf("AP::Fill %lu frames\n", fill);
+}
+
+static void alsa_render_handle_requests(AlsaConfig *psAlsaConfig)
+{
+    unsigned int uiReq = __sync_fetch_and_and(&psAlsaConfig->uiRenderReq, 0);
+
+    if (0 != uiReq)
+    {
+        alsa_render_rt_leave(psAlsaConfig);
+    }
+
+    if (uiReq & (ALSA_RENDER_REQ_PAUSE | ALSA_RENDER_REQ_STOP))
+    {
+        alsa_render_fade_out(psAlsaConfig, AAP_TRUE);
+        snd_pcm_drop(psAlsaConfig->pcmHandleOut);
+        snd_pcm_prepare(psAlsaConfig->pcmHandleOut);
+        alsa_drift_reset(&psAlsaConfig->sDrift);
+        if ((uiReq & ALSA_RENDER_REQ_STOP) &&
+                (alsa_ring_fill(&psAlsaConfig->sRing) > 0))
+        {
+            alsa_ring_skip(&psAlsaConfig->sRing, alsa_ring_fill(&psAlsaConfig->sRing));
+            sem_post(&psAlsaConfig->semSpace);
+        }
+        psAlsaConfig->bHalted = AAP_TRUE;
+        /* A producer waiting for space finds it halted */
+        sem_post(&psAlsaConfig->semSpace);
+        printf("AP::Output %s\n", (uiReq & ALSA_RENDER_REQ_STOP) ? "stopped" : "paused");
+    }
+    if ((uiReq & ALSA_RENDER_REQ_PREEMPT) && !psAlsaConfig->bHalted)
+    {
+        alsa_render_preempt(psAlsaConfig);
+    }
+    if (uiReq & ALSA_RENDER_REQ_FILL)
+    {
+        alsa_render_set_fill(psAlsaConfig);
+    }
+    if (uiReq & ALSA_RENDER_REQ_RESTART)
+    {
+        alsa_render_fade_out(psAlsaConfig, AAP_TRUE);
+        snd_pcm_drop(psAlsaConfig->pcmHandleOut);
+        if (0 == snd_pcm_prepare(psAlsaConfig->pcmHandleOut))
+        {
+            /* Play tries a failed PCM again */
+            psAlsaConfig->bFailed = AAP_FALSE;
+        }
+        alsa_drift_reset(&psAlsaConfig->sDrift);
+        psAlsaConfig->bFadeIn = AAP_TRUE;
+        psAlsaConfig->bIdle = AAP_FALSE;
+        psAlsaConfig->bHalted = AAP_FALSE;
+        psAlsaConfig->ulIdleFrames = 0;
+    }
+}
+
+static void *alsa_render_thread(void *pvArg)
+{
+    AlsaConfig *psAlsaConfig = static_cast<AlsaConfig *>(pvArg);
+    snd_pcm_t *const pcmHandle = psAlsaConfig->pcmHandleOut;
+    unsigned int const uiRate = psAlsaConfig->psAudioConfig->eAudioFreq;
+    snd_pcm_uframes_t const period = psAlsaConfig->periodSize;
+    /* Frames held back in the ring so that there is always something left
+     * to fade out when the data stops. */
+    unsigned int const uiReserve = (ALSA_UNDERRUN_AVOIDANCE) ?
+        (uiRate * ALSA_RENDER_FADE_MS) / 1000 : 0;
+    unsigned long const ulIdleLimit = (uiRate / 1000) * ALSA_RENDER_IDLE_MS;
+
+    alsa_thread_lock_stack(AAP_TRUE);
+    while (psAlsaConfig->bRenderRun)
+    {
+        snd_pcm_sframes_t avail;
+        snd_pcm_state_t eState;
+        long lQueued;
+        long lGuard;
+        long lEos;
+        int iErr;
+
+        alsa_render_handle_requests(psAlsaConfig);
+        if (psAlsaConfig->bFailed)
+        {
+            /* Reported once, only play or stop changes that */
+            alsa_render_sem_wait(&psAlsaConfig->semData, ALSA_RENDER_POLL_MS);
+            continue;
+        }
+        if (alsa_render_watchdog(psAlsaConfig))
+        {
+            continue;
+        }
+        lEos = alsa_render_eos(psAlsaConfig);
+        lGuard = alsa_render_guard(psAlsaConfig);
+        if (psAlsaConfig->bSuspended)
+        {
+            alsa_render_rt_leave(psAlsaConfig);
+            alsa_render_resume_step(psAlsaConfig);
+            continue;
+        }
+        if (psAlsaConfig->bHalted)
+        {
+            /* Paused or stopped, only a request changes that */
+            alsa_render_sem_wait(&psAlsaConfig->semData, ALSA_RENDER_POLL_MS);
+            continue;
+        }
+
+#if ALSA_TSCHED
+        /* No interrupt keeps the hardware pointer current, ask for it */
+        avail = snd_pcm_avail(pcmHandle);
+#else
+        avail = snd_pcm_avail_update(pcmHandle);
+#endif
+        if (avail < 0)
+        {
+            alsa_render_recover(psAlsaConfig, avail);
+            continue;
+        }
+        /* Room up to the fill kept, all of the buffer but in timer mode */
+        avail -= static_cast<snd_pcm_sframes_t>(psAlsaConfig->bufferSize -
+                psAlsaConfig->fillSize);
+        eState = snd_pcm_state(pcmHandle);
+        if (avail < static_cast<snd_pcm_sframes_t>(period))
+        {
+            if (SND_PCM_STATE_PREPARED == eState)
+            {
+                /* Resampling may leave the queue a few frames short of the
+                 * start threshold, the buffer is as full as it gets. */
+                snd_pcm_start(pcmHandle);
+                continue;
+            }
+#if ALSA_TSCHED
+            if (SND_PCM_STATE_RUNNING == eState)
+            {
+                lQueued = static_cast<long>(psAlsaConfig->fillSize) - avail;
+                if (!alsa_render_tsched_wait(psAlsaConfig, lQueued,
+                            alsa_render_wake_level(lQueued, lGuard, lEos)))
+                {
+                    alsa_render_sem_wait(&psAlsaConfig->semData, 1);
+                }
+                continue;
+            }
+#endif
+            iErr = snd_pcm_wait(pcmHandle, ((lEos >= 0) &&
+                        (lEos * 1000 < static_cast<long>(ALSA_RENDER_POLL_MS * uiRate))) ?
+                    static_cast<int>((lEos * 1000) / uiRate) + 1 : ALSA_RENDER_POLL_MS);
+            if (iErr < 0)
+            {
+                alsa_render_recover(psAlsaConfig, iErr);
+            }
+            continue;
+        }
+        lQueued = static_cast<long>(psAlsaConfig->fillSize) - avail;
+        if (lQueued < 0)
+        {
+            lQueued = 0;
+        }
+
+        if (psAlsaConfig->bPull)
+        {
+            alsa_render_pull(psAlsaConfig, eState, ulIdleLimit);
+            continue;
+        }
+
+        if (alsa_ring_fill(&psAlsaConfig->sRing) >= period + uiReserve)
+        {
+            psAlsaConfig->bIdle = AAP_FALSE;
+            alsa_render_period(psAlsaConfig,
+                    (SND_PCM_STATE_RUNNING == eState) ? lQueued : -1, AAP_FALSE);
+            alsa_render_rt_warm(psAlsaConfig, eState);
+            continue;
+        }
+
+        if (psAlsaConfig->bDrain && (alsa_ring_fill(&psAlsaConfig->sRing) > 0) &&
+                ((SND_PCM_STATE_RUNNING != eState) || (lQueued <= lGuard)))
+        {
+            /* The end of a drained stream, short of a period */
+            psAlsaConfig->bIdle = AAP_FALSE;
+            alsa_render_period(psAlsaConfig, -1, AAP_FALSE);
+            continue;
+        }
+
+        if ((ALSA_UNDERRUN_AVOIDANCE) && !psAlsaConfig->bIdle &&
+                (SND_PCM_STATE_RUNNING == eState) && (lQueued <= lGuard))
+        {
+            if (psAlsaConfig->ulIdleFrames >= ulIdleLimit)
+            {
+                /* Nothing has come for a while, let the PCM run dry
+                 * quietly instead of playing silence forever. */
+                alsa_render_rt_leave(psAlsaConfig);
+                printf("AP::No data, stopping silence fill\n");
+                psAlsaConfig->bIdle = AAP_TRUE;
+                continue;
+            }
+            alsa_render_period(psAlsaConfig, lQueued, AAP_TRUE);
+            continue;
+        }
+
+        /* Wait for data, but only until the PCM is down to the guard or
+         * the end of a drained stream is due */
+        {
+            unsigned int uiWaitMs = ALSA_RENDER_POLL_MS;
+
+            if ((lEos >= 0) && (lEos * 1000 < static_cast<long>(uiWaitMs * uiRate)))
+            {
+                uiWaitMs = static_cast<unsigned int>((lEos * 1000) / uiRate) + 1;
+            }
+            if ((SND_PCM_STATE_RUNNING == eState) &&
+                    !psAlsaConfig->bIdle && (lQueued > lGuard))
+            {
+                long const lWake = alsa_render_wake_level(lQueued, lGuard, lEos);
+
+#if ALSA_TSCHED
+                /* Data is left to pile up in the ring meanwhile */
+                if (alsa_render_tsched_wait(psAlsaConfig, lQueued, lWake))
+                {
+                    continue;
+                }
+#endif
+                uiWaitMs = static_cast<unsigned int>(
+                        ((lQueued - lWake) * 1000) / uiRate);
+                if (0 == uiWaitMs)
+                {
+                    uiWaitMs = 1;
+                }
+            }
+            alsa_render_sem_wait(&psAlsaConfig->semData, uiWaitMs);
+        }
+    }
+    alsa_render_rt_leave(psAlsaConfig);
+    /* The PCM is closed next, do not leave it cut off */
+    alsa_render_fade_out(psAlsaConfig, AAP_TRUE);
+    alsa_thread_lock_stack(AAP_FALSE);
+    return NULL;
+}
+
+static void alsa_render_lock_mem(AlsaConfig *psAlsaConfig, AAP_BOOL bLock)
+{
+    unsigned int const uiBusSamples = psAlsaConfig->sBus.uiCapFrames *
+        psAlsaConfig->sBus.uiChannels;
+
+    alsa_thread_lock_mem(psAlsaConfig->psPeriodBuf,
+            psAlsaConfig->periodSize * psAlsaConfig->psAudioConfig->uiChannels *
+            sizeof(short), bLock);
+    if (psAlsaConfig->pvExport)
+    {
+        alsa_thread_lock_mem(psAlsaConfig->pvExport,
+                psAlsaConfig->periodSize * psAlsaConfig->psAudioConfig->uiChannels *
+                sizeof(int), bLock);
+    }
+    alsa_thread_lock_mem(psAlsaConfig->sRing.pucBuf,
+            psAlsaConfig->sRing.uiCapFrames * psAlsaConfig->sRing.uiFrameBytes,
+            bLock);
+    alsa_thread_lock_mem(psAlsaConfig->sBus.ptBus, uiBusSamples * sizeof(AlsaBusSample),
+            bLock);
+    if (psAlsaConfig->sBus.pfDither)
+    {
+        alsa_thread_lock_mem(psAlsaConfig->sBus.pfDither, uiBusSamples * sizeof(float),
+                bLock);
+    }
+    alsa_thread_lock_mem(psAlsaConfig->sBus.psOut, uiBusSamples * sizeof(short), bLock);
+    alsa_thread_lock_mem(psAlsaConfig->psHistory,
+            psAlsaConfig->uiHistoryFrames * psAlsaConfig->psAudioConfig->uiChannels *
+            sizeof(short), bLock);
+}
+
+static void alsa_render_close_fds(AlsaConfig *psAlsaConfig)
+{
+    if (psAlsaConfig->iTimerFd >= 0)
+    {
+        close(psAlsaConfig->iTimerFd);
+    }
+    if (psAlsaConfig->iWakeFd >= 0)
+    {
+        close(psAlsaConfig->iWakeFd);
+    }
+    psAlsaConfig->iTimerFd = -1;
+    psAlsaConfig->iWakeFd = -1;
+}
+
+int alsa_render_start(AlsaConfig *psAlsaConfig)
+{
+    unsigned int const uiChannels = psAlsaConfig->psAudioConfig->uiChannels;
+
+    psAlsaConfig->psPeriodBuf = static_cast<short *>(
+            malloc(psAlsaConfig->periodSize * uiChannels * sizeof(short)));
+    /* ALSA may round a buffer up, leave room for twice the largest */
+    psAlsaConfig->uiHistoryFrames = (psAlsaConfig->psAudioConfig->eAudioFreq *
+            ALSA_LATENCY_MAX_MS) / 500;
+    if (psAlsaConfig->uiHistoryFrames < psAlsaConfig->bufferSize)
+    {
+        psAlsaConfig->uiHistoryFrames = static_cast<unsigned int>(psAlsaConfig->bufferSize);
+    }
+    psAlsaConfig->psHistory = static_cast<short *>(
+            calloc(psAlsaConfig->uiHistoryFrames * uiChannels, sizeof(short)));
+    psAlsaConfig->uiHistoryPos = 0;
+    /* S32 and float samples are both four bytes */
+    if (psAlsaConfig->pfExport)
+    {
+        psAlsaConfig->pvExport = malloc(psAlsaConfig->periodSize * uiChannels * sizeof(int));
+    }
+    if ((NULL == psAlsaConfig->psPeriodBuf) || (NULL == psAlsaConfig->psHistory) ||
+            (psAlsaConfig->pfExport && (NULL == psAlsaConfig->pvExport)))
+    {
+        printf("ERR::AP::Period buffer allocation failed!\n");
+        free(psAlsaConfig->psPeriodBuf);
+        free(psAlsaConfig->psHistory);
+        free(psAlsaConfig->pvExport);
+        psAlsaConfig->psPeriodBuf = NULL;
+        psAlsaConfig->psHistory = NULL;
+        psAlsaConfig->pvExport = NULL;
+        return AAP_ERR_OUT_OF_MEM;
+    }
+    psAlsaConfig->iTimerFd = -1;
+    psAlsaConfig->iWakeFd = -1;
+#if ALSA_TSCHED
+    psAlsaConfig->iTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    psAlsaConfig->iWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    if ((0 != sem_init(&psAlsaConfig->semData, 0, 0)) ||
+            (0 != sem_init(&psAlsaConfig->semSpace, 0, 0)) ||
+            (ALSA_TSCHED && ((psAlsaConfig->iTimerFd < 0) ||
+                             (psAlsaConfig->iWakeFd < 0))))
+    {
+        printf("ERR::AP::Render semaphore or timer init failed\n");
+        alsa_render_close_fds(psAlsaConfig);
+        free(psAlsaConfig->psPeriodBuf);
+        free(psAlsaConfig->psHistory);
+        free(psAlsaConfig->pvExport);
+        psAlsaConfig->psPeriodBuf = NULL;
+        psAlsaConfig->psHistory = NULL;
+        psAlsaConfig->pvExport = NULL;
+        return AAP_ERR_SYS_CALL_FAILED;
+    }
+    /* Everything the thread touches per period stays resident */
+    alsa_render_lock_mem(psAlsaConfig, AAP_TRUE);
+    alsa_rt_check_init();
+    psAlsaConfig->ullWrittenFrames = 0;
+    psAlsaConfig->ullHwFrames = 0;
+    psAlsaConfig->ullHwCheckMs = 0;
+    psAlsaConfig->ullHwMovedMs = alsa_render_now_ms();
+    psAlsaConfig->bStalled = AAP_FALSE;
+    psAlsaConfig->bFailed = AAP_FALSE;
+    psAlsaConfig->ullDataEndFrames = 0;
+    psAlsaConfig->bEosPending = AAP_FALSE;
+    psAlsaConfig->bFadeIn = AAP_TRUE;
+    psAlsaConfig->bRenderRun = AAP_TRUE;
+    if (0 != alsa_thread_create(&psAlsaConfig->renderThread,
+                alsa_render_thread, psAlsaConfig))
+    {
+        printf("ERR::AP::Render thread creation failed\n");
+        psAlsaConfig->bRenderRun = AAP_FALSE;
+        sem_destroy(&psAlsaConfig->semData);
+        sem_destroy(&psAlsaConfig->semSpace);
+        alsa_render_close_fds(psAlsaConfig);
+        alsa_render_lock_mem(psAlsaConfig, AAP_FALSE);
+        free(psAlsaConfig->psPeriodBuf);
+        free(psAlsaConfig->psHistory);
+        free(psAlsaConfig->pvExport);
+        psAlsaConfig->psPeriodBuf = NULL;
+        psAlsaConfig->psHistory = NULL;
+        psAlsaConfig->pvExport = NULL;
+        return AAP_ERR_SYS_CALL_FAILED;
+    }
+    psAlsaConfig->bRenderStarted = AAP_TRUE;
+    if (psAlsaConfig->bThreadConfigSet)
+    {
+        alsa_thread_apply_config(psAlsaConfig->renderThread,
+                &psAlsaConfig->sThreadConfig);
+    }
+    return 0;
+}
+
+/* Keeps the scheduling configuration of the render thread and applies it
+ * right away when the thread is running. */
+int alsa_render_set_thread_config(AlsaConfig *psAlsaConfig,
+        const AAP_ThreadConfig *psThreadConfig)
+{
+    psAlsaConfig->sThreadConfig = *psThreadConfig;
+    psAlsaConfig->bThreadConfigSet = AAP_TRUE;
+    if (!psAlsaConfig->bRenderStarted)
+    {
+        return 0;
+    }
+    return alsa_thread_apply_config(psAlsaConfig->renderThread, psThreadConfig);
+}
+
+void alsa_render_stop(AlsaConfig *psAlsaConfig)
+{
+    if (!psAlsaConfig->bRenderStarted)
+    {
+        return;
+    }
+    psAlsaConfig->bRenderRun = AAP_FALSE;
+    alsa_render_wake(psAlsaConfig);
+    sem_post(&psAlsaConfig->semSpace);
+    pthread_join(psAlsaConfig->renderThread, NULL);
+    psAlsaConfig->bRenderStarted = AAP_FALSE;
+
+    printf("AP::Underruns %lu, avoided %lu, silence frames %lu\n",
+            psAlsaConfig->ulXrunCount, psAlsaConfig->ulAvoidedUnderruns,
+            psAlsaConfig->ulSilenceFrames);
+    printf("AP::Suspends %lu, frames dropped while suspended %lu\n",
+            psAlsaConfig->ulSuspendCount, psAlsaConfig->ulSuspendDropped);
+    printf("AP::Stalls %lu, frames dropped for them %lu\n",
+            psAlsaConfig->ulStallCount, psAlsaConfig->ulStallDropped);
+    printf("AP::Frames limited %lu\n", psAlsaConfig->sLimiter.ulLimitedFrames);
+    printf("AP::Transitions faded by rewind %lu, gains preempted %lu, "
+            "frames rewound %lu\n", psAlsaConfig->ulRewindFades,
+            psAlsaConfig->ulPreemptions, psAlsaConfig->ulRewoundFrames);
+#if ALSA_TSCHED
+    printf("AP::Timer wakeups %lu, lateness %llu us\n",
+            psAlsaConfig->ulTimerWakeups, psAlsaConfig->ullJitterNs / 1000);
+#endif
+    alsa_rt_check_report();
+    sem_destroy(&psAlsaConfig->semData);
+    sem_destroy(&psAlsaConfig->semSpace);
+    alsa_render_close_fds(psAlsaConfig);
+    alsa_render_lock_mem(psAlsaConfig, AAP_FALSE);
+    free(psAlsaConfig->psPeriodBuf);
+    free(psAlsaConfig->psHistory);
+    free(psAlsaConfig->pvExport);
+    psAlsaConfig->psPeriodBuf = NULL;
+    psAlsaConfig->psHistory = NULL;
+    psAlsaConfig->pvExport = NULL;
+}
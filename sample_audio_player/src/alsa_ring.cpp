@@ -0,0 +1,165 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_ring.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Lock free single producer / single consumer frame ring.
+ *
+ *   Both indices count frames from the start and are never wrapped, the
+ *   storage position is taken modulo the capacity. The capacity is rounded
+ *   up to a power of two so that the position stays continuous when the
+ *   counters overflow. A full memory barrier separates the data copy from
+ *   the index update on either side.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "alsa_ring.h"
+#include "aap_error_codes.h"
+
+int alsa_ring_init(AlsaRing *psRing, unsigned int uiCapFrames,
+        unsigned int uiFrameBytes)
+{
+    unsigned int uiCap;
+
+    if ((NULL == psRing) || (0 == uiCapFrames) || (0 == uiFrameBytes))
+    {
+        printf("ERR::AP::Invalid ring parameters\n");
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    memset(psRing, 0x0, sizeof(AlsaRing));
+    uiCap = 1;
+    while (uiCap < uiCapFrames)
+    {
+        uiCap <<= 1;
+    }
+    uiCapFrames = uiCap;
+    psRing->pucBuf = static_cast<unsigned char *>(
+            malloc(uiCapFrames * uiFrameBytes));
+    if (NULL == psRing->pucBuf)
+    {
+        printf("ERR::AP::Ring allocation failed!\n");
+        return AAP_ERR_OUT_OF_MEM;
+    }
+    psRing->uiCapFrames = uiCapFrames;
+    psRing->uiFrameBytes = uiFrameBytes;
+    return 0;
+}
+
+unsigned int alsa_ring_fill(const AlsaRing *psRing)
+{
+    return static_cast<unsigned int>(psRing->ulWrite - psRing->ulRead);
+}
+
+unsigned int alsa_ring_space(const AlsaRing *psRing)
+{
+    return psRing->uiCapFrames - alsa_ring_fill(psRing);
+}
+
+unsigned int alsa_ring_write(AlsaRing *psRing, const void *pvData,
+        unsigned int uiFrames)
+{
+    unsigned int uiSpace = alsa_ring_space(psRing);
+    unsigned int uiPos;
+    unsigned int uiFirst;
+    const unsigned char *pucSrc = static_cast<const unsigned char *>(pvData);
+
+    if (uiFrames > uiSpace)
+    {
+        uiFrames = uiSpace;
+    }
+    if (0 == uiFrames)
+    {
+        return 0;
+    }
+    /* Make sure the reader's index is seen before its slots are reused */
+    __sync_synchronize();
+    uiPos = static_cast<unsigned int>(psRing->ulWrite % psRing->uiCapFrames);
+    uiFirst = psRing->uiCapFrames - uiPos;
+    if (uiFirst > uiFrames)
+    {
+        uiFirst = uiFrames;
+    }
+    memcpy(psRing->pucBuf + uiPos * psRing->uiFrameBytes, pucSrc,
+            uiFirst * psRing->uiFrameBytes);
+    memcpy(psRing->pucBuf, pucSrc + uiFirst * psRing->uiFrameBytes,
+            (uiFrames - uiFirst) * psRing->uiFrameBytes);
+    __sync_synchronize();
+    psRing->ulWrite += uiFrames;
+    return uiFrames;
+}
+
+unsigned int alsa_ring_read(AlsaRing *psRing, void *pvData,
+        unsigned int uiFrames)
+{
+    unsigned int uiFill = alsa_ring_fill(psRing);
+    unsigned int uiPos;
+    unsigned int uiFirst;
+    unsigned char *pucDst = static_cast<unsigned char *>(pvData);
+
+    if (uiFrames > uiFill)
+    {
+        uiFrames = uiFill;
+    }
+    if (0 == uiFrames)
+    {
+        return 0;
+    }
+    /* Make sure the writer's data is seen before it is copied out */
+    __sync_synchronize();
+    uiPos = static_cast<unsigned int>(psRing->ulRead % psRing->uiCapFrames);
+    uiFirst = psRing->uiCapFrames - uiPos;
+    if (uiFirst > uiFrames)
+    {
+        uiFirst = uiFrames;
+    }
+    memcpy(pucDst, psRing->pucBuf + uiPos * psRing->uiFrameBytes,
+            uiFirst * psRing->uiFrameBytes);
+    memcpy(pucDst + uiFirst * psRing->uiFrameBytes, psRing->pucBuf,
+            (uiFrames - uiFirst) * psRing->uiFrameBytes);
+    __sync_synchronize();
+    psRing->ulRead += uiFrames;
+    return uiFrames;
+}
+
+/* Consumer side: discards up to uiFrames frames */
+unsigned int alsa_ring_skip(AlsaRing *psRing, unsigned int uiFrames)
+{
+    unsigned int uiFill = alsa_ring_fill(psRing);
+
+    if (uiFrames > uiFill)
+    {
+        uiFrames = uiFill;
+    }
+    __sync_synchronize();
+    psRing->ulRead += uiFrames;
+    return uiFrames;
+}
+
+void alsa_ring_deinit(AlsaRing *psRing)
+{
+    if (psRing->pucBuf)
+    {
+        free(psRing->pucBuf);
+        psRing->pucBuf = NULL;
+    }
+    psRing->uiCapFrames = 0;
+}
@@ -0,0 +1,239 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_rt_check.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Real-time safety checks for the render thread.
+ *
+ *   The library interposes the libc entry points a real-time thread must
+ *   not use and checks a thread local flag on each call. Threads that never
+ *   arm themselves only pay for that test. The heap calls forward to the
+ *   __libc_* implementations so that they work before dlsym() does; the
+ *   rest are looked up with RTLD_NEXT on first use.
+ *
+ *   Expected system calls of the steady state - the PCM ioctls, poll and
+ *   the futex calls behind the semaphores - are not intercepted.
+ *
+ ******************************************************************************/
+
+#include "alsa_rt_check.h"
+
+#if ALSA_RT_CHECK
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+enum
+{
+    ALSA_RT_HEAP,
+    ALSA_RT_MUTEX,
+    ALSA_RT_OUTPUT,
+    ALSA_RT_SLEEP,
+    ALSA_RT_MAP,
+    ALSA_RT_KINDS
+};
+
+static const char *const apcKindName[ALSA_RT_KINDS] =
+{
+    "heap", "mutex wait", "console output", "sleep", "memory map"
+};
+
+static volatile unsigned long aulViolations[ALSA_RT_KINDS];
+static volatile unsigned long ulArmed;
+static int iAbortOnViolation;
+static __thread int iArmed;
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+#define ALSA_RT_REAL(name) \
+    static __typeof__(name) *pfReal = NULL; \
+    if (NULL == pfReal) \
+    { \
+        pfReal = reinterpret_cast<__typeof__(name) *>(dlsym(RTLD_NEXT, #name)); \
+    }
+
+static void alsa_rt_violation(int iKind)
+{
+    /* Reporting must not trip the checks again */
+    iArmed = 0;
+    __sync_fetch_and_add(&aulViolations[iKind], 1);
+    if (iAbortOnViolation)
+    {
+        fprintf(stderr, "ERR::AP::Real-time violation on render thread: %s\n",
+                apcKindName[iKind]);
+        abort();
+    }
+    iArmed = 1;
+}
+
+#define ALSA_RT_TRAP(kind) \
+    if (iArmed) \
+    { \
+        alsa_rt_violation(kind); \
+    }
+
+void alsa_rt_check_init(void)
+{
+    iAbortOnViolation = (NULL != getenv("AAP_RT_CHECK_ABORT"));
+}
+
+void alsa_rt_check_arm(AAP_BOOL bArm)
+{
+    if (bArm && !iArmed)
+    {
+        __sync_fetch_and_add(&ulArmed, 1);
+    }
+    iArmed = bArm ? 1 : 0;
+}
+
+unsigned long alsa_rt_check_violations(void)
+{
+    unsigned long ulTotal = 0;
+
+    for (int i = 0; i < ALSA_RT_KINDS; ++i)
+    {
+        ulTotal += aulViolations[i];
+    }
+    return ulTotal;
+}
+
+unsigned long alsa_rt_check_armed(void)
+{
+    return ulArmed;
+}
+
+void alsa_rt_check_report(void)
+{
+    printf("AP::Real-time violations: %lu\n", alsa_rt_check_violations());
+    for (int i = 0; i < ALSA_RT_KINDS; ++i)
+    {
+        if (aulViolations[i])
+        {
+            printf("AP::  %s: %lu\n", apcKindName[i], aulViolations[i]);
+        }
+    }
+}
+
+extern "C" {
+
+void *malloc(size_t size)
+{
+    ALSA_RT_TRAP(ALSA_RT_HEAP);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    ALSA_RT_TRAP(ALSA_RT_HEAP);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    ALSA_RT_TRAP(ALSA_RT_HEAP);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr)
+    {
+        ALSA_RT_TRAP(ALSA_RT_HEAP);
+    }
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *psMutex)
+{
+    ALSA_RT_REAL(pthread_mutex_lock);
+    if (iArmed)
+    {
+        if (0 == pthread_mutex_trylock(psMutex))
+        {
+            return 0;
+        }
+        /* Would have waited */
+        alsa_rt_violation(ALSA_RT_MUTEX);
+    }
+    return pfReal(psMutex);
+}
+
+int printf(const char *pcFormat, ...)
+{
+    va_list ap;
+    int iRet;
+
+    ALSA_RT_TRAP(ALSA_RT_OUTPUT);
+    va_start(ap, pcFormat);
+    iRet = vprintf(pcFormat, ap);
+    va_end(ap);
+    return iRet;
+}
+
+int puts(const char *pcStr)
+{
+    ALSA_RT_REAL(puts);
+    ALSA_RT_TRAP(ALSA_RT_OUTPUT);
+    return pfReal(pcStr);
+}
+
+int usleep(useconds_t usec)
+{
+    ALSA_RT_REAL(usleep);
+    ALSA_RT_TRAP(ALSA_RT_SLEEP);
+    return pfReal(usec);
+}
+
+int nanosleep(const struct timespec *psReq, struct timespec *psRem)
+{
+    ALSA_RT_REAL(nanosleep);
+    ALSA_RT_TRAP(ALSA_RT_SLEEP);
+    return pfReal(psReq, psRem);
+}
+
+void *mmap(void *pvAddr, size_t length, int iProt, int iFlags, int iFd,
+        off_t offset)
+{
+    ALSA_RT_REAL(mmap);
+    ALSA_RT_TRAP(ALSA_RT_MAP);
+    return pfReal(pvAddr, length, iProt, iFlags, iFd, offset);
+}
+
+int munmap(void *pvAddr, size_t length)
+{
+    ALSA_RT_REAL(munmap);
+    ALSA_RT_TRAP(ALSA_RT_MAP);
+    return pfReal(pvAddr, length);
+}
+
+}
+
+#endif /* if ALSA_RT_CHECK */
@@ -0,0 +1,164 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_thread.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Scheduling and memory locking helpers for the threads of the ALSA core
+ *   player.
+ *
+ *   AAP_ThreadConfig is applied with pthread_setschedparam() and
+ *   pthread_setaffinity_np(), so it can be set on a thread that is already
+ *   running. Memory locking is best effort: without CAP_IPC_LOCK or a large
+ *   enough RLIMIT_MEMLOCK the player runs unlocked and says so once.
+ *
+ ******************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "alsa_thread.h"
+#include "aap_error_codes.h"
+
+static volatile int iLockWarned;
+
+static void alsa_thread_lock_failed(int iErr)
+{
+    if (__sync_bool_compare_and_swap(&iLockWarned, 0, 1))
+    {
+        printf("AP::Could not lock player memory (%d), running unlocked\n", iErr);
+    }
+}
+
+/* Creates a joinable thread with a stack small enough to lock */
+int alsa_thread_create(pthread_t *psThread, void *(*pfEntry)(void *),
+        void *pvArg)
+{
+    pthread_attr_t sAttr;
+    int iRet;
+
+    if (0 != pthread_attr_init(&sAttr))
+    {
+        return AAP_ERR_SYS_CALL_FAILED;
+    }
+    pthread_attr_setstacksize(&sAttr, ALSA_THREAD_STACK_SIZE);
+    iRet = pthread_create(psThread, &sAttr, pfEntry, pvArg);
+    pthread_attr_destroy(&sAttr);
+    return (0 == iRet) ? 0 : AAP_ERR_SYS_CALL_FAILED;
+}
+
+int alsa_thread_apply_config(pthread_t sThread,
+        const AAP_ThreadConfig *psThreadConfig)
+{
+    int iRet = 0;
+    int iErr;
+
+    if (NULL == psThreadConfig)
+    {
+        return AAP_ERR_INVALID_PARAMS;
+    }
+    if (psThreadConfig->bIsValidPriority)
+    {
+        struct sched_param sParam;
+        int iPolicy = (AAP_THREAD_SCHEDULING_POLICY_FIFO ==
+                psThreadConfig->eThreadSchedPolicy) ? SCHED_FIFO : SCHED_RR;
+
+        memset(&sParam, 0x0, sizeof(sParam));
+        sParam.sched_priority = psThreadConfig->iPriorityValue;
+        if (sParam.sched_priority < sched_get_priority_min(iPolicy))
+        {
+            sParam.sched_priority = sched_get_priority_min(iPolicy);
+        }
+        if (sParam.sched_priority > sched_get_priority_max(iPolicy))
+        {
+            sParam.sched_priority = sched_get_priority_max(iPolicy);
+        }
+        iErr = pthread_setschedparam(sThread, iPolicy, &sParam);
+        if (0 != iErr)
+        {
+            printf("ERR::AP::Setting %s priority %d failed (%d)\n",
+                    (SCHED_FIFO == iPolicy) ? "FIFO" : "RR",
+                    sParam.sched_priority, iErr);
+            iRet = AAP_ERR_SYS_CALL_FAILED;
+        }
+        else
+        {
+            printf("AP::Thread priority %s %d\n",
+                    (SCHED_FIFO == iPolicy) ? "FIFO" : "RR",
+                    sParam.sched_priority);
+        }
+    }
+    if (psThreadConfig->bIsValidAffinity)
+    {
+        cpu_set_t sCpus;
+
+        CPU_ZERO(&sCpus);
+        CPU_SET(psThreadConfig->iAffinityValue, &sCpus);
+        iErr = pthread_setaffinity_np(sThread, sizeof(sCpus), &sCpus);
+        if (0 != iErr)
+        {
+            printf("ERR::AP::Setting affinity to CPU %d failed (%d)\n",
+                    psThreadConfig->iAffinityValue, iErr);
+            iRet = AAP_ERR_SYS_CALL_FAILED;
+        }
+        else
+        {
+            printf("AP::Thread affinity CPU %d\n", psThreadConfig->iAffinityValue);
+        }
+    }
+    return iRet;
+}
+
+/* Locks (and so prefaults) or unlocks the stack of the calling thread */
+void alsa_thread_lock_stack(AAP_BOOL bLock)
+{
+    pthread_attr_t sAttr;
+    void *pvStack = NULL;
+    size_t stackSize = 0;
+
+    if (0 != pthread_getattr_np(pthread_self(), &sAttr))
+    {
+        return;
+    }
+    if (0 == pthread_attr_getstack(&sAttr, &pvStack, &stackSize))
+    {
+        alsa_thread_lock_mem(pvStack, stackSize, bLock);
+    }
+    pthread_attr_destroy(&sAttr);
+}
+
+void alsa_thread_lock_mem(void *pvAddr, unsigned long ulSize, AAP_BOOL bLock)
+{
+    if ((NULL == pvAddr) || (0 == ulSize))
+    {
+        return;
+    }
+    if (!bLock)
+    {
+        munlock(pvAddr, ulSize);
+    }
+    else if (0 != mlock(pvAddr, ulSize))
+    {
+        alsa_thread_lock_failed(errno);
+    }
+}
@@ -0,0 +1,234 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_caps_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Writes a capability cache file with good and broken entries, then
+ *   checks that only the good ones are loaded, that hardware parameters
+ *   stored again for a configuration replace its entry instead of adding
+ *   one, and that the file written back holds exactly the cache. No PCM is
+ *   opened: every lookup made is answered from the cache.
+ *
+ *   Also checks the native configuration chosen for streams against a
+ *   set of device capabilities: the stream's rate when the device has it,
+ *   else the nearest higher one, the channels clamped to the device's
+ *   range and S16 preferred over the other formats.
+ *
+ *   Built and run by "make caps_test", which points ALSA_CAPS_CACHE_FILE
+ *   into the object directory.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "alsa_caps.h"
+#include "aap_error_codes.h"
+
+#define CAPS_TEST_KEY           "card0:dev0:codec:1.0"
+
+/* Lines written before the cache is first used */
+static const char s_acCacheIn[] =
+    "c " CAPS_TEST_KEY " 3 7f 1 2\n"
+    /* A field short, a line of nothing known, a key too long */
+    "c card1:dev0:codec:1.0 3 7f 1\n"
+    "x unknown line\n"
+    "c kkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkk"
+    "kkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkk"
+    "kkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkkk"
+    " 3 7f 1 2\n"
+    "h " CAPS_TEST_KEY " 2 48000 2 100000 1 1 4800 1200\n"
+    /* No period, and a buffer shorter than its period */
+    "h " CAPS_TEST_KEY " 2 32000 2 100000 1 1 3200 0\n"
+    "h " CAPS_TEST_KEY " 2 16000 2 100000 1 1 400 800\n";
+
+/* What the cache must hold once the tests have changed it */
+static const char s_acCacheOut[] =
+    "c " CAPS_TEST_KEY " 3 7f 1 2\n"
+    "h " CAPS_TEST_KEY " 2 48000 2 100000 1 1 9600 2400\n"
+    "h " CAPS_TEST_KEY " 2 44100 2 100000 1 1 8820 2205\n";
+
+static void caps_test_setup(AlsaHwSetup *psSetup, unsigned int uiRate,
+        snd_pcm_uframes_t bufferSize, snd_pcm_uframes_t periodSize)
+{
+    memset(psSetup, 0x0, sizeof(AlsaHwSetup));
+    psSetup->format = SND_PCM_FORMAT_S16_LE;
+    psSetup->uiRate = uiRate;
+    psSetup->uiChannels = 2;
+    psSetup->uiBufferUs = 100000;
+    psSetup->iResample = 1;
+    psSetup->iPeriodWakeup = 1;
+    psSetup->bufferSize = bufferSize;
+    psSetup->periodSize = periodSize;
+}
+
+static int caps_test_write(const char *pcText)
+{
+    FILE *psFile = fopen(ALSA_CAPS_CACHE_FILE, "w");
+
+    if ((NULL == psFile) || (EOF == fputs(pcText, psFile)) || (0 != fclose(psFile)))
+    {
+        printf("ERR::TEST::%s not writable\n", ALSA_CAPS_CACHE_FILE);
+        return 1;
+    }
+    return 0;
+}
+
+static int caps_test_compare(const char *pcWant)
+{
+    char acText[sizeof(s_acCacheIn)];
+    FILE *psFile = fopen(ALSA_CAPS_CACHE_FILE, "r");
+    size_t uiLen;
+
+    if (NULL == psFile)
+    {
+        printf("ERR::TEST::%s not written\n", ALSA_CAPS_CACHE_FILE);
+        return 1;
+    }
+    uiLen = fread(acText, 1, sizeof(acText) - 1, psFile);
+    fclose(psFile);
+    acText[uiLen] = '\0';
+    if (0 != strcmp(acText, pcWant))
+    {
+        printf("ERR::TEST::Cache file holds\n%sexpected\n%s", acText, pcWant);
+        return 1;
+    }
+    if (0 == access(ALSA_CAPS_CACHE_FILE ".tmp", F_OK))
+    {
+        printf("ERR::TEST::Temporary cache file left behind\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int caps_test_cache(void)
+{
+    AlsaHwSetup sSetup;
+    AlsaCaps sCaps;
+
+    if (0 != caps_test_write(s_acCacheIn))
+    {
+        return 1;
+    }
+    /* Answered from the cache, the PCM is never touched */
+    memset(&sCaps, 0x0, sizeof(sCaps));
+    if ((0 != alsa_caps_get(NULL, CAPS_TEST_KEY, &sCaps)) || (0x3 != sCaps.uiFormats) ||
+            (0x7f != sCaps.uiRates) || (1 != sCaps.uiMinChannels) ||
+            (2 != sCaps.uiMaxChannels))
+    {
+        printf("ERR::TEST::Capabilities of %s not loaded\n", CAPS_TEST_KEY);
+        return 1;
+    }
+    caps_test_setup(&sSetup, 32000, 0, 0);
+    if (AAP_ERR_PRECOND_NOT_MET != alsa_caps_set_hw(NULL, CAPS_TEST_KEY, &sSetup))
+    {
+        printf("ERR::TEST::Entry without a period loaded\n");
+        return 1;
+    }
+    caps_test_setup(&sSetup, 16000, 0, 0);
+    if (AAP_ERR_PRECOND_NOT_MET != alsa_caps_set_hw(NULL, CAPS_TEST_KEY, &sSetup))
+    {
+        printf("ERR::TEST::Entry with a buffer shorter than its period loaded\n");
+        return 1;
+    }
+
+    /* Sizes stored again replace those loaded, a new configuration is
+     * added, and each change writes the whole cache out */
+    caps_test_setup(&sSetup, 48000, 9600, 2400);
+    alsa_caps_put_hw(CAPS_TEST_KEY, &sSetup);
+    caps_test_setup(&sSetup, 44100, 8820, 2205);
+    alsa_caps_put_hw(CAPS_TEST_KEY, &sSetup);
+    alsa_caps_put_hw(CAPS_TEST_KEY, &sSetup);
+    return caps_test_compare(s_acCacheOut);
+}
+
+typedef struct
+{
+    /* Device */
+    unsigned int uiFormats;
+    unsigned int uiRates;
+    unsigned int uiMinChannels;
+    unsigned int uiMaxChannels;
+    /* Stream */
+    unsigned int uiRate;
+    unsigned int uiChannels;
+    /* Configuration expected, a rate of 0 when there is none */
+    AlsaSampleFormat eFormat;
+    unsigned int uiWantRate;
+    unsigned int uiWantChannels;
+}CapsTestChoice;
+
+/* Rate bits in the order of the rate table: 8000, 11025, 16000, 22050,
+ * 32000, 44100 and 48000 Hz */
+static const CapsTestChoice s_asChoices[] =
+{
+    { 0x7, 0x7f, 1, 8, 44100, 2, ALSA_SAMPLE_S16, 44100, 2 },
+    { 0x6, 0x60, 2, 2, 32000, 1, ALSA_SAMPLE_S32, 44100, 2 },
+    { 0x4, 0x40, 2, 2, 22050, 6, ALSA_SAMPLE_FLOAT, 48000, 2 },
+    { 0x1, 0x20, 1, 2, 48000, 2, ALSA_SAMPLE_S16, 44100, 2 },
+    { 0x1, 0x40, 1, 2, 96000, 2, ALSA_SAMPLE_S16, 48000, 2 },
+    { 0x1, 0x01, 1, 2, 44100, 2, ALSA_SAMPLE_S16, 0, 0 }
+};
+
+static int caps_test_choose(void)
+{
+    for (unsigned int i = 0; i < sizeof(s_asChoices) / sizeof(s_asChoices[0]); ++i)
+    {
+        const CapsTestChoice *psChoice = &s_asChoices[i];
+        AlsaCaps sCaps;
+        AlsaSampleFormat eFormat;
+        unsigned int uiRate = 0;
+        unsigned int uiChannels = 0;
+        int iRet;
+
+        sCaps.uiFormats = psChoice->uiFormats;
+        sCaps.uiRates = psChoice->uiRates;
+        sCaps.uiMinChannels = psChoice->uiMinChannels;
+        sCaps.uiMaxChannels = psChoice->uiMaxChannels;
+        iRet = alsa_caps_choose(&sCaps, psChoice->uiRate, psChoice->uiChannels,
+                &eFormat, &uiRate, &uiChannels);
+        if ((0 == psChoice->uiWantRate) ? (0 == iRet) :
+                ((0 != iRet) || (eFormat != psChoice->eFormat) ||
+                 (uiRate != psChoice->uiWantRate) || (uiChannels != psChoice->uiWantChannels)))
+        {
+            printf("ERR::TEST::Stream of %u Hz, %u channels: chose %d %u Hz %u channels, "
+                    "expected %d %u Hz %u channels\n", psChoice->uiRate,
+                    psChoice->uiChannels, (0 == iRet) ? eFormat : -1, uiRate, uiChannels,
+                    psChoice->eFormat, psChoice->uiWantRate, psChoice->uiWantChannels);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    if (0 != caps_test_choose())
+    {
+        printf("ERR::TEST::Native configuration chosen wrong\n");
+        return 1;
+    }
+    if (0 != caps_test_cache())
+    {
+        printf("ERR::TEST::Capability cache failed\n");
+        return 1;
+    }
+    printf("TEST::Native configurations and capability cache checked\n");
+    return 0;
+}
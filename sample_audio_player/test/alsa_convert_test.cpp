@@ -0,0 +1,307 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_convert_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Checks the input conversion stage a player switches to when its input
+ *   format changes mid-stream. Input in the device format passes through
+ *   untouched; channels are repeated up and averaged down; a tone
+ *   converted from another rate keeps its level and frequency and comes
+ *   out with as many frames as the rates ask for, the same whatever the
+ *   chunks it was pushed in but for the last frame; rates the interpolator
+ *   cannot take are refused.
+ *
+ *   Built and run by "make convert_test". The random part is seeded from
+ *   the time unless a seed is given as the first argument, and the seed is
+ *   printed so that a failure can be repeated.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "alsa_convert.h"
+
+#define CONVERT_TEST_OUT_RATE   48000
+#define CONVERT_TEST_TONE_HZ    1000
+#define CONVERT_TEST_LEVEL      8000.0
+/* One second of input at the highest rate taken */
+#define CONVERT_TEST_MAX_FRAMES (2 * CONVERT_TEST_OUT_RATE)
+#define CONVERT_TEST_MAX_CHUNK  1024
+/* Output skipped before measuring, while the interpolator starts up */
+#define CONVERT_TEST_SKIP       64
+/* Level the converted tone may be off by, and the largest error left
+ * after taking the tone out, both in dB. The cubic interpolator leaves
+ * about -44 dB on a tone at an eighth of its input rate. */
+#define CONVERT_TEST_LEVEL_DB   0.1
+#define CONVERT_TEST_NOISE_DB   -40.0
+
+static unsigned int uiRandState;
+
+static short asIn[CONVERT_TEST_MAX_FRAMES * ALSA_CONVERT_MAX_CHANNELS];
+static short asWhole[2 * CONVERT_TEST_MAX_FRAMES * ALSA_CONVERT_MAX_CHANNELS];
+static short asChunked[2 * CONVERT_TEST_MAX_FRAMES * ALSA_CONVERT_MAX_CHANNELS];
+
+static unsigned int convert_test_rand(void)
+{
+    uiRandState ^= uiRandState << 13;
+    uiRandState ^= uiRandState >> 17;
+    uiRandState ^= uiRandState << 5;
+    return uiRandState;
+}
+
+/* Converts uiFrames of asIn in chunks of up to uiMaxChunk frames into
+ * psOut. Returns the output frames, or -1 on a failure. */
+static int convert_test_run(unsigned int uiInChannels, unsigned int uiInRate,
+        unsigned int uiOutChannels, unsigned int uiFrames, unsigned int uiMaxChunk,
+        short *psOut)
+{
+    AlsaConvert sConvert;
+    unsigned int uiDone = 0;
+    int iOutFrames = 0;
+
+    if ((0 != alsa_convert_init(&sConvert, uiOutChannels, CONVERT_TEST_OUT_RATE)) ||
+            (0 != alsa_convert_set_input(&sConvert, uiInChannels, uiInRate)))
+    {
+        printf("ERR::TEST::%u ch at %u Hz refused\n", uiInChannels, uiInRate);
+        return -1;
+    }
+    while (uiDone < uiFrames)
+    {
+        unsigned int uiChunk = 1 + convert_test_rand() % uiMaxChunk;
+        const short *psConverted;
+        int iConverted;
+
+        uiChunk = (uiChunk > uiFrames - uiDone) ? uiFrames - uiDone : uiChunk;
+        iConverted = alsa_convert_process(&sConvert, asIn + uiDone * uiInChannels,
+                uiChunk, &psConverted);
+        if (iConverted < 0)
+        {
+            alsa_convert_deinit(&sConvert);
+            return -1;
+        }
+        memcpy(psOut + iOutFrames * uiOutChannels, psConverted,
+                iConverted * uiOutChannels * sizeof(short));
+        iOutFrames += iConverted;
+        uiDone += uiChunk;
+    }
+    alsa_convert_deinit(&sConvert);
+    return iOutFrames;
+}
+
+static void convert_test_tone(unsigned int uiChannels, unsigned int uiRate,
+        unsigned int uiFrames)
+{
+    for (unsigned int i = 0; i < uiFrames; ++i)
+    {
+        double const dPhase = (2.0 * M_PI * CONVERT_TEST_TONE_HZ * i) / uiRate;
+
+        for (unsigned int c = 0; c < uiChannels; ++c)
+        {
+            asIn[i * uiChannels + c] = static_cast<short>(
+                    lrint(CONVERT_TEST_LEVEL * sin(dPhase)));
+        }
+    }
+}
+
+/* Same format: the input itself comes back */
+static int convert_test_passthrough(void)
+{
+    AlsaConvert sConvert;
+    const short *psOut = NULL;
+    int iFrames;
+
+    alsa_convert_init(&sConvert, 2, CONVERT_TEST_OUT_RATE);
+    iFrames = alsa_convert_process(&sConvert, asIn, 480, &psOut);
+    alsa_convert_deinit(&sConvert);
+    if (alsa_convert_active(&sConvert) || (480 != iFrames) || (asIn != psOut))
+    {
+        printf("ERR::TEST::Input in the device format not passed through\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* Fewer input channels are repeated, more are averaged onto the outputs
+ * they fold to */
+static int convert_test_channels(void)
+{
+    static const struct
+    {
+        unsigned int uiIn;
+        unsigned int uiOut;
+        short asIn[6];
+        short asWant[6];
+    }asCases[] =
+    {
+        { 1, 2, { 1000 }, { 1000, 1000 } },
+        { 2, 6, { 1000, -2000 }, { 1000, -2000, 1000, -2000, 1000, -2000 } },
+        { 2, 1, { 1000, -2000 }, { -500 } },
+        { 3, 2, { 3000, 500, -1000 }, { 1000, 500 } },
+        { 6, 2, { 300, 600, 600, 0, -300, -1200 }, { 200, -200 } }
+    };
+
+    for (unsigned int t = 0; t < sizeof(asCases) / sizeof(asCases[0]); ++t)
+    {
+        for (unsigned int i = 0; i < 100; ++i)
+        {
+            memcpy(asIn + i * asCases[t].uiIn, asCases[t].asIn,
+                    asCases[t].uiIn * sizeof(short));
+        }
+        if (100 != convert_test_run(asCases[t].uiIn, CONVERT_TEST_OUT_RATE,
+                    asCases[t].uiOut, 100, 100, asWhole))
+        {
+            return 1;
+        }
+        for (unsigned int i = 0; i < 100 * asCases[t].uiOut; ++i)
+        {
+            if (asWhole[i] != asCases[t].asWant[i % asCases[t].uiOut])
+            {
+                printf("ERR::TEST::%u to %u channels: %d on channel %u, expected %d\n",
+                        asCases[t].uiIn, asCases[t].uiOut, asWhole[i],
+                        i % asCases[t].uiOut, asCases[t].asWant[i % asCases[t].uiOut]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Level of the test tone in channel 0 of psOut, and what is left once it
+ * is taken out, in dB against the tone's level */
+static void convert_test_measure(const short *psOut, unsigned int uiChannels,
+        unsigned int uiFrames, double *pdLevelDb, double *pdNoiseDb)
+{
+    double dSin = 0.0;
+    double dCos = 0.0;
+    double dNoise = 0.0;
+    double dAmplitude;
+    double dOffset;
+    unsigned int uiCount = 0;
+
+    /* Whole cycles of the tone only */
+    uiFrames -= (uiFrames - CONVERT_TEST_SKIP) %
+        (CONVERT_TEST_OUT_RATE / CONVERT_TEST_TONE_HZ);
+    for (unsigned int i = CONVERT_TEST_SKIP; i < uiFrames; ++i)
+    {
+        double const dPhase = (2.0 * M_PI * CONVERT_TEST_TONE_HZ * i) /
+            CONVERT_TEST_OUT_RATE;
+
+        dSin += psOut[i * uiChannels] * sin(dPhase);
+        dCos += psOut[i * uiChannels] * cos(dPhase);
+        ++uiCount;
+    }
+    dAmplitude = 2.0 * sqrt(dSin * dSin + dCos * dCos) / uiCount;
+    dOffset = atan2(dCos, dSin);
+    for (unsigned int i = CONVERT_TEST_SKIP; i < uiFrames; ++i)
+    {
+        double const dPhase = (2.0 * M_PI * CONVERT_TEST_TONE_HZ * i) /
+            CONVERT_TEST_OUT_RATE;
+        double const dErr = psOut[i * uiChannels] - dAmplitude * sin(dPhase + dOffset);
+
+        dNoise += dErr * dErr;
+    }
+    *pdLevelDb = 20.0 * log10(dAmplitude / CONVERT_TEST_LEVEL);
+    *pdNoiseDb = 10.0 * log10((dNoise / uiCount) / (dAmplitude * dAmplitude / 2.0));
+}
+
+static int convert_test_rate(unsigned int uiInRate, unsigned int uiChannels)
+{
+    unsigned int const uiFrames = uiInRate;
+    int const iWant = static_cast<int>(
+            (static_cast<unsigned long long>(uiFrames) * CONVERT_TEST_OUT_RATE) / uiInRate);
+    double dLevelDb;
+    double dNoiseDb;
+    int iWhole;
+    int iChunked;
+
+    convert_test_tone(uiChannels, uiInRate, uiFrames);
+    iWhole = convert_test_run(uiChannels, uiInRate, uiChannels, uiFrames, uiFrames,
+            asWhole);
+    iChunked = convert_test_run(uiChannels, uiInRate, uiChannels, uiFrames,
+            CONVERT_TEST_MAX_CHUNK, asChunked);
+    if ((iWhole < 0) || (iChunked < 0))
+    {
+        return 1;
+    }
+    /* Where the input ends on an output frame, rounding of the phase
+     * decides whether that last frame comes out */
+    if ((abs(iWhole - iChunked) > 1) || (0 != memcmp(asWhole, asChunked,
+                    ((iWhole < iChunked) ? iWhole : iChunked) * uiChannels * sizeof(short))))
+    {
+        printf("ERR::TEST::%u Hz, %u ch: output depends on the chunks pushed\n",
+                uiInRate, uiChannels);
+        return 1;
+    }
+    if (abs(iWhole - iWant) > 2)
+    {
+        printf("ERR::TEST::%u Hz, %u ch: %d frames out, expected %d\n", uiInRate,
+                uiChannels, iWhole, iWant);
+        return 1;
+    }
+    convert_test_measure(asWhole, uiChannels, static_cast<unsigned int>(iWhole),
+            &dLevelDb, &dNoiseDb);
+    if ((fabs(dLevelDb) > CONVERT_TEST_LEVEL_DB) || (dNoiseDb > CONVERT_TEST_NOISE_DB))
+    {
+        printf("ERR::TEST::%u Hz, %u ch: tone at %.3f dB, %.1f dB of error\n",
+                uiInRate, uiChannels, dLevelDb, dNoiseDb);
+        return 1;
+    }
+    printf("TEST::%u Hz, %u ch to %u Hz: %.1f dB of error\n", uiInRate, uiChannels,
+            CONVERT_TEST_OUT_RATE, dNoiseDb);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int const auiRates[] = { 8000, 16000, 22050, 32000, 44100, 88200, 96000 };
+    unsigned int const uiSeed = (argc > 1) ?
+        static_cast<unsigned int>(strtoul(argv[1], NULL, 0)) :
+        static_cast<unsigned int>(time(NULL));
+    AlsaConvert sConvert;
+    int iFailed = 0;
+
+    printf("TEST::Random seed %u\n", uiSeed);
+    uiRandState = (0 == uiSeed) ? 1 : uiSeed;
+    iFailed |= convert_test_passthrough();
+    iFailed |= convert_test_channels();
+    for (unsigned int r = 0; r < sizeof(auiRates) / sizeof(auiRates[0]); ++r)
+    {
+        iFailed |= convert_test_rate(auiRates[r], 1);
+        iFailed |= convert_test_rate(auiRates[r], 2);
+    }
+
+    alsa_convert_init(&sConvert, 2, CONVERT_TEST_OUT_RATE);
+    if (0 == alsa_convert_set_input(&sConvert, 2, 2 * CONVERT_TEST_OUT_RATE + 1))
+    {
+        printf("ERR::TEST::Rate over twice the device one taken\n");
+        iFailed = 1;
+    }
+    alsa_convert_deinit(&sConvert);
+
+    if (0 != iFailed)
+    {
+        printf("ERR::TEST::Input conversion failed, seed %u\n", uiSeed);
+        return 1;
+    }
+    printf("TEST::Input conversion checked\n");
+    return 0;
+}
@@ -0,0 +1,247 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_dsp_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Checks every DSP variant built for this CPU bit for bit against the
+ *   scalar kernels: lengths of 0, 1, one around each vector width and
+ *   random large ones, gain ramps between any gains from 0 to 32768 in
+ *   both directions, and dither seeds that wrap around within a call.
+ *   Output past the length must stay untouched.
+ *
+ *   Built and run by "make dsp_test". The random part is seeded from the
+ *   time unless a seed is given as the first argument, and the seed is
+ *   printed so that a failure can be repeated.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alsa_dsp.h"
+
+/* Largest length in samples, and the untouched guard behind it */
+#define DSP_TEST_MAX_SAMPLES    8192
+#define DSP_TEST_GUARD          32
+#define DSP_TEST_BUF_SAMPLES    (2 * DSP_TEST_MAX_SAMPLES + DSP_TEST_GUARD)
+#define DSP_TEST_RANDOM_LENGTHS 24
+#define DSP_TEST_RANDOM_RAMPS   64
+#define DSP_TEST_Q15_ONE        32768
+
+static unsigned int uiRandIndex;
+
+static short asIn[DSP_TEST_BUF_SAMPLES];
+static short asA[DSP_TEST_BUF_SAMPLES];
+static short asB[DSP_TEST_BUF_SAMPLES];
+static float afIn[DSP_TEST_BUF_SAMPLES];
+static float afA[DSP_TEST_BUF_SAMPLES];
+static float afB[DSP_TEST_BUF_SAMPLES];
+
+static unsigned int dsp_test_rand(void)
+{
+    return alsa_dsp_hash(uiRandIndex++);
+}
+
+static int dsp_test_differs(const char *pcVariant, const char *pcKernel,
+        const void *pvA, const void *pvB, unsigned int uiBytes, unsigned int uiLen)
+{
+    if (0 == memcmp(pvA, pvB, uiBytes))
+    {
+        return 0;
+    }
+    printf("ERR::TEST::%s %s differs from scalar at length %u\n", pcVariant,
+            pcKernel, uiLen);
+    return 1;
+}
+
+/* New random input, with full scale values and exact rounding ties mixed
+ * in, and the same random contents in both outputs */
+static void dsp_test_fill(void)
+{
+    for (unsigned int i = 0; i < DSP_TEST_BUF_SAMPLES; ++i)
+    {
+        unsigned int const uiRand = dsp_test_rand();
+
+        asIn[i] = static_cast<short>(uiRand);
+        switch (uiRand >> 29)
+        {
+            case 0:
+                asIn[i] = static_cast<short>((uiRand & 1) ? 32767 : -32768);
+                afIn[i] = (uiRand & 2) ? 1.0f : -1.0f;
+                break;
+            case 1:
+                afIn[i] = (static_cast<float>(static_cast<short>(uiRand)) + 0.5f) /
+                    32768.0f;
+                break;
+            default:
+                /* Past full scale at both ends to cover saturation */
+                afIn[i] = static_cast<float>(static_cast<int>(uiRand)) *
+                    (1.2f / 2147483648.0f);
+                break;
+        }
+        asA[i] = asB[i] = static_cast<short>(dsp_test_rand());
+        afA[i] = afB[i] = static_cast<float>(static_cast<int>(dsp_test_rand()));
+    }
+}
+
+static int dsp_test_length(const AlsaDsp *psDsp, const AlsaDsp *psRef,
+        unsigned int uiLen)
+{
+    unsigned int const auiSeeds[] =
+    {
+        dsp_test_rand(), 0xFFFFFFFFU - uiLen / 2, 0xFFFFFFFFU
+    };
+    char const *pcName = psDsp->pcName;
+    int iFailed = 0;
+
+    dsp_test_fill();
+    memcpy(asA, asIn + 1, uiLen * sizeof(short));
+    memcpy(asB, asIn + 1, uiLen * sizeof(short));
+    psDsp->pfAddSatS16(asA, asIn, uiLen);
+    psRef->pfAddSatS16(asB, asIn, uiLen);
+    iFailed |= dsp_test_differs(pcName, "add_sat_s16", asA, asB, sizeof(asA), uiLen);
+
+    dsp_test_fill();
+    psDsp->pfS16ToFloat(asIn, afA, uiLen);
+    psRef->pfS16ToFloat(asIn, afB, uiLen);
+    iFailed |= dsp_test_differs(pcName, "s16_to_float", afA, afB, sizeof(afA), uiLen);
+
+    for (unsigned int s = 0; s < sizeof(auiSeeds) / sizeof(auiSeeds[0]); ++s)
+    {
+        unsigned int uiSeedA = auiSeeds[s];
+        unsigned int uiSeedB = auiSeeds[s];
+
+        dsp_test_fill();
+        psDsp->pfFloatToS16(afIn, asA, uiLen, &uiSeedA);
+        psRef->pfFloatToS16(afIn, asB, uiLen, &uiSeedB);
+        iFailed |= dsp_test_differs(pcName, "float_to_s16", asA, asB, sizeof(asA), uiLen);
+        iFailed |= dsp_test_differs(pcName, "float_to_s16 seed", &uiSeedA, &uiSeedB,
+                sizeof(uiSeedA), uiLen);
+
+        uiSeedA = uiSeedB = auiSeeds[s];
+        psDsp->pfTpdf(afA, uiLen, &uiSeedA);
+        psRef->pfTpdf(afB, uiLen, &uiSeedB);
+        iFailed |= dsp_test_differs(pcName, "tpdf", afA, afB, sizeof(afA), uiLen);
+        iFailed |= dsp_test_differs(pcName, "tpdf seed", &uiSeedA, &uiSeedB,
+                sizeof(uiSeedA), uiLen);
+    }
+
+    dsp_test_fill();
+    psDsp->pfDeinterleave2(afIn, afA, afA + uiLen, uiLen);
+    psRef->pfDeinterleave2(afIn, afB, afB + uiLen, uiLen);
+    iFailed |= dsp_test_differs(pcName, "deinterleave2", afA, afB, sizeof(afA), uiLen);
+    dsp_test_fill();
+    psDsp->pfInterleave2(afIn, afIn + uiLen, afA, uiLen);
+    psRef->pfInterleave2(afIn, afIn + uiLen, afB, uiLen);
+    iFailed |= dsp_test_differs(pcName, "interleave2", afA, afB, sizeof(afA), uiLen);
+    return iFailed;
+}
+
+/* Ramps of uiLen samples between each pair of edge gains and random ones */
+static int dsp_test_ramps(const AlsaDsp *psDsp, const AlsaDsp *psRef,
+        unsigned int uiLen)
+{
+    int const aiEdges[] = { 0, 1, DSP_TEST_Q15_ONE / 2, DSP_TEST_Q15_ONE - 1,
+        DSP_TEST_Q15_ONE };
+    unsigned int const uiEdges = sizeof(aiEdges) / sizeof(aiEdges[0]);
+    int iFailed = 0;
+
+    dsp_test_fill();
+    for (unsigned int uiCh = 1; uiCh <= 3; ++uiCh)
+    {
+        for (unsigned int r = 0; r < uiEdges * uiEdges + DSP_TEST_RANDOM_RAMPS; ++r)
+        {
+            int iFrom;
+            int iTo;
+
+            if (r < uiEdges * uiEdges)
+            {
+                iFrom = aiEdges[r / uiEdges];
+                iTo = aiEdges[r % uiEdges];
+            }
+            else
+            {
+                iFrom = static_cast<int>(dsp_test_rand() % (DSP_TEST_Q15_ONE + 1));
+                iTo = static_cast<int>(dsp_test_rand() % (DSP_TEST_Q15_ONE + 1));
+            }
+            memcpy(asA, asIn, sizeof(asA));
+            memcpy(asB, asIn, sizeof(asB));
+            psDsp->pfGainRamp(asA, uiLen / uiCh, uiCh, iFrom, iTo);
+            psRef->pfGainRamp(asB, uiLen / uiCh, uiCh, iFrom, iTo);
+            if (dsp_test_differs(psDsp->pcName, "gain_ramp", asA, asB, sizeof(asA), uiLen))
+            {
+                printf("ERR::TEST::  %u channels, %d to %d\n", uiCh, iFrom, iTo);
+                iFailed = 1;
+            }
+        }
+    }
+    return iFailed;
+}
+
+int main(int argc, char *argv[])
+{
+    /* Around the 4, 8 and 16 lane widths of the variants, and two vectors */
+    unsigned int const auiFixed[] =
+    {
+        0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, DSP_TEST_MAX_SAMPLES
+    };
+    unsigned int const uiFixed = sizeof(auiFixed) / sizeof(auiFixed[0]);
+    int (*const apfVariants[])(AlsaDsp *) =
+    {
+        alsa_dsp_sse2, alsa_dsp_avx2, alsa_dsp_neon
+    };
+    unsigned int const uiSeed = (argc > 1) ?
+        static_cast<unsigned int>(strtoul(argv[1], NULL, 0)) :
+        static_cast<unsigned int>(time(NULL));
+    unsigned int uiTested = 0;
+    int iFailed = 0;
+    AlsaDsp sRef;
+
+    printf("TEST::Random seed %u\n", uiSeed);
+    alsa_dsp_scalar(&sRef);
+    for (unsigned int v = 0; v < sizeof(apfVariants) / sizeof(apfVariants[0]); ++v)
+    {
+        AlsaDsp sDsp = sRef;
+
+        if (!apfVariants[v](&sDsp))
+        {
+            continue;
+        }
+        uiRandIndex = uiSeed;
+        for (unsigned int l = 0; l < uiFixed + DSP_TEST_RANDOM_LENGTHS; ++l)
+        {
+            unsigned int const uiLen = (l < uiFixed) ? auiFixed[l] :
+                34 + dsp_test_rand() % (DSP_TEST_MAX_SAMPLES - 34);
+
+            iFailed |= dsp_test_length(&sDsp, &sRef, uiLen);
+            iFailed |= dsp_test_ramps(&sDsp, &sRef, uiLen);
+        }
+        printf("TEST::%s checked\n", sDsp.pcName);
+        ++uiTested;
+    }
+
+    if (0 != iFailed)
+    {
+        printf("ERR::TEST::DSP variants differ from scalar, seed %u\n", uiSeed);
+        return 1;
+    }
+    printf("TEST::%u DSP variants match scalar\n", uiTested);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_eq_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Measures the gain of the parametric EQ for tones at chosen frequencies,
+ *   with 1, 2 and 6 channels, and compares it with the response each band
+ *   shape must have: the full boost or cut at the center of a peaking band,
+ *   half of it at the corner of a shelf and all of it far past the corner,
+ *   -3 dB at the corner of a Butterworth pass filter and 12 dB per octave
+ *   beyond it. Without bands the EQ must not change the signal, and bands
+ *   it cannot run must be refused.
+ *
+ *   Built and run by "make eq_test", in the float or the fixed point build
+ *   as the Makefile is told.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "alsa_eq.h"
+
+#define EQ_TEST_RATE            48000
+#define EQ_TEST_PERIOD          480
+/* Played before measuring, so that the bands have settled */
+#define EQ_TEST_SETTLE_FRAMES   (EQ_TEST_RATE / 2)
+/* Half a second: tones of an even number of Hz fit in whole cycles */
+#define EQ_TEST_MEASURE_FRAMES  (EQ_TEST_RATE / 2)
+#define EQ_TEST_LEVEL           0.25
+#define EQ_TEST_MAX_BANDS       2
+
+typedef struct
+{
+    const char *pcName;
+    unsigned int uiBands;
+    AAPPlayerEqBand asBands[EQ_TEST_MAX_BANDS];
+    /* Tone measured, in Hz */
+    unsigned int uiToneHz;
+    /* Gain expected, and how far the measured one may be off, in dB.
+     * A tolerance below 0 only asks for a gain below the expected one. */
+    double dWantDb;
+    double dToleranceDb;
+}EqTestCase;
+
+static const EqTestCase s_asCases[] =
+{
+    { "peaking +6 dB at center", 1,
+        { { E_AAP_EQ_PEAKING, 1000.0f, 6.0f, 1.0f } }, 1000, 6.0, 0.01 },
+    { "peaking -12 dB at center", 1,
+        { { E_AAP_EQ_PEAKING, 2000.0f, -12.0f, 2.0f } }, 2000, -12.0, 0.01 },
+    { "two peaking bands add up", 2,
+        { { E_AAP_EQ_PEAKING, 1000.0f, 6.0f, 1.0f },
+          { E_AAP_EQ_PEAKING, 1000.0f, 6.0f, 1.0f } }, 1000, 12.0, 0.01 },
+    { "low shelf at corner", 1,
+        { { E_AAP_EQ_LOW_SHELF, 200.0f, 6.0f, 0.707f } }, 200, 3.0, 0.01 },
+    { "low shelf far below", 1,
+        { { E_AAP_EQ_LOW_SHELF, 200.0f, 6.0f, 0.707f } }, 10, 6.0, 0.05 },
+    { "low shelf far above", 1,
+        { { E_AAP_EQ_LOW_SHELF, 200.0f, 6.0f, 0.707f } }, 10000, 0.0, 0.05 },
+    { "high shelf at corner", 1,
+        { { E_AAP_EQ_HIGH_SHELF, 2000.0f, -6.0f, 0.707f } }, 2000, -3.0, 0.01 },
+    { "high shelf far below", 1,
+        { { E_AAP_EQ_HIGH_SHELF, 2000.0f, -6.0f, 0.707f } }, 100, 0.0, 0.05 },
+    { "low pass at corner", 1,
+        { { E_AAP_EQ_LOW_PASS, 1000.0f, 0.0f, 0.70710678f } }, 1000, -3.0103, 0.01 },
+    { "low pass in band", 1,
+        { { E_AAP_EQ_LOW_PASS, 1000.0f, 0.0f, 0.70710678f } }, 100, 0.0, 0.01 },
+    { "low pass over three octaves up", 1,
+        { { E_AAP_EQ_LOW_PASS, 1000.0f, 0.0f, 0.70710678f } }, 8000, -36.0, -1.0 },
+    { "high pass at corner", 1,
+        { { E_AAP_EQ_HIGH_PASS, 1000.0f, 0.0f, 0.70710678f } }, 1000, -3.0103, 0.01 },
+    { "high pass in band", 1,
+        { { E_AAP_EQ_HIGH_PASS, 1000.0f, 0.0f, 0.70710678f } }, 10000, 0.0, 0.01 },
+    { "high pass three octaves down", 1,
+        { { E_AAP_EQ_HIGH_PASS, 1000.0f, 0.0f, 0.70710678f } }, 124, -36.0, -1.0 }
+};
+
+static AlsaBusSample atBus[EQ_TEST_PERIOD * ALSA_BUS_MAX_CHANNELS];
+
+static AlsaBusSample eq_test_bus(double dValue)
+{
+#if ALSA_FIXED_POINT
+    return static_cast<int>(lrint(dValue * (1 << ALSA_BUS_FRAC_BITS)));
+#else
+    return static_cast<float>(dValue);
+#endif
+}
+
+static double eq_test_value(AlsaBusSample tValue)
+{
+#if ALSA_FIXED_POINT
+    return static_cast<double>(tValue) / (1 << ALSA_BUS_FRAC_BITS);
+#else
+    return static_cast<double>(tValue);
+#endif
+}
+
+/* Plays a tone of uiToneHz through the EQ, on every channel with a
+ * different phase, and returns the gain of each channel in dB */
+static void eq_test_measure(AlsaEq *psEq, unsigned int uiToneHz, double *pdGainDb)
+{
+    unsigned int const uiChannels = psEq->uiChannels;
+    double adIn[ALSA_BUS_MAX_CHANNELS];
+    double adOut[ALSA_BUS_MAX_CHANNELS];
+
+    memset(adIn, 0x0, sizeof(adIn));
+    memset(adOut, 0x0, sizeof(adOut));
+    for (unsigned int uiAt = 0; uiAt < EQ_TEST_SETTLE_FRAMES + EQ_TEST_MEASURE_FRAMES;
+            uiAt += EQ_TEST_PERIOD)
+    {
+        for (unsigned int i = 0; i < EQ_TEST_PERIOD; ++i)
+        {
+            double const dPhase = (2.0 * M_PI * uiToneHz * (uiAt + i)) / EQ_TEST_RATE;
+
+            for (unsigned int c = 0; c < uiChannels; ++c)
+            {
+                atBus[i * uiChannels + c] = eq_test_bus(EQ_TEST_LEVEL * sin(dPhase + c));
+            }
+        }
+        if (uiAt >= EQ_TEST_SETTLE_FRAMES)
+        {
+            for (unsigned int i = 0; i < EQ_TEST_PERIOD * uiChannels; ++i)
+            {
+                adIn[i % uiChannels] += eq_test_value(atBus[i]) * eq_test_value(atBus[i]);
+            }
+        }
+        alsa_eq_process(psEq, atBus, EQ_TEST_PERIOD);
+        if (uiAt >= EQ_TEST_SETTLE_FRAMES)
+        {
+            for (unsigned int i = 0; i < EQ_TEST_PERIOD * uiChannels; ++i)
+            {
+                adOut[i % uiChannels] += eq_test_value(atBus[i]) * eq_test_value(atBus[i]);
+            }
+        }
+    }
+    for (unsigned int c = 0; c < uiChannels; ++c)
+    {
+        pdGainDb[c] = 10.0 * log10(adOut[c] / adIn[c]);
+    }
+}
+
+static int eq_test_case(const EqTestCase *psCase, unsigned int uiChannels)
+{
+    double adGainDb[ALSA_BUS_MAX_CHANNELS];
+    AlsaEq sEq;
+    int iFailed = 0;
+
+    if ((0 != alsa_eq_init(&sEq, uiChannels, EQ_TEST_RATE)) ||
+            (0 != alsa_eq_set(&sEq, psCase->asBands, psCase->uiBands)))
+    {
+        printf("ERR::TEST::%s: bands refused\n", psCase->pcName);
+        return 1;
+    }
+    eq_test_measure(&sEq, psCase->uiToneHz, adGainDb);
+    for (unsigned int c = 0; c < uiChannels; ++c)
+    {
+        double const dOff = adGainDb[c] - psCase->dWantDb;
+
+        if ((psCase->dToleranceDb >= 0.0) ? (fabs(dOff) > psCase->dToleranceDb) :
+                (dOff > 0.0))
+        {
+            printf("ERR::TEST::%s, %u channels: %.4f dB on channel %u at %u Hz, "
+                    "expected %.4f dB\n", psCase->pcName, uiChannels, adGainDb[c], c,
+                    psCase->uiToneHz, psCase->dWantDb);
+            iFailed = 1;
+        }
+    }
+    return iFailed;
+}
+
+/* No bands leaves the bus untouched, bands out of range are refused */
+static int eq_test_off(void)
+{
+    AAPPlayerEqBand const asBad[] =
+    {
+        { E_AAP_EQ_PEAKING, EQ_TEST_RATE / 2.0f, 6.0f, 1.0f },
+        { E_AAP_EQ_PEAKING, 1000.0f, 30.0f, 1.0f },
+        { E_AAP_EQ_PEAKING, 1000.0f, 6.0f, 0.0f },
+        { E_AAP_EQ_LOW_PASS, 0.0f, 0.0f, 0.707f }
+    };
+    AAPPlayerEqBand asMany[ALSA_EQ_MAX_BANDS + 1];
+    AlsaBusSample atRef[EQ_TEST_PERIOD * 2];
+    AlsaEq sEq;
+
+    alsa_eq_init(&sEq, 2, EQ_TEST_RATE);
+    for (unsigned int i = 0; i < EQ_TEST_PERIOD * 2; ++i)
+    {
+        atBus[i] = atRef[i] = eq_test_bus(EQ_TEST_LEVEL * sin(i * 0.01));
+    }
+    alsa_eq_process(&sEq, atBus, EQ_TEST_PERIOD);
+    if (alsa_eq_active(&sEq) || (0 != memcmp(atBus, atRef, sizeof(atRef))))
+    {
+        printf("ERR::TEST::EQ without bands changed the signal\n");
+        return 1;
+    }
+    for (unsigned int i = 0; i < sizeof(asBad) / sizeof(asBad[0]); ++i)
+    {
+        if (0 == alsa_eq_set(&sEq, &asBad[i], 1))
+        {
+            printf("ERR::TEST::Band %u out of range taken\n", i);
+            return 1;
+        }
+    }
+    for (unsigned int i = 0; i < ALSA_EQ_MAX_BANDS + 1; ++i)
+    {
+        asMany[i] = s_asCases[0].asBands[0];
+    }
+    if (0 == alsa_eq_set(&sEq, asMany, ALSA_EQ_MAX_BANDS + 1))
+    {
+        printf("ERR::TEST::%u bands taken\n", ALSA_EQ_MAX_BANDS + 1);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    unsigned int const auiChannels[] = { 1, 2, 6 };
+    int iFailed = eq_test_off();
+
+    for (unsigned int c = 0; c < sizeof(auiChannels) / sizeof(auiChannels[0]); ++c)
+    {
+        for (unsigned int i = 0; i < sizeof(s_asCases) / sizeof(s_asCases[0]); ++i)
+        {
+            iFailed |= eq_test_case(&s_asCases[i], auiChannels[c]);
+        }
+        printf("TEST::%u channels checked\n", auiChannels[c]);
+    }
+
+    if (0 != iFailed)
+    {
+        printf("ERR::TEST::EQ response differs from the band shapes\n");
+        return 1;
+    }
+    printf("TEST::EQ response matches the band shapes\n");
+    return 0;
+}
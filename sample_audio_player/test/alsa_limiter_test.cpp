@@ -0,0 +1,258 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_limiter_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Runs the look-ahead limiter over random periods of a tone with random
+ *   peaks up to 18 dB over its ceiling, for several channel counts and
+ *   rates. Below the ceiling the output must be the input delayed by the
+ *   look-ahead, bit for bit; above it no output sample may exceed the
+ *   ceiling. The largest reduction reported must match the largest peak
+ *   and start over with the next read.
+ *
+ *   Built and run by "make limiter_test", in the float or the fixed point
+ *   build as the Makefile is told. The random part is seeded from the time
+ *   unless a seed is given as the first argument, and the seed is printed
+ *   so that a failure can be repeated.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "alsa_limiter.h"
+
+#define LIMITER_TEST_CEILING_DB -6.0f
+/* Largest period handed to the limiter, in frames */
+#define LIMITER_TEST_MAX_PERIOD 1024
+#define LIMITER_TEST_QUIET_MS   100
+#define LIMITER_TEST_LOUD_MS    2000
+/* Largest peak fed, over the ceiling */
+#define LIMITER_TEST_OVER_DB    18.0
+/* Reported reduction against the one the peak needs */
+#define LIMITER_TEST_DB_TOLERANCE 0.01f
+
+static unsigned int uiRandState;
+
+static AlsaBusSample atIn[LIMITER_TEST_MAX_PERIOD * ALSA_BUS_MAX_CHANNELS];
+static AlsaBusSample atOut[LIMITER_TEST_MAX_PERIOD * ALSA_BUS_MAX_CHANNELS];
+
+static unsigned int limiter_test_rand(void)
+{
+    uiRandState ^= uiRandState << 13;
+    uiRandState ^= uiRandState >> 17;
+    uiRandState ^= uiRandState << 5;
+    return uiRandState;
+}
+
+static AlsaBusSample limiter_test_bus(double dValue)
+{
+#if ALSA_FIXED_POINT
+    return static_cast<int>(lrint(dValue * (1 << ALSA_BUS_FRAC_BITS)));
+#else
+    return static_cast<float>(dValue);
+#endif
+}
+
+static double limiter_test_abs(AlsaBusSample tValue)
+{
+#if ALSA_FIXED_POINT
+    return fabs(static_cast<double>(tValue)) / (1 << ALSA_BUS_FRAC_BITS);
+#else
+    return fabs(static_cast<double>(tValue));
+#endif
+}
+
+/* Runs uiMs of a tone of dLevel through the limiter in random periods.
+ * With bPeaks, random frames get a peak of up to LIMITER_TEST_OVER_DB over
+ * the ceiling. With bExact, the output must be the input of ptDelay, a
+ * copy of the limiter's delay line at frame *pulFrame. Returns the largest input sample, or -1.0 on a failure. */
+static double limiter_test_run(AlsaLimiter *psLimiter, AlsaBusSample *ptDelay,
+        unsigned long *pulFrame, unsigned int uiRate, unsigned int uiMs, double dLevel,
+        AAP_BOOL bPeaks, AAP_BOOL bExact)
+{
+    unsigned int const uiChannels = psLimiter->uiChannels;
+    unsigned int const uiLookahead = psLimiter->uiLookahead;
+    double const dCeiling = limiter_test_abs(psLimiter->tCeiling);
+    unsigned int uiLeft = (uiRate / 1000) * uiMs;
+    static double dPhase;
+    double dPeak = 0.0;
+
+    while (uiLeft > 0)
+    {
+        unsigned int uiFrames = 1 + limiter_test_rand() % LIMITER_TEST_MAX_PERIOD;
+
+        uiFrames = (uiFrames > uiLeft) ? uiLeft : uiFrames;
+        for (unsigned int i = 0; i < uiFrames; ++i)
+        {
+            dPhase += (2.0 * M_PI * 997.0) / uiRate;
+            for (unsigned int c = 0; c < uiChannels; ++c)
+            {
+                double dValue = dLevel * sin(dPhase + c);
+
+                if (bPeaks && (0 == limiter_test_rand() % 509))
+                {
+                    double const dOverDb = LIMITER_TEST_OVER_DB *
+                        (limiter_test_rand() % 1000) / 1000.0;
+
+                    dValue = ((limiter_test_rand() & 1) ? 1.0 : -1.0) *
+                        dCeiling * pow(10.0, dOverDb / 20.0);
+                }
+                atIn[i * uiChannels + c] = limiter_test_bus(dValue);
+                dPeak = (limiter_test_abs(atIn[i * uiChannels + c]) > dPeak) ?
+                    limiter_test_abs(atIn[i * uiChannels + c]) : dPeak;
+            }
+        }
+        memcpy(atOut, atIn, uiFrames * uiChannels * sizeof(AlsaBusSample));
+        alsa_limiter_process(psLimiter, atOut, uiFrames);
+
+        for (unsigned int i = 0; i < uiFrames; ++i)
+        {
+            /* Input of one look-ahead ago, before this frame's replaces it */
+            AlsaBusSample *ptDelayed = ptDelay + (*pulFrame % uiLookahead) * uiChannels;
+
+            for (unsigned int c = 0; c < uiChannels; ++c)
+            {
+                AlsaBusSample const tOut = atOut[i * uiChannels + c];
+
+                if (limiter_test_abs(tOut) > dCeiling)
+                {
+                    printf("ERR::TEST::%u channels at %u Hz: %.9f over the ceiling %.9f\n",
+                            uiChannels, uiRate, limiter_test_abs(tOut), dCeiling);
+                    return -1.0;
+                }
+                if (bExact && (tOut != ptDelayed[c]))
+                {
+                    printf("ERR::TEST::%u channels at %u Hz: quiet input changed\n",
+                            uiChannels, uiRate);
+                    return -1.0;
+                }
+                ptDelayed[c] = atIn[i * uiChannels + c];
+            }
+            ++*pulFrame;
+        }
+        uiLeft -= uiFrames;
+    }
+    return dPeak;
+}
+
+static int limiter_test_case(unsigned int uiChannels, unsigned int uiRate)
+{
+    AlsaBusSample atDelay[ALSA_BUS_MAX_CHANNELS * 64];
+    AAPPlayerLimiterStats sStats;
+    AlsaLimiter sLimiter;
+    unsigned long ulFrame = 0;
+    double dCeiling;
+    double dPeak;
+    float fWantDb;
+
+    if (0 != alsa_limiter_init(&sLimiter, uiChannels, uiRate))
+    {
+        printf("ERR::TEST::Limiter init failed\n");
+        return 1;
+    }
+    if (sLimiter.uiLookahead > 64)
+    {
+        printf("ERR::TEST::Look-ahead of %u frames too long for the test\n",
+                sLimiter.uiLookahead);
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+    memset(atDelay, 0x0, sizeof(atDelay));
+    alsa_limiter_set(&sLimiter, AAP_TRUE, LIMITER_TEST_CEILING_DB);
+    dCeiling = limiter_test_abs(sLimiter.tCeiling);
+
+    if (limiter_test_run(&sLimiter, atDelay, &ulFrame, uiRate, LIMITER_TEST_QUIET_MS,
+                dCeiling / 2.0, AAP_FALSE, AAP_TRUE) < 0.0)
+    {
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+    alsa_limiter_stats(&sLimiter, &sStats);
+    if ((0.0f != sStats.fMaxReductionDb) || (0 != sStats.ullLimitedFrames))
+    {
+        printf("ERR::TEST::%u channels at %u Hz: reduction below the ceiling\n",
+                uiChannels, uiRate);
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+
+    dPeak = limiter_test_run(&sLimiter, atDelay, &ulFrame, uiRate, LIMITER_TEST_LOUD_MS,
+            dCeiling / 2.0, AAP_TRUE, AAP_FALSE);
+    /* Silence until the last peak has left the delay line */
+    if ((dPeak < 0.0) ||
+            (limiter_test_run(&sLimiter, atDelay, &ulFrame, uiRate, 10, 0.0,
+                              AAP_FALSE, AAP_FALSE) < 0.0))
+    {
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+    alsa_limiter_stats(&sLimiter, &sStats);
+    fWantDb = static_cast<float>(20.0 * log10(dPeak / dCeiling));
+    if ((fabsf(sStats.fMaxReductionDb - fWantDb) > LIMITER_TEST_DB_TOLERANCE) ||
+            (0 == sStats.ullLimitedFrames))
+    {
+        printf("ERR::TEST::%u channels at %u Hz: largest reduction %.3f dB, "
+                "expected %.3f dB\n", uiChannels, uiRate, sStats.fMaxReductionDb, fWantDb);
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+    alsa_limiter_stats(&sLimiter, &sStats);
+    if (0.0f != sStats.fMaxReductionDb)
+    {
+        printf("ERR::TEST::%u channels at %u Hz: largest reduction not reset by a read\n",
+                uiChannels, uiRate);
+        alsa_limiter_deinit(&sLimiter);
+        return 1;
+    }
+    alsa_limiter_deinit(&sLimiter);
+    printf("TEST::%u channels at %u Hz checked, largest reduction %.2f dB\n",
+            uiChannels, uiRate, fWantDb);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int const auiChannels[] = { 1, 2, 6 };
+    unsigned int const auiRates[] = { 44100, 48000 };
+    unsigned int const uiSeed = (argc > 1) ?
+        static_cast<unsigned int>(strtoul(argv[1], NULL, 0)) :
+        static_cast<unsigned int>(time(NULL));
+    int iFailed = 0;
+
+    printf("TEST::Random seed %u\n", uiSeed);
+    uiRandState = (0 == uiSeed) ? 1 : uiSeed;
+    for (unsigned int c = 0; c < sizeof(auiChannels) / sizeof(auiChannels[0]); ++c)
+    {
+        for (unsigned int r = 0; r < sizeof(auiRates) / sizeof(auiRates[0]); ++r)
+        {
+            iFailed |= limiter_test_case(auiChannels[c], auiRates[r]);
+        }
+    }
+
+    if (0 != iFailed)
+    {
+        printf("ERR::TEST::Limiter failed, seed %u\n", uiSeed);
+        return 1;
+    }
+    printf("TEST::Limiter holds its ceiling\n");
+    return 0;
+}
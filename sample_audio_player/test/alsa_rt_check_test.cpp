@@ -0,0 +1,225 @@
+/******************************************************************************
+ *
+ *
+ *   ALLGO EMBEDDED SYSTEMS CONFIDENTIAL PROPRIETARY
+ *
+ *    (C) 2017 ALLGO EMBEDDED SYSTEMS PVT. LTD.
+ *
+ *   FILENAME        - alsa_rt_check_test.cpp
+ *
+ *   COMPILER        - gcc 4.4.4
+ *
+ ******************************************************************************
+ *
+ *   CHANGE HISTORY
+ *   mm/dd/yy          DESCRIPTION                        Author
+ *   --------          -----------                        ------
+ *   19/10/2026        Initial Version
+ *******************************************************************************
+ *
+ *   DESCRIPTION
+ *   Plays a tone on the ALSA "null" device with the real-time checks built
+ *   in: steady playback, a pause and play, an input reconfigure, latency
+ *   changes, deep buffering in the timer scheduled build and a drain to the
+ *   end of stream. It fails when the render thread made any call it
+ *   must not make in its steady state, when the render thread was not armed
+ *   in each steady stretch, or when the checks do not catch heap and
+ *   console calls made on purpose on an armed thread.
+ *
+ *   Built and run by "make rt_check_test", and in the timer scheduled
+ *   build by "make rt_check_tsched_test".
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "aap_plat_aplayer_interface.h"
+#include "aap_plat_media_player_types.h"
+#include "alsa_rt_check.h"
+
+#if !ALSA_RT_CHECK
+#error "Build with RT_CHECK=1"
+#endif
+
+#define RT_TEST_DEVICE          "null"
+#define RT_TEST_CHANNELS        2
+#define RT_TEST_PACKET_MS       10
+/* Longer than the second of steady playback the checks are armed after */
+#define RT_TEST_PLAY_MS         2000
+#define RT_TEST_PAUSE_MS        300
+#define RT_TEST_EOS_WAIT_MS     3000
+#define RT_TEST_MAX_FRAMES      ((48000 * RT_TEST_PACKET_MS) / 1000)
+
+static volatile int iEos;
+
+/* Runs on the render thread, so it only sets a flag */
+static void rt_test_event(AAPPlayer_Events eEvent, AAP_UINT32 uiDataLen,
+        void *pvData, void *pvCbParam)
+{
+    (void)pvCbParam;
+    if ((E_AAP_PLAYER_FACED_ERROR == eEvent) && (sizeof(int) == uiDataLen) &&
+            (E_AAP_ERROR_PLAYER_EOS == *static_cast<int *>(pvData)))
+    {
+        iEos = 1;
+    }
+}
+
+/* Pushes uiMs of a tone a packet per packet time, as a source would */
+static void rt_test_play(AAP_HANDLE hPlayer, unsigned int uiRate, unsigned int uiMs,
+        AAP_UINT64 *pullTimestampUs)
+{
+    static short asPacket[RT_TEST_MAX_FRAMES * RT_TEST_CHANNELS];
+    static double dPhase;
+    unsigned int const uiFrames = (uiRate * RT_TEST_PACKET_MS) / 1000;
+    struct timespec sNext;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNext);
+    for (unsigned int uiAt = 0; uiAt < uiMs; uiAt += RT_TEST_PACKET_MS)
+    {
+        for (unsigned int i = 0; i < uiFrames; ++i)
+        {
+            short const sSample = static_cast<short>(8000.0 * sin(dPhase));
+
+            dPhase += (2.0 * M_PI * 440.0) / uiRate;
+            for (unsigned int c = 0; c < RT_TEST_CHANNELS; ++c)
+            {
+                asPacket[i * RT_TEST_CHANNELS + c] = sSample;
+            }
+        }
+        aap_plat_aplayer_process_data(hPlayer, reinterpret_cast<unsigned char *>(asPacket),
+                uiFrames * RT_TEST_CHANNELS * sizeof(short), *pullTimestampUs);
+        *pullTimestampUs += RT_TEST_PACKET_MS * 1000;
+
+        sNext.tv_nsec += RT_TEST_PACKET_MS * 1000000L;
+        if (sNext.tv_nsec >= 1000000000L)
+        {
+            sNext.tv_sec += 1;
+            sNext.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sNext, NULL);
+    }
+}
+
+/* The checks have to count what an armed thread does wrong */
+static int rt_test_control(void)
+{
+    unsigned long const ulBefore = alsa_rt_check_violations();
+    void *volatile pvBlock;
+
+    alsa_rt_check_arm(AAP_TRUE);
+    pvBlock = malloc(64);
+    free(pvBlock);
+    printf("TEST::Console output while armed\n");
+    alsa_rt_check_arm(AAP_FALSE);
+    return (alsa_rt_check_violations() - ulBefore >= 2) ? 0 : 1;
+}
+
+int main(void)
+{
+    AAPAudioConfig sConfig;
+    AAP_HANDLE hPlayer;
+    AAP_UINT64 ullTimestampUs = 0;
+    unsigned long ulArmed;
+    unsigned long ulViolations;
+    unsigned int const auiLatencyMs[] = { 40, 300 };
+    unsigned int uiWaitMs = 0;
+
+    memset(&sConfig, 0, sizeof(sConfig));
+    sConfig.eStreamType = AAP_AUDIO_STREAM_MEDIA;
+    sConfig.eAudioFreq = AUDIO_SAMPLING_FREQ_48K;
+    sConfig.uiChannels = RT_TEST_CHANNELS;
+    sConfig.uiAudioBps = 16;
+    snprintf(sConfig.acAudioDeviceID, sizeof(sConfig.acAudioDeviceID), "%s",
+            RT_TEST_DEVICE);
+
+    if ((0 != aap_plat_aplayer_init(&hPlayer, &sConfig, rt_test_event, NULL)) ||
+            (0 != aap_plat_aplayer_play(hPlayer)))
+    {
+        printf("ERR::TEST::Player on %s not started\n", RT_TEST_DEVICE);
+        return 1;
+    }
+
+    rt_test_play(hPlayer, 48000, RT_TEST_PLAY_MS, &ullTimestampUs);
+    ulArmed = alsa_rt_check_armed();
+    if (0 == ulArmed)
+    {
+        printf("ERR::TEST::Render thread never armed\n");
+        return 1;
+    }
+
+    aap_plat_aplayer_pause(hPlayer);
+    usleep(RT_TEST_PAUSE_MS * 1000);
+    aap_plat_aplayer_play(hPlayer);
+    rt_test_play(hPlayer, 48000, RT_TEST_PLAY_MS, &ullTimestampUs);
+    if (alsa_rt_check_armed() == ulArmed)
+    {
+        printf("ERR::TEST::Render thread not armed again after pause\n");
+        return 1;
+    }
+
+    sConfig.eAudioFreq = AUDIO_SAMPLING_FREQ_44K;
+    if (0 != aap_plat_aplayer_reconfigure(hPlayer, &sConfig))
+    {
+        printf("ERR::TEST::Reconfigure failed\n");
+        return 1;
+    }
+    rt_test_play(hPlayer, 44100, RT_TEST_PLAY_MS, &ullTimestampUs);
+
+    /* Within the device buffer, then beyond it where the buffer allows */
+    for (unsigned int i = 0; i < sizeof(auiLatencyMs) / sizeof(auiLatencyMs[0]); ++i)
+    {
+        if (0 != aap_plat_aplayer_set_latency(hPlayer, auiLatencyMs[i]))
+        {
+            printf("ERR::TEST::Latency of %u ms refused\n", auiLatencyMs[i]);
+            return 1;
+        }
+        rt_test_play(hPlayer, 44100, RT_TEST_PLAY_MS, &ullTimestampUs);
+    }
+
+#if ALSA_TSCHED
+    /* Deep buffering on, then back to the latency set */
+    for (int i = 0; i < 2; ++i)
+    {
+        if (0 != aap_plat_aplayer_set_deep_buffer(hPlayer, (0 == i) ? AAP_TRUE : AAP_FALSE))
+        {
+            printf("ERR::TEST::Deep buffering not switched %s\n", (0 == i) ? "on" : "off");
+            return 1;
+        }
+        rt_test_play(hPlayer, 44100, RT_TEST_PLAY_MS, &ullTimestampUs);
+    }
+#endif
+
+    aap_plat_aplayer_drain(hPlayer);
+    while (!iEos && (uiWaitMs < RT_TEST_EOS_WAIT_MS))
+    {
+        usleep(10 * 1000);
+        uiWaitMs += 10;
+    }
+    if (!iEos)
+    {
+        printf("ERR::TEST::No end of stream after drain\n");
+        return 1;
+    }
+
+    aap_plat_aplayer_stop(hPlayer);
+    aap_plat_aplayer_deinit(&hPlayer);
+
+    ulViolations = alsa_rt_check_violations();
+    if (0 != ulViolations)
+    {
+        printf("ERR::TEST::%lu real-time violations on the render thread\n", ulViolations);
+        return 1;
+    }
+    if (0 != rt_test_control())
+    {
+        printf("ERR::TEST::Checks did not catch calls on an armed thread\n");
+        return 1;
+    }
+    printf("TEST::No real-time violations, render thread armed %lu times\n",
+            alsa_rt_check_armed() - 1);
+    return 0;
+}